@@ -7,7 +7,7 @@ DEPFLAGS = -MT $@ -MMD -MP -MF $(DEP_DIR)/$*.Td
 POSTCOMPILE = mv -f $(DEP_DIR)/$*.Td $(DEP_DIR)/$*.d && touch $@
 
 CXXFLAGS.debug := -Og -fstack-protector-all -g
-CXXFLAGS.release := -O3 -march=native -DNDEBUG
+CXXFLAGS.release := -O3 -march=native -DNDEBUG -DTAPTENC_LOG_LEVEL=1
 CXXFLAGS := -pthread -std=gnu++14 -W{all,extra,error} -fmessage-length=0 ${CXXFLAGS.${BUILD}}
 
 LDFLAGS.debug :=
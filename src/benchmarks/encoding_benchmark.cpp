@@ -0,0 +1,404 @@
+/** \file
+ * Benchmark suite of the encoding pipeline.
+ *
+ * Measures the creation of direct encodings per constraint type, incremental
+ * re-encoding after the plan tail changed, the merging of encodings, the
+ * creation of the final system, printing, trace parsing and monitoring the
+ * execution of the resulting timed trace on the hand-crafted RCLL platform
+ * models for plans of different lengths.
+ *
+ * Results are additionally written to a file in the JSON format of google
+ * benchmark, such that its tooling can be used to compare releases.
+ *
+ * \author (2019) Tarik Viehmann
+ */
+#include "constants.h"
+#include "direct_encoder.h"
+#include "enc_interconnection_info.h"
+#include "execution_monitor.h"
+#include "native_solver.h"
+#include "plan_ordered_tls.h"
+#include "platform_model_generator.h"
+#include "printer.h"
+#include "timed_automata.h"
+#include "transformation.h"
+#include "utap_trace_parser.h"
+#include "vis_info.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace taptenc;
+using namespace std;
+
+/**
+ * Measured average run time of one benchmark.
+ */
+struct benchmarkResult {
+  string name;
+  int iterations;
+  /** average wall clock time per iteration in microseconds */
+  double real_time;
+  /** average cpu time per iteration in microseconds */
+  double cpu_time;
+  /** additional metrics, e.g. the size of the produced encoding */
+  vector<pair<string, double>> counters;
+};
+typedef struct benchmarkResult BenchmarkResult;
+
+/**
+ * Platform model together with a generator for its constraints.
+ *
+ * Constraints are generated on demand, as they are not copyable.
+ */
+struct platformInfo {
+  string name;
+  Automaton ta;
+  function<vector<unique_ptr<EncICInfo>>(const Automaton &)> constraints;
+};
+typedef struct platformInfo PlatformInfo;
+
+/**
+ * Measures the average run time of a function.
+ *
+ * @param name name of the measured operation
+ * @param iterations number of calls to \a f
+ * @param setup called before each call to \a f, not included in the
+ *        measurement
+ * @param f function to measure
+ * @return measured run time
+ */
+BenchmarkResult measure(const string &name, int iterations,
+                        function<void()> setup, function<void()> f) {
+  chrono::duration<double, micro> real_time(0);
+  clock_t cpu_time = 0;
+  for (int i = 0; i < iterations; i++) {
+    setup();
+    clock_t c1 = std::clock();
+    auto t1 = chrono::high_resolution_clock::now();
+    f();
+    auto t2 = chrono::high_resolution_clock::now();
+    cpu_time += std::clock() - c1;
+    real_time += t2 - t1;
+  }
+  BenchmarkResult res{
+      name, iterations, real_time.count() / iterations,
+      1e6 * static_cast<double>(cpu_time) / CLOCKS_PER_SEC / iterations, {}};
+  cout << name << ": " << res.real_time << " us" << endl;
+  return res;
+}
+
+/**
+ * Adds the size of an encoding as counters to a benchmark result.
+ */
+void addSizeCounters(BenchmarkResult &res, const EncodingSize &size) {
+  res.counters.push_back(make_pair("states", size.states));
+  res.counters.push_back(make_pair("transitions", size.transitions));
+}
+
+/**
+ * Runs all benchmarks of the encoding pipeline for one plan.
+ *
+ * @param plan plan to encode
+ * @param platforms platform models to encode, the first \a num_merged ones
+ *        are merged
+ * @param num_merged number of platforms to merge
+ * @param iterations number of repetitions per measurement
+ * @param results vector to append the benchmark results to
+ */
+void benchmarkPlan(const vector<PlanAction> &plan,
+                   const vector<PlatformInfo> &platforms, size_t num_merged,
+                   int iterations, vector<BenchmarkResult> &results) {
+  const string suffix = "/" + to_string(plan.size());
+  const vector<ICType> types{ICType::Future, ICType::NoOp,
+                             ICType::Past,   ICType::Invariant,
+                             ICType::Until,  ICType::UntilChain,
+                             ICType::Since};
+  AutomataSystem system;
+  auto reset_system = [&system](const Automaton &platform_ta) {
+    system = AutomataSystem();
+    system.instances.push_back(make_pair(platform_ta, ""));
+  };
+  // encode each constraint type separately
+  vector<ICType> uncovered_types = types;
+  for (const auto &platform : platforms) {
+    for (ICType type : types) {
+      vector<unique_ptr<EncICInfo>> constraints;
+      for (auto &constraint : platform.constraints(platform.ta)) {
+        if (constraint->type == type) {
+          constraints.push_back(std::move(constraint));
+        }
+      }
+      if (constraints.empty()) {
+        continue;
+      }
+      uncovered_types.erase(
+          remove(uncovered_types.begin(), uncovered_types.end(), type),
+          uncovered_types.end());
+      unique_ptr<DirectEncoder> enc;
+      results.push_back(measure(
+          "createDirectEncoding/" + toString(type) + "/" + platform.name +
+              suffix,
+          iterations, [&]() { reset_system(platform.ta); },
+          [&]() {
+            enc = make_unique<DirectEncoder>(
+                transformation::createDirectEncoding(system, plan,
+                                                     constraints));
+          }));
+      results.back().counters.push_back(
+          make_pair("constraints", constraints.size()));
+      addSizeCounters(results.back(),
+                      PlanOrderedTLs::totalSize(enc->getTlSizes()));
+    }
+  }
+  for (ICType type : uncovered_types) {
+    cout << "encoding_benchmark: no " << toString(type)
+         << " constraints, skip createDirectEncoding/" << toString(type)
+         << endl;
+  }
+  // re-encode after the tail of the plan changed, starting from the
+  // checkpoints of the encoding of a shorter plan
+  const vector<PlanAction> prefix_plan(
+      plan.begin(), plan.end() - min<size_t>(plan.size() - 1, 2));
+  for (const auto &platform : platforms) {
+    vector<unique_ptr<EncICInfo>> constraints =
+        platform.constraints(platform.ta);
+    transformation::IncrementalEncoder enc(platform.ta, constraints);
+    results.push_back(measure(
+        "IncrementalEncoder/" + platform.name + suffix, iterations,
+        [&]() { enc.encode(prefix_plan); }, [&]() { enc.encode(plan); }));
+    results.back().counters.push_back(
+        make_pair("reused_steps", enc.getReusedSteps()));
+    results.back().counters.push_back(
+        make_pair("encoded_steps", enc.getEncodedSteps()));
+  }
+  // encode the platforms to merge with all their constraints
+  vector<DirectEncoder> encodings;
+  AutomataSystem merged_system;
+  for (size_t i = 0; i < num_merged && i < platforms.size(); i++) {
+    vector<unique_ptr<EncICInfo>> constraints =
+        platforms[i].constraints(platforms[i].ta);
+    unique_ptr<DirectEncoder> enc;
+    results.push_back(measure(
+        "createDirectEncoding/All/" + platforms[i].name + suffix, iterations,
+        [&]() { reset_system(platforms[i].ta); },
+        [&]() {
+          enc = make_unique<DirectEncoder>(
+              transformation::createDirectEncoding(system, plan, constraints));
+        }));
+    addSizeCounters(results.back(),
+                    PlanOrderedTLs::totalSize(enc->getTlSizes()));
+    if (i == 0) {
+      merged_system.instances = system.instances;
+    }
+    merged_system.globals.clocks.insert(system.globals.clocks.begin(),
+                                        system.globals.clocks.end());
+    encodings.push_back(std::move(*enc));
+  }
+  const Automaton plan_ta =
+      merged_system.instances[encodings[0].getPlanTAIndex()].first;
+  // merge the encodings from left to right
+  DirectEncoder merged = encodings[0].copy();
+  Automaton product_ta = platforms[0].ta;
+  for (size_t i = 1; i < encodings.size(); i++) {
+    unique_ptr<DirectEncoder> next;
+    results.push_back(measure(
+        "mergeEncodings/" + to_string(i + 1) + suffix, iterations, []() {},
+        [&]() {
+          next = make_unique<DirectEncoder>(
+              merged.mergeEncodings(encodings[i]));
+        }));
+    addSizeCounters(results.back(),
+                    PlanOrderedTLs::totalSize(next->getTlSizes()));
+    merged = std::move(*next);
+    product_ta = PlanOrderedTLs::productTA(product_ta, platforms[i].ta,
+                                           "product", true);
+  }
+  // createFinalSystem prunes the encoding, hence it works on fresh copies
+  const string merged_suffix = "/" + to_string(encodings.size()) + suffix;
+  DirectEncoder final_enc;
+  AutomataSystem final_system;
+  SystemVisInfo final_vis;
+  results.push_back(measure(
+      "createFinalSystem/layout" + merged_suffix, iterations,
+      [&]() { final_enc = merged.copy(); },
+      [&]() {
+        final_system = final_enc.createFinalSystem(merged_system, final_vis);
+      }));
+  results.push_back(measure(
+      "createFinalSystem/headless" + merged_suffix, iterations,
+      [&]() { final_enc = merged.copy(); },
+      [&]() { final_system = final_enc.createFinalSystem(merged_system); }));
+  addSizeCounters(
+      results.back(),
+      EncodingSize{final_system.instances[0].first.states.size(),
+                   final_system.instances[0].first.transitions.size()});
+  // print to memory to exclude disk performance
+  XMLPrinter printer;
+  stringstream out;
+  SystemVisInfo vis;
+  results.push_back(measure(
+      "printXML/layout" + merged_suffix, iterations,
+      [&]() {
+        out.str("");
+        vis = final_vis;
+      },
+      [&]() { printer.print(final_system, vis, out); }));
+  results.back().counters.push_back(make_pair("bytes", out.str().size()));
+  results.push_back(measure(
+      "printXML/headless" + merged_suffix, iterations, [&]() { out.str(""); },
+      [&]() { printer.print(final_system, out); }));
+  results.back().counters.push_back(make_pair("bytes", out.str().size()));
+  // solve once and parse the resulting trace
+  NativeSolver solver;
+  SolverResult solution;
+  results.push_back(measure(
+      "solve/" + solver.getName() + merged_suffix, iterations, []() {},
+      [&]() { solution = solver.solve(final_system, constants::QUERY); }));
+  if (solution.status != SolverStatus::Reachable) {
+    cout << "encoding_benchmark: query not reachable, skip trace parsing"
+         << endl;
+    return;
+  }
+  results.back().counters.push_back(
+      make_pair("trace_length", solution.trace.transitions.size()));
+  timed_trace_t timed_trace;
+  results.push_back(measure(
+      "parseTrace" + merged_suffix, iterations, []() {},
+      [&]() {
+        UTAPTraceParser parser(final_system);
+        parser.loadTrace(solution.trace);
+        timed_trace = parser.getTimedTrace(product_ta, plan_ta);
+      }));
+  results.back().counters.push_back(
+      make_pair("timed_trace_length", timed_trace.size()));
+  // report the execution of every entry, every third one is slightly late
+  unique_ptr<UTAPTraceParser> monitored_parser;
+  size_t num_events = 0;
+  results.push_back(measure(
+      "monitor" + merged_suffix, iterations,
+      [&]() {
+        monitored_parser.reset(new UTAPTraceParser(final_system));
+        monitored_parser->loadTrace(solution.trace);
+        timed_trace = monitored_parser->getTimedTrace(product_ta, plan_ta);
+      },
+      [&]() {
+        ExecutionMonitor monitor(*monitored_parser, timed_trace);
+        num_events = 0;
+        for (size_t i = 0;
+             i < timed_trace.size() && !monitor.isReplanningRequired(); i++) {
+          pair<timepoint, timepoint> window = monitor.getWindow(i);
+          timepoint late = min<timepoint>(1, window.second - window.first);
+          monitor.executed(i, window.first + (i % 3 == 0 ? late : 0));
+          num_events++;
+        }
+      }));
+  results.back().counters.push_back(make_pair("events", num_events));
+}
+
+/**
+ * Writes benchmark results in the JSON format of google benchmark.
+ *
+ * @param filename name of the resulting file
+ * @param context key value pairs describing the benchmark setup
+ * @param results benchmark results to write
+ */
+void writeJSON(const string &filename,
+               const vector<pair<string, string>> &context,
+               const vector<BenchmarkResult> &results) {
+  ofstream out(filename);
+  if (!out.is_open()) {
+    cout << "encoding_benchmark writeJSON: could not open file " << filename
+         << endl;
+    return;
+  }
+  out << "{\n  \"context\": {";
+  for (auto it = context.begin(); it != context.end(); ++it) {
+    out << (it == context.begin() ? "\n" : ",\n") << "    \"" << it->first
+        << "\": \"" << it->second << "\"";
+  }
+  out << "\n  },\n  \"benchmarks\": [";
+  for (auto it = results.begin(); it != results.end(); ++it) {
+    out << (it == results.begin() ? "\n" : ",\n") << "    {\n"
+        << "      \"name\": \"" << it->name << "\",\n"
+        << "      \"run_name\": \"" << it->name << "\",\n"
+        << "      \"run_type\": \"iteration\",\n"
+        << "      \"iterations\": " << it->iterations << ",\n"
+        << "      \"real_time\": " << it->real_time << ",\n"
+        << "      \"cpu_time\": " << it->cpu_time << ",\n"
+        << "      \"time_unit\": \"us\"";
+    for (const auto &counter : it->counters) {
+      out << ",\n      \"" << counter.first << "\": " << counter.second;
+    }
+    out << "\n    }";
+  }
+  out << "\n  ]\n}" << endl;
+}
+
+int main(int argc, char **argv) {
+  int iterations = 5;
+  string filename = "encoding_benchmark.json";
+  size_t num_merged = 3;
+  vector<long unsigned int> plan_lengths;
+  if (argc > 1) {
+    iterations = stoi(string(argv[1]));
+  }
+  if (argc > 2) {
+    filename = argv[2];
+  }
+  if (argc > 3) {
+    num_merged = stoul(string(argv[3]));
+  }
+  for (int i = 4; i < argc; i++) {
+    plan_lengths.push_back(stoul(string(argv[i])));
+  }
+  if (plan_lengths.empty()) {
+    plan_lengths = {8, 12};
+  }
+  vector<PlatformInfo> platforms{
+      {"perception", benchmarkgenerator::generatePerceptionTA(),
+       benchmarkgenerator::generatePerceptionConstraints},
+      {"calibration", benchmarkgenerator::generateCalibrationTA(),
+       benchmarkgenerator::generateCalibrationConstraints}};
+  for (const string machine : {"rs1", "rs2", "cs1", "cs2"}) {
+    platforms.push_back(PlatformInfo{
+        "comm_" + machine, benchmarkgenerator::generateCommTA(machine),
+        [machine](const Automaton &ta) {
+          return benchmarkgenerator::generateCommConstraints(ta, machine);
+        }});
+  }
+  // the RCLL constraints only use some constraint types, added last to not
+  // change the merged platforms
+  platforms.push_back(PlatformInfo{
+      "perception_types", benchmarkgenerator::generatePerceptionTA(),
+      benchmarkgenerator::generatePerceptionTypeConstraints});
+  const unsigned int seed = 42;
+  vector<BenchmarkResult> results;
+  for (auto plan_length : plan_lengths) {
+    // the same plan for every run of the benchmark
+    srand(seed + plan_length);
+    vector<PlanAction> plan = benchmarkgenerator::generatePlan(plan_length);
+    benchmarkPlan(plan, platforms, num_merged, iterations, results);
+  }
+  char date[32];
+  time_t now = time(nullptr);
+  strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", localtime(&now));
+  writeJSON(filename,
+            {{"date", date},
+             {"executable", argv[0]},
+             {"num_cpus", to_string(thread::hardware_concurrency())},
+             {"seed", to_string(seed)},
+             {"merged_platforms", to_string(num_merged)}},
+            results);
+  return 0;
+}
@@ -0,0 +1,296 @@
+/** \file
+ * Micro-benchmark of Filter membership queries on the platform models.
+ *
+ * Compares the indexed Filter operations against a linear scan over the
+ * filter states, as they were implemented before the filter index. The
+ * results of both implementations are checked for equality before timing.
+ *
+ * \author (2019) Tarik Viehmann
+ */
+#include "constants.h"
+#include "encoder_utils.h"
+#include "filter.h"
+#include "plan_ordered_tls.h"
+#include "platform_model_generator.h"
+#include "timed_automata.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace taptenc;
+using namespace std;
+
+/**
+ * Filter operations as implemented before the filter index.
+ *
+ * The functions are copied verbatim from the previous Filter implementation
+ * (only the member accesses became parameters), so the indexed operations
+ * are compared against the original semantics.
+ */
+namespace legacy {
+bool hasSuffix(std::string name, std::string suffix) {
+  if (name.size() >= suffix.size()) {
+    return name.substr(name.size() - suffix.size(), suffix.size()) == suffix;
+  } else {
+    return false;
+  }
+}
+
+bool hasPrefix(std::string name, std::string prefix) {
+  if (name.size() >= prefix.size()) {
+    return name.substr(0, prefix.size()) == prefix;
+  } else {
+    return false;
+  }
+}
+
+std::string getSuffix(std::string name, char marker) {
+  size_t pos = name.find_last_of(marker);
+  if (pos != std::string::npos) {
+    return name.substr(pos + 1);
+  } else {
+    return name;
+  }
+}
+
+bool matchesFilter(std::string name, std::string prefix, std::string suffix) {
+  if (not(hasPrefix(name, prefix) && hasSuffix(name, suffix))) {
+    return false;
+  } else {
+    std::string base_name =
+        (name.find(constants::BASE_SEP) == std::string::npos)
+            ? name
+            : getSuffix(name, constants::BASE_SEP);
+    std::string base_suffix =
+        (suffix.find(constants::BASE_SEP) == std::string::npos)
+            ? suffix
+            : getSuffix(suffix, constants::BASE_SEP);
+    return base_suffix == "" || base_name == base_suffix;
+  }
+}
+
+bool isFilterEndIt(const std::vector<State> &filter, bool invert_effect,
+                   std::vector<State>::const_iterator it) {
+  bool res = it == filter.end();
+  return invert_effect ? !res : res;
+}
+
+void filterTransitionsInPlace(const std::vector<State> &filter,
+                              bool invert_effect,
+                              std::vector<Transition> &trans,
+                              std::string prefix, bool filter_source) {
+  trans.erase(std::remove_if(
+                  trans.begin(), trans.end(),
+                  [&filter, invert_effect, filter_source,
+                   prefix](Transition &t) {
+                    std::string id =
+                        ((filter_source) ? t.source_id : t.dest_id);
+                    bool res =
+                        hasPrefix(id, prefix) &&
+                        isFilterEndIt(
+                            filter, invert_effect,
+                            std::find_if(filter.begin(), filter.end(),
+                                         [id, filter_source,
+                                          prefix](const State &s) {
+                                           return matchesFilter(id, prefix,
+                                                                s.id);
+                                         }));
+                    return res;
+                  }),
+              trans.end());
+}
+
+void filterAutomatonInPlace(const std::vector<State> &filter,
+                            bool invert_effect, Automaton &source,
+                            std::string prefix) {
+  source.states.erase(
+      std::remove_if(source.states.begin(), source.states.end(),
+                     [&filter, invert_effect, prefix](State &s) {
+                       return isFilterEndIt(
+                           filter, invert_effect,
+                           std::find_if(filter.begin(), filter.end(),
+                                        [prefix, s](const State &f_s) {
+                                          return matchesFilter(s.id, prefix,
+                                                               f_s.id);
+                                        }));
+                     }),
+      source.states.end());
+  filterTransitionsInPlace(filter, invert_effect, source.transitions, prefix,
+                           true);
+  filterTransitionsInPlace(filter, invert_effect, source.transitions, prefix,
+                           false);
+}
+
+bool matchesId(const std::vector<State> &filter, bool invert_effect,
+               const std::string id) {
+  return !isFilterEndIt(
+      filter, invert_effect,
+      std::find_if(filter.begin(), filter.end(), [id](const State &s) {
+        return matchesFilter(id, "", s.id);
+      }));
+}
+} // end namespace legacy
+
+/**
+ * Aborts the benchmark if the indexed and the legacy results differ.
+ *
+ * @param what name of the compared operation
+ * @param equal result of the comparison
+ */
+void checkEqual(const string &what, bool equal) {
+  if (!equal) {
+    cerr << "filter_benchmark: " << what
+         << " differs from the legacy implementation" << endl;
+    exit(EXIT_FAILURE);
+  }
+}
+
+/**
+ * Checks whether two automata consist of the same states and transitions.
+ *
+ * @param l first automaton
+ * @param r second automaton
+ * @return true iff states and transitions match in id and order
+ */
+bool sameStructure(const Automaton &l, const Automaton &r) {
+  if (l.states.size() != r.states.size() ||
+      l.transitions.size() != r.transitions.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < l.states.size(); i++) {
+    if (l.states[i].id != r.states[i].id) {
+      return false;
+    }
+  }
+  for (size_t i = 0; i < l.transitions.size(); i++) {
+    if (l.transitions[i].source_id != r.transitions[i].source_id ||
+        l.transitions[i].dest_id != r.transitions[i].dest_id ||
+        l.transitions[i].action != r.transitions[i].action) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Measures the average run time of a function.
+ *
+ * @param name name of the measured operation
+ * @param iterations number of calls to \a f
+ * @param f function to measure
+ * @return average time per call in microseconds
+ */
+double measure(const string &name, int iterations, function<void()> f) {
+  auto t1 = chrono::high_resolution_clock::now();
+  for (int i = 0; i < iterations; i++) {
+    f();
+  }
+  auto t2 = chrono::high_resolution_clock::now();
+  double res =
+      chrono::duration_cast<chrono::duration<double, micro>>(t2 - t1).count() /
+      iterations;
+  cout << "  " << name << ": " << res << " us" << endl;
+  return res;
+}
+
+/**
+ * Runs all filter benchmarks on a platform model.
+ *
+ * The model is copied into a timeline-like automaton (states carry a plan
+ * action prefix) and half of its states serve as filter.
+ *
+ * @param name name of the platform model
+ * @param platform_ta platform model
+ * @param iterations number of repetitions per measurement
+ */
+void benchmarkPlatform(const string &name, const Automaton &platform_ta,
+                       int iterations) {
+  string prefix =
+      encoderutils::toPrefix("", "", string("pa") + constants::PA_SEP + "1");
+  Automaton ta = Filter::copyAutomaton(platform_ta, prefix, false);
+  vector<State> filter_states;
+  for (size_t i = 0; i < ta.states.size(); i += 2) {
+    filter_states.push_back(ta.states[i]);
+  }
+  Filter filter(filter_states);
+  cout << name << " (" << ta.states.size() << " states, "
+       << ta.transitions.size() << " transitions, " << filter_states.size()
+       << " filter states)" << endl;
+
+  // the indexed operations have to agree with the legacy ones, both for a
+  // filter keeping and one removing the matching states
+  for (bool invert : {false, true}) {
+    Filter check_filter(filter_states, invert);
+    for (const auto &s : ta.states) {
+      checkEqual("matchesId", check_filter.matchesId(s.id) ==
+                                  legacy::matchesId(filter_states, invert,
+                                                    s.id));
+    }
+    Automaton indexed_copy = ta;
+    Automaton legacy_copy = ta;
+    check_filter.filterAutomatonInPlace(indexed_copy, prefix);
+    legacy::filterAutomatonInPlace(filter_states, invert, legacy_copy, prefix);
+    checkEqual("filterAutomatonInPlace",
+               sameStructure(indexed_copy, legacy_copy));
+  }
+
+  size_t matches = 0;
+  double linear = measure("matchesId linear", iterations, [&]() {
+    for (const auto &s : ta.states) {
+      matches += legacy::matchesId(filter_states, false, s.id);
+    }
+  });
+  double indexed = measure("matchesId indexed", iterations, [&]() {
+    for (const auto &s : ta.states) {
+      matches += filter.matchesId(s.id);
+    }
+  });
+  cout << "  matchesId speedup: " << linear / indexed << endl;
+
+  linear = measure("filterAutomatonInPlace linear", iterations, [&]() {
+    Automaton copy = ta;
+    legacy::filterAutomatonInPlace(filter_states, false, copy, prefix);
+    matches += copy.states.size();
+  });
+  indexed = measure("filterAutomatonInPlace indexed", iterations, [&]() {
+    Automaton copy = ta;
+    filter.filterAutomatonInPlace(copy, prefix);
+    matches += copy.states.size();
+  });
+  cout << "  filterAutomatonInPlace speedup: " << linear / indexed << endl;
+
+  measure("updateFilter indexed", iterations, [&]() {
+    matches += filter.updateFilter(ta).getFilter().size();
+  });
+  // keep the results observable, so nothing is optimized away
+  if (matches == 0) {
+    cout << "  no matches" << endl;
+  }
+}
+
+int main(int argc, char **argv) {
+  int iterations = 100;
+  if (argc > 1) {
+    iterations = stoi(string(argv[1]));
+  }
+  Automaton perception_ta = benchmarkgenerator::generatePerceptionTA();
+  Automaton comm_ta = benchmarkgenerator::generateCommTA("rs1");
+  benchmarkPlatform("perception", perception_ta, iterations);
+  benchmarkPlatform("comm", comm_ta, iterations);
+  benchmarkPlatform(
+      "perception x comm",
+      PlanOrderedTLs::productTA(perception_ta, comm_ta, "product", true),
+      iterations);
+  benchmarkPlatform("perception x comm x comm",
+                    PlanOrderedTLs::productTA(
+                        PlanOrderedTLs::productTA(perception_ta, comm_ta,
+                                                  "product", true),
+                        benchmarkgenerator::generateCommTA("cs1"), "product",
+                        true),
+                    iterations);
+  return 0;
+}
@@ -20,6 +20,8 @@ constexpr char QUERY[]{"AqueryA"};
 constexpr char PLAN_TA_NAME[]{"AplanA"};
 constexpr char REL_PLAN_CLOCK[]{"ArelclockA"};
 constexpr char GLOBAL_CLOCK[]{"AglobalclockA"};
+// reference clock of uppaal DBMs
+constexpr char ZERO_CLOCK[]{"t(0)"};
 constexpr char CC_CONJUNCTION[]{"&amp;&amp;"};
 constexpr char UPDATE_CONJUNCTION[]{","};
 } // end namespace constants
@@ -6,6 +6,7 @@
 
 #include "constraints.h"
 #include "../constants.h"
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 #include <limits>
@@ -14,7 +15,7 @@
 
 using namespace taptenc;
 
-clock::clock(::std::string arg_id) : id(arg_id) {}
+clock::clock(Symbol arg_id) : id(arg_id) {}
 
 // Comparison Utils
 
@@ -78,8 +79,225 @@ ComparisonOp computils::inverseOp(ComparisonOp op) {
   return op;
 }
 
+int computils::compareClocks(const ::std::shared_ptr<Clock> &l,
+                             const ::std::shared_ptr<Clock> &r) {
+  if (l == r || l->id == r->id) {
+    return 0;
+  }
+  return l->id < r->id ? -1 : 1;
+}
+
 // Constraints
 
+/**
+ * Helpers for the structural comparison and the canonicalization of clock
+ * constraints.
+ */
+namespace ccutils {
+/**
+ * Three-way comparison of two values using operator<.
+ */
+template <typename T> int threeWay(const T &l, const T &r) {
+  return (l < r) ? -1 : ((r < l) ? 1 : 0);
+}
+
+/**
+ * Equality check used for interning. Unlike ClockConstraint::compare(), clocks
+ * are compared by identity and subexpressions of conjunctions by pointer
+ * (as they are interned already).
+ */
+bool isSameConstraint(const ClockConstraint &l, const ClockConstraint &r) {
+  if (&l == &r) {
+    return true;
+  }
+  if (l.type != r.type) {
+    return false;
+  }
+  switch (l.type) {
+  case CCType::TRUE:
+    return true;
+  case CCType::UNPARSED:
+    return static_cast<const UnparsedCC &>(l).raw_cc ==
+           static_cast<const UnparsedCC &>(r).raw_cc;
+  case CCType::CONJUNCTION:
+    return static_cast<const ConjunctionCC &>(l).content ==
+           static_cast<const ConjunctionCC &>(r).content;
+  case CCType::SIMPLE_BOUND: {
+    const ComparisonCC &l_comp = static_cast<const ComparisonCC &>(l);
+    const ComparisonCC &r_comp = static_cast<const ComparisonCC &>(r);
+    return l_comp.clock == r_comp.clock && l_comp.comp == r_comp.comp &&
+           l_comp.constant == r_comp.constant;
+  }
+  case CCType::DIFFERENCE: {
+    const DifferenceCC &l_diff = static_cast<const DifferenceCC &>(l);
+    const DifferenceCC &r_diff = static_cast<const DifferenceCC &>(r);
+    return l_diff.minuend == r_diff.minuend &&
+           l_diff.subtrahend == r_diff.subtrahend &&
+           l_diff.comp == r_diff.comp &&
+           l_diff.difference == r_diff.difference;
+  }
+  default:
+    return false;
+  }
+}
+
+/**
+ * Appends the interned conjuncts of a constraint, flattening conjunctions
+ * and dropping trivial constraints.
+ */
+void appendConjuncts(const ClockConstraint &cc,
+                     std::vector<constraint_ptr_t> &res) {
+  if (cc.type == CCType::TRUE) {
+    return;
+  }
+  if (cc.type == CCType::CONJUNCTION) {
+    const ConjunctionCC &conj = static_cast<const ConjunctionCC &>(cc);
+    res.insert(res.end(), conj.content.begin(), conj.content.end());
+    return;
+  }
+  res.push_back(ConstraintTable::instance().intern(cc));
+}
+
+enum BoundDirection { LOWER, UPPER, OTHER };
+
+/**
+ * View on a constraint as bound of a clock (minuend without subtrahend) or
+ * of a clock difference.
+ */
+struct BoundInfo {
+  BoundDirection dir = BoundDirection::OTHER;
+  Symbol minuend;
+  Symbol subtrahend;
+  ComparisonOp op = ComparisonOp::EQ;
+  timepoint constant = 0;
+
+  BoundInfo(const ClockConstraint &cc) {
+    if (cc.type == CCType::SIMPLE_BOUND) {
+      const ComparisonCC &comp = static_cast<const ComparisonCC &>(cc);
+      minuend = comp.clock->id;
+      op = comp.comp;
+      constant = comp.constant;
+    } else if (cc.type == CCType::DIFFERENCE) {
+      const DifferenceCC &diff = static_cast<const DifferenceCC &>(cc);
+      minuend = diff.minuend->id;
+      subtrahend = diff.subtrahend->id;
+      op = diff.comp;
+      constant = diff.difference;
+    } else {
+      return;
+    }
+    if (op == ComparisonOp::LT || op == ComparisonOp::LTE) {
+      dir = BoundDirection::UPPER;
+    } else if (op == ComparisonOp::GT || op == ComparisonOp::GTE) {
+      dir = BoundDirection::LOWER;
+    }
+  }
+
+  /** Bounds of the same direction on the same clock (difference). */
+  bool hasSameSlot(const BoundInfo &other) const {
+    return dir == other.dir && minuend == other.minuend &&
+           subtrahend == other.subtrahend;
+  }
+
+  /** Compares two bounds of the same slot. */
+  bool isTighterThan(const BoundInfo &other) const {
+    if (constant != other.constant) {
+      return (dir == BoundDirection::UPPER) ? constant < other.constant
+                                            : constant > other.constant;
+    }
+    return (op == ComparisonOp::LT || op == ComparisonOp::GT) &&
+           op != other.op;
+  }
+
+  /** Checks whether this lower bound exceeds the upper bound \a upper. */
+  bool contradicts(const BoundInfo &upper) const {
+    return constant > upper.constant ||
+           (constant == upper.constant &&
+            (op == ComparisonOp::GT || upper.op == ComparisonOp::LT));
+  }
+};
+} // end namespace ccutils
+
+// ConstraintTable
+ConstraintTable &ConstraintTable::instance() {
+  static ConstraintTable table;
+  return table;
+}
+
+constexpr ::std::size_t ConstraintTable::MIN_PURGE_THRESHOLD;
+
+ConstraintTable::shard &ConstraintTable::shardOf(::std::size_t cc_hash) {
+  return shards[cc_hash % NUM_SHARDS];
+}
+
+constraint_ptr_t ConstraintTable::find(shard &sh, const ClockConstraint &cc,
+                                       ::std::size_t cc_hash) {
+  auto range = sh.entries.equal_range(cc_hash);
+  for (auto it = range.first; it != range.second;) {
+    constraint_ptr_t entry = it->second.lock();
+    if (!entry) {
+      it = sh.entries.erase(it);
+      continue;
+    }
+    if (ccutils::isSameConstraint(*entry, cc)) {
+      return entry;
+    }
+    ++it;
+  }
+  return nullptr;
+}
+
+constraint_ptr_t ConstraintTable::intern(const ClockConstraint &cc) {
+  if (cc.type == CCType::CONJUNCTION) {
+    // trivial conjunctions are represented by their only conjunct
+    const ConjunctionCC &conj = static_cast<const ConjunctionCC &>(cc);
+    if (conj.content.size() == 0) {
+      return intern(TrueCC());
+    }
+    if (conj.content.size() == 1) {
+      return conj.content.front();
+    }
+  }
+  std::size_t cc_hash = cc.hash();
+  shard &sh = shardOf(cc_hash);
+  {
+    std::lock_guard<std::mutex> lock(sh.shard_mutex);
+    constraint_ptr_t res = find(sh, cc, cc_hash);
+    if (res) {
+      return res;
+    }
+  }
+  // copy without holding the lock, copying a conjunction interns its operands
+  constraint_ptr_t copy = cc.createCopy();
+  std::lock_guard<std::mutex> lock(sh.shard_mutex);
+  constraint_ptr_t res = find(sh, cc, cc_hash);
+  if (res) {
+    return res;
+  }
+  sh.entries.emplace(cc_hash, copy);
+  if (sh.entries.size() > sh.purge_threshold) {
+    for (auto it = sh.entries.begin(); it != sh.entries.end();) {
+      if (it->second.expired()) {
+        it = sh.entries.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    sh.purge_threshold =
+        std::max<std::size_t>(MIN_PURGE_THRESHOLD, 2 * sh.entries.size());
+  }
+  return copy;
+}
+
+::std::size_t ConstraintTable::size() const {
+  std::size_t res = 0;
+  for (const auto &sh : shards) {
+    std::lock_guard<std::mutex> lock(sh.shard_mutex);
+    res += sh.entries.size();
+  }
+  return res;
+}
+
 // TrueCC
 trueCC::trueCC() { type = CCType::TRUE; }
 
@@ -89,6 +307,12 @@ trueCC::trueCC() { type = CCType::TRUE; }
   return std::make_unique<TrueCC>(TrueCC());
 }
 
+::std::size_t trueCC::hash() const { return std::hash<int>()(type); }
+
+int trueCC::compare(const ClockConstraint &other) const {
+  return ccutils::threeWay(type, other.type);
+}
+
 // UnparsedCC
 unparsedCC::unparsedCC(::std::string cc_string) {
   type = CCType::UNPARSED;
@@ -101,33 +325,109 @@ unparsedCC::unparsedCC(::std::string cc_string) {
   return std::make_unique<UnparsedCC>(UnparsedCC(raw_cc));
 }
 
+::std::size_t unparsedCC::hash() const {
+  return computils::hashCombine(std::hash<int>()(type),
+                                std::hash<std::string>()(raw_cc));
+}
+
+int unparsedCC::compare(const ClockConstraint &other) const {
+  if (type != other.type) {
+    return ccutils::threeWay(type, other.type);
+  }
+  return raw_cc.compare(static_cast<const UnparsedCC &>(other).raw_cc);
+}
+
 // ConjunctionCC
 conjunctionCC::conjunctionCC(const ClockConstraint &first,
-                             const ClockConstraint &second) {
-  ::std::unique_ptr<ClockConstraint> first_copy = first.createCopy();
-  ::std::unique_ptr<ClockConstraint> second_copy = second.createCopy();
-  content.first = std::move(first_copy);
-  content.second = std::move(second_copy);
+                             const ClockConstraint &second)
+    : satisfiable(true) {
   type = CCType::CONJUNCTION;
+  std::vector<constraint_ptr_t> conjuncts;
+  ccutils::appendConjuncts(first, conjuncts);
+  ccutils::appendConjuncts(second, conjuncts);
+  // only keep the tightest lower and upper bound of each clock (difference)
+  std::vector<ccutils::BoundInfo> content_bounds;
+  for (const auto &cc : conjuncts) {
+    ccutils::BoundInfo cc_bound(*cc);
+    std::size_t slot = 0;
+    while (slot < content.size() && content[slot] != cc &&
+           (cc_bound.dir == ccutils::BoundDirection::OTHER ||
+            !content_bounds[slot].hasSameSlot(cc_bound))) {
+      slot++;
+    }
+    if (slot == content.size()) {
+      content.push_back(cc);
+      content_bounds.push_back(cc_bound);
+    } else if (content[slot] != cc &&
+               cc_bound.isTighterThan(content_bounds[slot])) {
+      content[slot] = cc;
+      content_bounds[slot] = cc_bound;
+    }
+  }
+  for (std::size_t i = 0; i < content.size() && satisfiable; i++) {
+    satisfiable = content[i]->isSatisfiable();
+    const ccutils::BoundInfo &lower = content_bounds[i];
+    if (lower.dir != ccutils::BoundDirection::LOWER) {
+      continue;
+    }
+    for (const auto &upper : content_bounds) {
+      if (upper.dir == ccutils::BoundDirection::UPPER &&
+          upper.minuend == lower.minuend &&
+          upper.subtrahend == lower.subtrahend && lower.contradicts(upper)) {
+        satisfiable = false;
+      }
+    }
+  }
+  std::sort(content.begin(), content.end(),
+            [](const constraint_ptr_t &l, const constraint_ptr_t &r) {
+              return l != r && l->compare(*r) < 0;
+            });
+  hash_value = std::hash<int>()(type);
+  for (const auto &cc : content) {
+    hash_value = computils::hashCombine(hash_value, cc->hash());
+  }
 }
 
 ::std::string conjunctionCC::toString() const {
   std::string res = "";
-  std::string lhs = content.first->toString();
-  std::string rhs = content.second->toString();
-  res += lhs;
-  if (lhs.size() > 0 && rhs.size() > 0) {
-    res += " &amp;&amp; ";
+  for (const auto &cc : content) {
+    std::string cc_str = cc->toString();
+    if (res.size() > 0 && cc_str.size() > 0) {
+      res += " &amp;&amp; ";
+    }
+    res += cc_str;
   }
-  res += rhs;
   return res;
 }
 
 ::std::unique_ptr<ClockConstraint> conjunctionCC::createCopy() const {
-  return std::make_unique<ConjunctionCC>(
-      ConjunctionCC(*content.first, *content.second));
+  // operands are immutable, hence they are shared with the copy
+  return std::make_unique<ConjunctionCC>(*this);
 }
 
+::std::size_t conjunctionCC::hash() const { return hash_value; }
+
+int conjunctionCC::compare(const ClockConstraint &other) const {
+  if (type != other.type) {
+    return ccutils::threeWay(type, other.type);
+  }
+  const ConjunctionCC &other_conj = static_cast<const ConjunctionCC &>(other);
+  if (content.size() != other_conj.content.size()) {
+    return ccutils::threeWay(content.size(), other_conj.content.size());
+  }
+  for (std::size_t i = 0; i < content.size(); i++) {
+    if (content[i] != other_conj.content[i]) {
+      int res = content[i]->compare(*other_conj.content[i]);
+      if (res != 0) {
+        return res;
+      }
+    }
+  }
+  return 0;
+}
+
+bool conjunctionCC::isSatisfiable() const { return satisfiable; }
+
 // ComparisonCC
 comparisonCC::comparisonCC(::std::shared_ptr<Clock> arg_clock,
                            ComparisonOp arg_comp, timepoint arg_constant)
@@ -144,6 +444,42 @@ comparisonCC::comparisonCC(::std::shared_ptr<Clock> arg_clock,
   return clock->id + computils::toString(comp) + std::to_string(constant);
 }
 
+::std::size_t comparisonCC::hash() const {
+  std::size_t res = std::hash<int>()(type);
+  res = computils::hashCombine(res, std::hash<Symbol>()(clock->id));
+  res = computils::hashCombine(res, std::hash<int>()(comp));
+  return computils::hashCombine(res, std::hash<timepoint>()(constant));
+}
+
+bool comparisonCC::isSatisfiable() const {
+  // clocks are non-negative
+  switch (comp) {
+  case ComparisonOp::LT:
+    return constant > 0;
+  case ComparisonOp::LTE:
+  case ComparisonOp::EQ:
+    return constant >= 0;
+  default:
+    return true;
+  }
+}
+
+int comparisonCC::compare(const ClockConstraint &other) const {
+  if (type != other.type) {
+    return ccutils::threeWay(type, other.type);
+  }
+  const ComparisonCC &other_comp = static_cast<const ComparisonCC &>(other);
+  int res = computils::compareClocks(clock, other_comp.clock);
+  if (res != 0) {
+    return res;
+  }
+  res = ccutils::threeWay(comp, other_comp.comp);
+  if (res != 0) {
+    return res;
+  }
+  return ccutils::threeWay(constant, other_comp.constant);
+}
+
 // DifferenceCC
 differenceCC::differenceCC(::std::shared_ptr<Clock> arg_minuend,
                            ::std::shared_ptr<Clock> arg_subtrahend,
@@ -163,6 +499,34 @@ differenceCC::differenceCC(::std::shared_ptr<Clock> arg_minuend,
          computils::toString(comp) + std::to_string(difference);
 }
 
+::std::size_t differenceCC::hash() const {
+  std::size_t res = std::hash<int>()(type);
+  res = computils::hashCombine(res, std::hash<Symbol>()(minuend->id));
+  res = computils::hashCombine(res, std::hash<Symbol>()(subtrahend->id));
+  res = computils::hashCombine(res, std::hash<int>()(comp));
+  return computils::hashCombine(res, std::hash<timepoint>()(difference));
+}
+
+int differenceCC::compare(const ClockConstraint &other) const {
+  if (type != other.type) {
+    return ccutils::threeWay(type, other.type);
+  }
+  const DifferenceCC &other_diff = static_cast<const DifferenceCC &>(other);
+  int res = computils::compareClocks(minuend, other_diff.minuend);
+  if (res != 0) {
+    return res;
+  }
+  res = computils::compareClocks(subtrahend, other_diff.subtrahend);
+  if (res != 0) {
+    return res;
+  }
+  res = ccutils::threeWay(comp, other_diff.comp);
+  if (res != 0) {
+    return res;
+  }
+  return ccutils::threeWay(difference, other_diff.difference);
+}
+
 // Bounds
 
 bounds::bounds()
@@ -208,14 +572,14 @@ ConjunctionCC bounds::createConstraintBoundsSat(
   return ConjunctionCC(*below_upper_bound.get(), *lower_bound_reached.get());
 }
 
-bool bounds::operator == (const bounds &other) {
+bool bounds::operator == (const bounds &other) const {
   return this->l_op == other.l_op
          && this->r_op == other.r_op
          && this->lower_bound == other.lower_bound
          && this->upper_bound == other.upper_bound;
 }
 
-bool bounds::operator != (const bounds &other) {
+bool bounds::operator != (const bounds &other) const {
 	return !(*this == other);
 }
 
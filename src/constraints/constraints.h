@@ -6,9 +6,12 @@
 
 #pragma once
 
+#include "../timed-automata/symbol_table.h"
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace taptenc {
@@ -23,8 +26,8 @@ using timepoint = int;
  * Clock representation.
  */
 struct clock {
-  std::string id;
-  clock(::std::string arg_id);
+  Symbol id;
+  clock(Symbol arg_id);
 };
 typedef clock Clock;
 
@@ -72,13 +75,35 @@ ComparisonOp reverseOp(ComparisonOp op);
  * @return inverted comparison operator of \a op
  */
 ComparisonOp inverseOp(ComparisonOp op);
+
+/**
+ * Mixes a hash value into a seed (as done by boost::hash_combine).
+ *
+ * @param seed hash value to extend
+ * @param value hash value to mix into \a seed
+ * @return combined hash value
+ */
+inline ::std::size_t hashCombine(::std::size_t seed, ::std::size_t value) {
+  return seed ^ (value + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+}
+
+/**
+ * Three-way comparison of two clocks by their ids.
+ *
+ * @param l first clock
+ * @param r second clock
+ * @return negative, zero or positive value if \a l is ordered before, equal
+ *         to or after \a r
+ */
+int compareClocks(const ::std::shared_ptr<Clock> &l,
+                  const ::std::shared_ptr<Clock> &r);
 } // end namespace computils
 
 /**
  * Clock Constraint types.
  */
 enum CCType {
-  /** Conjunction of exactly two clock constraints. */
+  /** Conjunction of arbitrary many (non-conjunctive) clock constraints. */
   CONJUNCTION,
   /** Difference constraint (comparison of the clock difference of two clocks
    * against a constant.
@@ -97,6 +122,10 @@ enum CCType {
 /**
  * Clock constraint base class. Represents the basic clock constraints of
  * timed automata syntax, but not the extended expressiveness of uppaal.
+ *
+ * Constraints are immutable once created. Constraints that are stored within
+ * automata are obtained from the ConstraintTable and shared between all
+ * states and transitions using them.
  */
 struct clockConstraint {
   /** Holds the real type concrete object type. */
@@ -111,13 +140,115 @@ struct clockConstraint {
    * Operators &, <, > are replaced by their respective html encodings.
    */
   virtual ::std::string toString() const = 0;
+  /**
+   * Structural hash value, consistent with compare().
+   */
+  virtual ::std::size_t hash() const = 0;
+  /**
+   * Structural three-way comparison.
+   *
+   * Constraints of different types are ordered by their CCType, constraints
+   * of the same type by their content.
+   *
+   * @param other constraint to compare against
+   * @return negative, zero or positive value if this is ordered before, equal
+   *         to or after \a other
+   */
+  virtual int compare(const struct clockConstraint &other) const = 0;
+  /**
+   * Checks whether the constraint can be satisfied by non-negative clock
+   * values. Returns true if the check is inconclusive.
+   */
+  virtual bool isSatisfiable() const { return true; }
+  virtual ~clockConstraint() = default;
 };
 typedef struct clockConstraint ClockConstraint;
 
+/** Shared handle to an immutable (interned) clock constraint. */
+typedef ::std::shared_ptr<const ClockConstraint> constraint_ptr_t;
+
+/**
+ * Process wide table of hash-consed clock constraints.
+ *
+ * Structurally equal constraints are interned to the same shared instance,
+ * hence copying a state or a transition only copies a pointer. Conjunctions
+ * only refer to interned subexpressions, which allows to check interned
+ * conjunctions for equality by comparing the subexpression pointers.
+ *
+ * The table only holds weak references, constraints that are no longer used
+ * by any automaton are released and their entries are purged lazily.
+ * Interning is sharded by the hash of the constraint, each shard is guarded
+ * by its own mutex, so threads encoding different platforms rarely contend.
+ * Interned constraints can be read without any synchronization as they are
+ * never modified.
+ */
+class ConstraintTable {
+private:
+  static constexpr ::std::size_t NUM_SHARDS = 32;
+  /** Minimal shard size that triggers a purge of released constraints. */
+  static constexpr ::std::size_t MIN_PURGE_THRESHOLD = 64;
+
+  struct shard {
+    ::std::unordered_multimap<::std::size_t,
+                              ::std::weak_ptr<const ClockConstraint>>
+        entries;
+    /** Shard size that triggers the next purge of released constraints. */
+    ::std::size_t purge_threshold = MIN_PURGE_THRESHOLD;
+    mutable ::std::mutex shard_mutex;
+  };
+
+  shard shards[NUM_SHARDS];
+  ConstraintTable() = default;
+
+  shard &shardOf(::std::size_t cc_hash);
+  /**
+   * Looks up an interned constraint, requires the mutex of \a sh to be held.
+   *
+   * @param sh shard responsible for \a cc_hash
+   * @param cc constraint to look up
+   * @param cc_hash hash value of \a cc
+   * @return interned constraint equal to \a cc, nullptr if there is none
+   */
+  static constraint_ptr_t find(shard &sh, const ClockConstraint &cc,
+                               ::std::size_t cc_hash);
+
+public:
+  ConstraintTable(const ConstraintTable &) = delete;
+  ConstraintTable &operator=(const ConstraintTable &) = delete;
+
+  /**
+   * Access to the global constraint table.
+   *
+   * @return the one constraint table shared by all automata
+   */
+  static ConstraintTable &instance();
+
+  /**
+   * Interns a constraint.
+   *
+   * Constraints are considered equal if they are structurally equal and
+   * refer to the same clock objects.
+   *
+   * @param cc constraint to intern
+   * @return shared instance equal to \a cc, which is copied from \a cc if
+   *         not yet present
+   */
+  constraint_ptr_t intern(const ClockConstraint &cc);
+
+  /**
+   * Returns the number of entries, including not yet purged released ones.
+   *
+   * @return number of entries in the table
+   */
+  ::std::size_t size() const;
+};
+
 /** True constraint. */
 struct trueCC : public ClockConstraint {
   ::std::unique_ptr<struct clockConstraint> createCopy() const;
   ::std::string toString() const;
+  ::std::size_t hash() const;
+  int compare(const ClockConstraint &other) const;
   trueCC();
 };
 typedef struct trueCC TrueCC;
@@ -133,27 +264,40 @@ struct unparsedCC : public ClockConstraint {
   ::std::string raw_cc;
   ::std::unique_ptr<struct clockConstraint> createCopy() const;
   ::std::string toString() const;
+  ::std::size_t hash() const;
+  int compare(const ClockConstraint &other) const;
   unparsedCC(::std::string cc_string);
 };
 typedef struct unparsedCC UnparsedCC;
 
 /**
- * Conjunction of exactly two clock constraints. Nesting is possible to
- * express arbitrary long conjunctions.
+ * Conjunction of clock constraints in canonical form.
+ *
+ * Nested conjunctions are flattened and trivial constraints are dropped.
+ * For each clock (and each clock difference) only the tightest lower and the
+ * tightest upper bound are kept. The remaining constraints are sorted by
+ * ClockConstraint::compare(), hence equivalent conjunctions built in a
+ * different order are structurally equal.
  */
 struct conjunctionCC : public ClockConstraint {
-  /** Subexpressions that form the conjunction. */
-  std::pair<std::unique_ptr<clockConstraint>, std::unique_ptr<clockConstraint>>
-      content;
+  /** Sorted, interned constraints that form the conjunction. */
+  ::std::vector<constraint_ptr_t> content;
+  /** False if the bounds of some clock (difference) contradict each other. */
+  bool satisfiable;
+  /** Cached hash value over all constraints of the conjunction. */
+  ::std::size_t hash_value;
 
   ::std::unique_ptr<ClockConstraint> createCopy() const;
   ::std::string toString() const;
+  ::std::size_t hash() const;
+  int compare(const ClockConstraint &other) const;
+  bool isSatisfiable() const;
 
   /**
-   * Creates a new conjunction given two clock constraints.
+   * Creates the canonical conjunction of two clock constraints.
    *
-   * Copies the input clock constraints to form a completely independent
-   * constraint.
+   * The constraints forming the result are interned, hence they are only
+   * copied if no equal constraint is interned yet.
    *
    * @param first lhs of the conjunction
    * @param second rhs of the conjunction
@@ -183,6 +327,9 @@ struct comparisonCC : public ClockConstraint {
 
   ::std::unique_ptr<ClockConstraint> createCopy() const;
   ::std::string toString() const;
+  ::std::size_t hash() const;
+  int compare(const ClockConstraint &other) const;
+  bool isSatisfiable() const;
 };
 typedef struct comparisonCC ComparisonCC;
 
@@ -212,6 +359,8 @@ struct differenceCC : public ClockConstraint {
 
   ::std::unique_ptr<ClockConstraint> createCopy() const;
   ::std::string toString() const;
+  ::std::size_t hash() const;
+  int compare(const ClockConstraint &other) const;
 };
 typedef struct differenceCC DifferenceCC;
 
@@ -268,8 +417,8 @@ struct bounds {
   ConjunctionCC
   createConstraintBoundsSat(const ::std::shared_ptr<Clock> &clock_ptr) const;
 
-  bool operator == (const bounds &other);
-  bool operator != (const bounds &other);
+  bool operator == (const bounds &other) const;
+  bool operator != (const bounds &other) const;
 };
 typedef struct bounds Bounds;
 
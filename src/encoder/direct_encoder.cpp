@@ -12,9 +12,13 @@
 #include "timed_automata.h"
 #include "utils.h"
 #include "vis_info.h"
+#include "logging.h"
 #include <algorithm>
+#include <cassert>
 #include <iostream>
+#include <iterator>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -25,12 +29,15 @@ using namespace encoderutils;
 
 void DirectEncoder::generateBaseTimeLine(AutomataSystem &s,
                                          const int base_index,
-                                         const int plan_index) {
-  std::cout << "DirectEncoder generateBaseTimeLine: Assuming plan automaton "
-               "states are sorted by plan order!"
-            << std::endl;
+                                         const int plan_index,
+                                         const size_t first_pa) {
+  TAPTENC_LOG_DEBUG("DirectEncoder generateBaseTimeLine: Assuming plan "
+                    "automaton states are sorted by plan order!");
   Filter base_filter = Filter(s.instances[base_index].first.states);
-  for (const auto &pa : s.instances[plan_index].first.states) {
+  const auto &plan_states = s.instances[plan_index].first.states;
+  for (auto pa_it = plan_states.begin() + first_pa; pa_it != plan_states.end();
+       ++pa_it) {
+    const State &pa = *pa_it;
     TimeLine tl;
     std::string ta_prefix = toPrefix("", "", pa.id);
     Automaton ta_copy = base_filter.filterAutomaton(
@@ -40,8 +47,8 @@ void DirectEncoder::generateBaseTimeLine(AutomataSystem &s,
                                  [](const State &s) { return s.initial; });
       if (search != ta_copy.states.end()) {
         search->initial = true;
-        std::cout << "DirectEncoder generateBaseTimeLine: Set initial state: "
-                  << search->id << std::endl;
+        TAPTENC_LOG_DEBUG("DirectEncoder generateBaseTimeLine: Set initial "
+                          "state: " << search->id);
       }
     } else {
       for (auto &s : ta_copy.states) {
@@ -53,19 +60,17 @@ void DirectEncoder::generateBaseTimeLine(AutomataSystem &s,
     auto emp_ta = tl.emplace(
         std::make_pair(ta_prefix, TlEntry(ta_copy, std::vector<Transition>())));
     if (emp_ta.second == true) {
-      addInvariants(emp_ta.first->second.ta, emp_ta.first->second.ta.states,
-                    *pa.inv.get());
+      Automaton &base_ta = emp_ta.first->second.ta.write();
+      addInvariants(base_ta, base_ta.states, *pa.inv.get());
     } else {
-      std::cout << "DirectEncoder generateBaseTimeLine: plan automaton has non "
-                   "unique id (id "
-                << pa.id << ")" << std::endl;
+      TAPTENC_LOG_WARN("DirectEncoder generateBaseTimeLine: plan automaton "
+                       "has non unique id (id " << pa.id << ")");
     }
     po_tls.pa_order.get()->push_back(pa.id);
     auto emp_tl = po_tls.tls->emplace(std::make_pair(pa.id, tl));
     if (emp_tl.second == false) {
-      std::cout << "DirectEncoder generateBaseTimeLine: plan action timeline "
-                   "already present (pa "
-                << pa.id << ")" << std::endl;
+      TAPTENC_LOG_WARN("DirectEncoder generateBaseTimeLine: plan action "
+                       "timeline already present (pa " << pa.id << ")");
     }
   }
   // generate query state
@@ -77,21 +82,26 @@ void DirectEncoder::generateBaseTimeLine(AutomataSystem &s,
       constants::QUERY, TlEntry(query_ta, std::vector<Transition>())));
   auto emp_tl = po_tls.tls->emplace(std::make_pair(constants::QUERY, query_tl));
   if (emp_tl.second == false) {
-    std::cout << "DirectEncoder generateBaseTimeLine: query timeline "
-                 "already present (no plan action can be named query) "
-              << std::endl;
+    TAPTENC_LOG_WARN("DirectEncoder generateBaseTimeLine: query timeline "
+                     "already present (no plan action can be named query) ");
   }
   // make transitions from last plan actions to query
   for (auto &last_tl :
        po_tls.tls->find(s.instances[plan_index].first.states.back().id)
            ->second) {
-    for (auto &s : last_tl.second.ta.states) {
-      last_tl.second.trans_out.push_back(
+    for (auto &s : last_tl.second.ta->states) {
+      last_tl.second.trans_out.write().push_back(
           Transition(s.id, constants::QUERY, "", TrueCC(), {}, ""));
     }
   }
-  // generate connections between TLs according to plan TA transitions
+  // generate connections between TLs according to plan TA transitions,
+  // timelines that were already present are connected already
+  auto kept_end = po_tls.pa_order->begin() + first_pa;
   for (const auto &pa_trans : s.instances[plan_index].first.transitions) {
+    if (std::find(po_tls.pa_order->begin(), kept_end,
+                  pa_trans.source_id.str()) != kept_end) {
+      continue;
+    }
     auto source_ta = po_tls.tls->find(pa_trans.source_id);
     auto dest_ta = po_tls.tls->find(pa_trans.dest_id);
     if (source_ta != po_tls.tls->end() && dest_ta != po_tls.tls->end()) {
@@ -100,20 +110,16 @@ void DirectEncoder::generateBaseTimeLine(AutomataSystem &s,
       std::vector<Transition> copy_trans = createCopyTransitionsBetweenTAs(
           source_ta->second.find(source_ta_prefix)->second.ta,
           dest_ta->second.find(dest_ta_prefix)->second.ta,
-          source_ta->second.find(source_ta_prefix)->second.ta.states,
+          source_ta->second.find(source_ta_prefix)->second.ta->states,
           *pa_trans.guard.get(), pa_trans.update, "");
-      po_tls.tls.get()
-          ->find(pa_trans.source_id)
-          ->second.find(source_ta_prefix)
-          ->second.trans_out.insert(po_tls.tls.get()
-                                        ->find(pa_trans.source_id)
-                                        ->second.find(source_ta_prefix)
-                                        ->second.trans_out.end(),
-                                    copy_trans.begin(), copy_trans.end());
+      std::vector<Transition> &source_trans_out =
+          source_ta->second.find(source_ta_prefix)->second.trans_out.write();
+      source_trans_out.insert(source_trans_out.end(), copy_trans.begin(),
+                              copy_trans.end());
     } else {
-      std::cout << "DirectEncoder generateBaseTimeLine: pa "
-                << pa_trans.source_id << " or " << pa_trans.dest_id
-                << " has no timeline yet" << std::endl;
+      TAPTENC_LOG_WARN("DirectEncoder generateBaseTimeLine: pa "
+                       << pa_trans.source_id << " or " << pa_trans.dest_id
+                       << " has no timeline yet");
     }
   }
 }
@@ -121,7 +127,8 @@ void DirectEncoder::generateBaseTimeLine(AutomataSystem &s,
 std::pair<int, int>
 DirectEncoder::calculateContext(const TargetSpecs &specs,
                                 std::string starting_pa, std::string ending_pa,
-                                bool look_ahead, int lb_offset, int ub_offset) {
+                                bool look_ahead, int lb_offset,
+                                int ub_offset) const {
   if (look_ahead) {
     int start_index = 0;
     if (starting_pa != constants::START_PA) {
@@ -141,8 +148,8 @@ DirectEncoder::calculateContext(const TargetSpecs &specs,
     }
     int offset_index = start_index;
     if ((long unsigned int)start_index >= plan.size()) {
-      std::cout << "DirectEncoder calculateContext: starting pa " << starting_pa
-                << " is out of range" << std::endl;
+      TAPTENC_LOG_WARN("DirectEncoder calculateContext: starting pa "
+                       << starting_pa << " is out of range");
       return std::make_pair(0, 0);
     }
     int lb_acc = 0;
@@ -219,8 +226,8 @@ void DirectEncoder::encodeInvariant(AutomataSystem &,
     auto search_pa = std::find(po_tls.pa_order.get()->begin(),
                                po_tls.pa_order.get()->end(), pa);
     if (search_pa == po_tls.pa_order.get()->end()) {
-      std::cout << "DirectEncoder encodeInvariant: could not find pa " << pa
-                << std::endl;
+      TAPTENC_LOG_WARN("DirectEncoder encodeInvariant: could not find pa "
+                       << pa);
       return;
     }
     // restrict transitions from prev tl to target states
@@ -230,19 +237,18 @@ void DirectEncoder::encodeInvariant(AutomataSystem &,
                ->find(po_tls.pa_order.get()->at(
                    search_pa - po_tls.pa_order.get()->begin() - 1))
                ->second) {
-        target_filter.filterTransitionsInPlace(prev_tl_entry.second.trans_out,
-                                               pa, false);
+        target_filter.filterTransitionsInPlace(
+            prev_tl_entry.second.trans_out.write(), pa, false);
       }
     }
     for (auto &tl_entry : search_tl->second) {
-      target_filter.filterAutomatonInPlace(tl_entry.second.ta, "");
-      target_filter.filterTransitionsInPlace(tl_entry.second.trans_out, pa,
-                                             true);
+      target_filter.filterAutomatonInPlace(tl_entry.second.ta.write(), "");
+      target_filter.filterTransitionsInPlace(
+          tl_entry.second.trans_out.write(), pa, true);
     }
   } else {
-    std::cout
-        << " DirectEncoder encodeInvariant: could not find timeline of pa "
-        << pa << std::endl;
+    TAPTENC_LOG_WARN("DirectEncoder encodeInvariant: could not find "
+                     "timeline of pa " << pa);
   }
 }
 
@@ -255,8 +261,7 @@ void DirectEncoder::encodeNoOp(AutomataSystem &,
     auto search_pa = std::find(po_tls.pa_order.get()->begin(),
                                po_tls.pa_order.get()->end(), pa);
     if (search_pa == po_tls.pa_order.get()->end()) {
-      std::cout << "DirectEncoder encodeNoOp: could not find pa " << pa
-                << std::endl;
+      TAPTENC_LOG_WARN("DirectEncoder encodeNoOp: could not find pa " << pa);
       return;
     }
     // restrict transitions from prev tl to target states
@@ -266,13 +271,13 @@ void DirectEncoder::encodeNoOp(AutomataSystem &,
                ->find(po_tls.pa_order.get()->at(
                    search_pa - po_tls.pa_order.get()->begin() - 1))
                ->second) {
-        target_filter.filterTransitionsInPlace(prev_tl_entry.second.trans_out,
-                                               pa, false);
+        target_filter.filterTransitionsInPlace(
+            prev_tl_entry.second.trans_out.write(), pa, false);
       }
     }
   } else {
-    std::cout << "DirectEncoder encodeNoOp: could not find timeline of pa "
-              << pa << std::endl;
+    TAPTENC_LOG_WARN("DirectEncoder encodeNoOp: could not find timeline of pa "
+                     << pa);
   }
 }
 
@@ -281,8 +286,7 @@ void DirectEncoder::encodeUntilChain(AutomataSystem &s, const ChainInfo &info,
                                      const std::string end_pa,
                                      const int base_index) {
   if (info.specs_list.size() == 0) {
-    std::cout << "DirectEncoder enodeUntilchain: empty info, abort."
-              << std::endl;
+    TAPTENC_LOG_WARN("DirectEncoder enodeUntilchain: empty info, abort.");
   }
   Filter base_filter = Filter(s.instances[base_index].first.states);
   std::string clock = "clX" + info.name;
@@ -291,15 +295,15 @@ void DirectEncoder::encodeUntilChain(AutomataSystem &s, const ChainInfo &info,
   auto start_pa_entry = std::find(po_tls.pa_order.get()->begin(),
                                   po_tls.pa_order.get()->end(), start_pa);
   if (start_pa_entry == po_tls.pa_order.get()->end()) {
-    std::cout << "DirectEncoder encodeUntilChain: could not find start pa "
-              << start_pa << std::endl;
+    TAPTENC_LOG_WARN("DirectEncoder encodeUntilChain: could not find start pa "
+                     << start_pa);
     return;
   }
   auto end_pa_entry =
       std::find(start_pa_entry, po_tls.pa_order.get()->end(), end_pa);
   if (end_pa_entry == po_tls.pa_order.get()->end()) {
-    std::cout << "DirectEncoder encodeUntilChain: could not find end pa "
-              << end_pa << std::endl;
+    TAPTENC_LOG_WARN("DirectEncoder encodeUntilChain: could not find end pa "
+                     << end_pa);
     return;
   }
   int lb_acc = 0;
@@ -394,7 +398,7 @@ void DirectEncoder::encodeUntilChain(AutomataSystem &s, const ChainInfo &info,
             *(po_tls.pa_order.get()->begin() + context_start - 1);
         for (auto &prev_pa_entry : po_tls.tls.get()->find(prev_pa)->second) {
           PlanOrderedTLs::modifyTransitionsToNextTl(
-              prev_pa_entry.second.trans_out, prev_pa,
+              prev_pa_entry.second.trans_out.write(), prev_pa,
               target_filter.getFilter(), TrueCC(), {clock_ptr}, "", op_name);
         }
       }
@@ -437,8 +441,8 @@ void DirectEncoder::encodeFuture(AutomataSystem &s, const std::string pa,
   auto start_pa_entry = std::find(po_tls.pa_order.get()->begin(),
                                   po_tls.pa_order.get()->end(), pa);
   if (start_pa_entry == po_tls.pa_order.get()->end()) {
-    std::cout << "DirectEncoder encodeFuture: could not find start pa " << pa
-              << std::endl;
+    TAPTENC_LOG_WARN("DirectEncoder encodeFuture: could not find start pa "
+                     << pa);
     return;
   }
   // TLs of the current window
@@ -483,8 +487,8 @@ void DirectEncoder::encodeFuture(AutomataSystem &s, const std::string pa,
         *(po_tls.pa_order.get()->begin() + constraint_start - 1);
     for (auto &prev_pa_entry : po_tls.tls.get()->find(prev_pa)->second) {
       PlanOrderedTLs::modifyTransitionsToNextTl(
-          prev_pa_entry.second.trans_out, prev_pa, base_filter.getFilter(),
-          TrueCC(), {clock_ptr}, "");
+          prev_pa_entry.second.trans_out.write(), prev_pa,
+          base_filter.getFilter(), TrueCC(), {clock_ptr}, "");
     }
   }
   OrigMap orig_id = po_tls.createOrigMapping("");
@@ -505,8 +509,8 @@ void DirectEncoder::encodeFuture(AutomataSystem &s, const std::string pa,
       po_tls.tls.get()->find(last_pa)->second,
       curr_window.tls.get()->find(last_pa)->second, to_orig, TrueCC());
   for (auto &tl_entry : po_tls.tls.get()->find(last_pa)->second) {
-    PlanOrderedTLs::removeTransitionsToNextTl(tl_entry.second.trans_out,
-                                              last_pa);
+    PlanOrderedTLs::removeTransitionsToNextTl(
+        tl_entry.second.trans_out.write(), last_pa);
   }
   po_tls.mergeWindow(*(curr_window.tls.get()), true);
 }
@@ -516,8 +520,8 @@ void DirectEncoder::encodeUntil(AutomataSystem &s, const std::string pa,
   auto start_pa_entry = std::find(po_tls.pa_order.get()->begin(),
                                   po_tls.pa_order.get()->end(), pa);
   if (start_pa_entry == po_tls.pa_order.get()->end()) {
-    std::cout << "DirectEncoder encodeUntil: could not find start pa " << pa
-              << std::endl;
+    TAPTENC_LOG_WARN("DirectEncoder encodeUntil: could not find start pa "
+                     << pa);
     return;
   }
   OrigMap to_orig = po_tls.createOrigMapping("");
@@ -534,9 +538,10 @@ void DirectEncoder::encodeUntil(AutomataSystem &s, const std::string pa,
     if (pa_tl != po_tls.tls->end()) {
       for (auto &tl_entry : pa_tl->second) {
         if (to_orig[tl_entry.first] != "") {
-          pre_target_filter.filterAutomatonInPlace(tl_entry.second.ta, "");
-          pre_target_filter.filterTransitionsInPlace(tl_entry.second.trans_out,
-                                                     "", true);
+          pre_target_filter.filterAutomatonInPlace(
+              tl_entry.second.ta.write(), "");
+          pre_target_filter.filterTransitionsInPlace(
+              tl_entry.second.trans_out.write(), "", true);
         }
       }
     }
@@ -547,12 +552,12 @@ void DirectEncoder::encodeUntil(AutomataSystem &s, const std::string pa,
     auto prev_tl = po_tls.tls->find(prev_pa);
     if (prev_tl != po_tls.tls->end()) {
       for (auto &prev_entry : prev_tl->second) {
-        pre_target_filter.filterTransitionsInPlace(prev_entry.second.trans_out,
-                                                   pa, false);
+        pre_target_filter.filterTransitionsInPlace(
+            prev_entry.second.trans_out.write(), pa, false);
       }
     } else {
-      std::cout << "DirectEncoder encodeUntil: cannot find prev_pa TLs. "
-                << prev_pa << std::endl;
+      TAPTENC_LOG_WARN("DirectEncoder encodeUntil: cannot find prev_pa TLs. "
+                       << prev_pa);
     }
   }
 }
@@ -564,8 +569,8 @@ void DirectEncoder::encodePast(AutomataSystem &s, const std::string pa,
   auto start_pa_entry = std::find(po_tls.pa_order.get()->begin(),
                                   po_tls.pa_order.get()->end(), pa);
   if (start_pa_entry == po_tls.pa_order.get()->end()) {
-    std::cout << "DirectEncoder encodePast: could not find start pa " << pa
-              << std::endl;
+    TAPTENC_LOG_WARN("DirectEncoder encodePast: could not find start pa "
+                     << pa);
     return;
   }
   // TLs of the current window
@@ -628,8 +633,8 @@ void DirectEncoder::encodePast(AutomataSystem &s, const std::string pa,
       po_tls.tls.get()->find(last_pa)->second,
       curr_window.tls.get()->find(last_pa)->second, to_orig, TrueCC());
   for (auto &tl_entry : po_tls.tls.get()->find(last_pa)->second) {
-    PlanOrderedTLs::removeTransitionsToNextTl(tl_entry.second.trans_out,
-                                              last_pa);
+    PlanOrderedTLs::removeTransitionsToNextTl(
+        tl_entry.second.trans_out.write(), last_pa);
   }
   if (lower_bounded) {
     TimeLine *last_tl;
@@ -640,7 +645,7 @@ void DirectEncoder::encodePast(AutomataSystem &s, const std::string pa,
     }
     for (auto &last_entry : *last_tl) {
       PlanOrderedTLs::modifyTransitionsToNextTl(
-          last_entry.second.trans_out, constraint_end_pa,
+          last_entry.second.trans_out.write(), constraint_end_pa,
           target_filter.getFilter(), guard_constraint_sat, {}, "");
     }
   }
@@ -652,8 +657,8 @@ void DirectEncoder::encodeSince(AutomataSystem &s, const std::string pa,
   auto start_pa_entry = std::find(po_tls.pa_order.get()->begin(),
                                   po_tls.pa_order.get()->end(), pa);
   if (start_pa_entry == po_tls.pa_order.get()->end()) {
-    std::cout << "DirectEncoder encodeSince: could not find start pa " << pa
-              << std::endl;
+    TAPTENC_LOG_WARN("DirectEncoder encodeSince: could not find start pa "
+                     << pa);
     return;
   }
   OrigMap to_orig = po_tls.createOrigMapping("");
@@ -676,16 +681,18 @@ void DirectEncoder::encodeSince(AutomataSystem &s, const std::string pa,
         // should stay in the pre_target states
         if (i <= context_end) {
           if (to_orig.find(tl_entry.first) == to_orig.end()) {
-            pre_target_filter.filterAutomatonInPlace(tl_entry.second.ta, "");
+            pre_target_filter.filterAutomatonInPlace(
+                tl_entry.second.ta.write(), "");
             pre_target_filter.filterTransitionsInPlace(
-                tl_entry.second.trans_out, "", true);
+                tl_entry.second.trans_out.write(), "", true);
           } else {
             // we have to delete transitions leading to states that we deleted
             // above
-            tl_entry.second.trans_out.erase(
+            std::vector<Transition> &trans_out =
+                tl_entry.second.trans_out.write();
+            trans_out.erase(
                 std::remove_if(
-                    tl_entry.second.trans_out.begin(),
-                    tl_entry.second.trans_out.end(),
+                    trans_out.begin(), trans_out.end(),
                     [to_orig, pre_target_filter, this](const Transition &t) {
                       std::string prefix =
                           Filter::getPrefix(t.dest_id, constants::BASE_SEP);
@@ -693,15 +700,16 @@ void DirectEncoder::encodeSince(AutomataSystem &s, const std::string pa,
                       return (to_orig.find(prefix) == to_orig.end()) &&
                              !pre_target_filter.matchesId(t.dest_id);
                     }),
-                tl_entry.second.trans_out.end());
+                trans_out.end());
           }
           // after the context window but before the pa begin  we also have to
           // remain in the pre_target states
         } else if (to_orig.find(tl_entry.first) != to_orig.end() &&
                    i > context_end) {
-          pre_target_filter.filterAutomatonInPlace(tl_entry.second.ta, "");
-          pre_target_filter.filterTransitionsInPlace(tl_entry.second.trans_out,
-                                                     "", true);
+          pre_target_filter.filterAutomatonInPlace(
+              tl_entry.second.ta.write(), "");
+          pre_target_filter.filterTransitionsInPlace(
+              tl_entry.second.trans_out.write(), "", true);
         }
       }
     }
@@ -711,100 +719,191 @@ void DirectEncoder::encodeSince(AutomataSystem &s, const std::string pa,
     auto prev_tl = po_tls.tls->find(prev_pa);
     if (prev_tl != po_tls.tls->end()) {
       for (auto &prev_entry : prev_tl->second) {
-        pre_target_filter.filterTransitionsInPlace(prev_entry.second.trans_out,
-                                                   pa, false);
+        pre_target_filter.filterTransitionsInPlace(
+            prev_entry.second.trans_out.write(), pa, false);
       }
     } else {
-      std::cout << "DirectEncoder encodeSince: cannot find prev_pa TLs. "
-                << prev_pa << std::endl;
+      TAPTENC_LOG_WARN("DirectEncoder encodeSince: cannot find prev_pa TLs. "
+                       << prev_pa);
     }
   }
 }
 
 size_t DirectEncoder::getPlanTAIndex() { return plan_ta_index; }
 
-AutomataSystem DirectEncoder::createFinalSystem(const AutomataSystem &s,
-                                                SystemVisInfo &s_vis) {
-  // Check if all outgoing transitions actually connect existing states
-  // Currently in rare cases a transition is not cleaned up properly during
-  // encoding, if the endpoints are manipulated.
+void DirectEncoder::removeDanglingTransitions() {
+  // map each state to the TLEntry containing it
+  std::unordered_map<Symbol, const TlEntry *> state_owner;
+  for (const auto &curr_tl : *po_tls.tls) {
+    for (const auto &tl : curr_tl.second) {
+      for (const auto &s : tl.second.ta->states) {
+        state_owner.emplace(s.id, &tl.second);
+      }
+    }
+  }
+  auto is_dead = [](const Transition &t) {
+    return !t.guard->isSatisfiable();
+  };
   for (auto curr_pa = po_tls.pa_order.get()->begin();
        curr_pa != po_tls.pa_order.get()->end(); ++curr_pa) {
     for (auto &tl : (*po_tls.tls.get())[*curr_pa]) {
       std::vector<Transition> pruned_trans_out;
-      for (auto &trans : tl.second.trans_out) {
-        auto find_source = std::find_if(
-            tl.second.ta.states.begin(), tl.second.ta.states.end(),
-            [trans](const State &s) { return s.id == trans.source_id; });
-        if (find_source == tl.second.ta.states.end()) {
-          continue;
-        }
-        bool dest_found = false;
-        for (const auto &search_tl : (*po_tls.tls.get())[Filter::getPrefix(
-                 trans.dest_id, constants::TL_SEP)]) {
-          auto find_dest = std::find_if(
-              search_tl.second.ta.states.begin(),
-              search_tl.second.ta.states.end(),
-              [trans](const State &s) { return s.id == trans.dest_id; });
-          if (find_dest != search_tl.second.ta.states.end()) {
-            dest_found = true;
-            break;
-          }
-        }
-        if (!dest_found) {
-          continue;
-        } else {
+      for (const auto &trans : *tl.second.trans_out) {
+        auto source_owner = state_owner.find(trans.source_id);
+        if (!is_dead(trans) && source_owner != state_owner.end() &&
+            source_owner->second == &tl.second &&
+            state_owner.find(trans.dest_id) != state_owner.end()) {
           pruned_trans_out.push_back(trans);
         }
       }
-      tl.second.trans_out = pruned_trans_out;
+      if (pruned_trans_out.size() != tl.second.trans_out->size()) {
+        tl.second.trans_out = pruned_trans_out;
+      }
+      if (std::any_of(tl.second.ta->transitions.begin(),
+                      tl.second.ta->transitions.end(), is_dead)) {
+        std::vector<Transition> &ta_trans = tl.second.ta.write().transitions;
+        ta_trans.erase(
+            std::remove_if(ta_trans.begin(), ta_trans.end(), is_dead),
+            ta_trans.end());
+      }
     }
   }
-  s_vis = SystemVisInfo(*(po_tls.tls.get()), *(po_tls.pa_order.get()));
+}
+
+AutomataSystem DirectEncoder::pruneAndMerge(const AutomataSystem &s) const {
   AutomataSystem res = s;
   res.instances.clear();
-  std::vector<State> last_pruned_states;
-  std::unordered_set<std::string> already_pruned;
-  // prune deadend TLEntries by deleting all transitions to them
-  do {
-    Filter curr_filter(last_pruned_states, true);
-    last_pruned_states.clear();
-    for (auto &curr_tl : *(po_tls.tls.get())) {
-      for (auto &curr_copy : curr_tl.second) {
-        curr_filter.filterTransitionsInPlace(curr_copy.second.trans_out, "",
-                                             false);
-        if (curr_copy.first == constants::QUERY ||
-            curr_copy.second.trans_out.size() > 0) {
-        } else if (already_pruned.find(curr_copy.first) ==
-                   already_pruned.end()) {
-          last_pruned_states.insert(last_pruned_states.end(),
-                                    curr_copy.second.ta.states.begin(),
-                                    curr_copy.second.ta.states.end());
-          already_pruned.insert(curr_copy.first);
-          // std::cout << "DirectEncoder createFinalSystem: pruned "
-          //           << curr_copy.first << std::endl;
+  // graph view on the encoding: states are numbered densely, edges are
+  // stored as adjacency lists in both directions
+  std::unordered_map<Symbol, std::size_t> state_index;
+  std::vector<std::vector<std::size_t>> succ;
+  std::vector<std::vector<std::size_t>> pred;
+  std::vector<std::size_t> fwd_queue;
+  std::vector<std::size_t> bwd_queue;
+  for (const auto &curr_tl : *po_tls.tls) {
+    for (const auto &curr_copy : curr_tl.second) {
+      for (const auto &state : curr_copy.second.ta->states) {
+        if (state_index.emplace(state.id, succ.size()).second) {
+          if (state.initial) {
+            fwd_queue.push_back(succ.size());
+          }
+          if (state.id == constants::QUERY) {
+            bwd_queue.push_back(succ.size());
+          }
+          succ.emplace_back();
+          pred.emplace_back();
         }
       }
     }
-  } while (last_pruned_states.size() > 0);
+  }
+  auto add_edges = [&](const std::vector<Transition> &transitions) {
+    for (const auto &trans : transitions) {
+      auto source = state_index.find(trans.source_id);
+      auto dest = state_index.find(trans.dest_id);
+      if (source != state_index.end() && dest != state_index.end()) {
+        succ[source->second].push_back(dest->second);
+        pred[dest->second].push_back(source->second);
+      }
+    }
+  };
+  for (const auto &curr_tl : *po_tls.tls) {
+    for (const auto &curr_copy : curr_tl.second) {
+      add_edges(curr_copy.second.ta->transitions);
+      add_edges(*curr_copy.second.trans_out);
+    }
+  }
+  // a state is kept iff it is reachable from an initial state and the query
+  // is reachable from it
+  auto mark_reachable = [](std::vector<std::size_t> &queue,
+                           const std::vector<std::vector<std::size_t>> &edges,
+                           std::vector<bool> &reached) {
+    for (std::size_t state : queue) {
+      reached[state] = true;
+    }
+    while (!queue.empty()) {
+      std::size_t curr = queue.back();
+      queue.pop_back();
+      for (std::size_t next : edges[curr]) {
+        if (!reached[next]) {
+          reached[next] = true;
+          queue.push_back(next);
+        }
+      }
+    }
+  };
+  std::vector<std::size_t> initial_states = fwd_queue;
+  std::vector<bool> fwd_reached(succ.size(), false);
+  std::vector<bool> bwd_reached(succ.size(), false);
+  mark_reachable(fwd_queue, succ, fwd_reached);
+  mark_reachable(bwd_queue, pred, bwd_reached);
+  std::vector<bool> keep(succ.size(), false);
+  bool query_reachable = false;
+  for (const auto &state : state_index) {
+    keep[state.second] = fwd_reached[state.second] && bwd_reached[state.second];
+    query_reachable |= keep[state.second];
+  }
+  if (!query_reachable) {
+    TAPTENC_LOG_WARN("DirectEncoder pruneAndMerge: query is unreachable");
+    // keep the initial states and the query to still obtain a valid system
+    for (std::size_t state : initial_states) {
+      keep[state] = true;
+    }
+    auto query = state_index.find(constants::QUERY);
+    if (query != state_index.end()) {
+      keep[query->second] = true;
+    }
+  }
+  auto is_kept = [&](const Symbol &id) {
+    auto search = state_index.find(id);
+    return search != state_index.end() && keep[search->second];
+  };
+  auto is_pruned_trans = [&](const Transition &trans) {
+    return !is_kept(trans.source_id) || !is_kept(trans.dest_id);
+  };
   // merge together the rest
   std::vector<Automaton> automata;
   std::vector<Transition> interconnections;
   for (const auto &curr_tl : *(po_tls.tls.get())) {
     for (const auto &curr_copy : curr_tl.second) {
-      if (curr_copy.first == constants::QUERY ||
-          curr_copy.second.trans_out.size() > 0) {
-        automata.push_back(curr_copy.second.ta);
-        interconnections.insert(interconnections.end(),
-                                curr_copy.second.trans_out.begin(),
-                                curr_copy.second.trans_out.end());
+      const Automaton &copy_ta = *curr_copy.second.ta;
+      if (std::none_of(copy_ta.states.begin(), copy_ta.states.end(),
+                       [&](const State &state) { return is_kept(state.id); })) {
+        continue;
       }
+      automata.push_back(copy_ta);
+      Automaton &pruned_ta = automata.back();
+      pruned_ta.states.erase(
+          std::remove_if(
+              pruned_ta.states.begin(), pruned_ta.states.end(),
+              [&](const State &state) { return !is_kept(state.id); }),
+          pruned_ta.states.end());
+      pruned_ta.transitions.erase(std::remove_if(pruned_ta.transitions.begin(),
+                                                 pruned_ta.transitions.end(),
+                                                 is_pruned_trans),
+                                  pruned_ta.transitions.end());
+      pruned_ta.invalidateTransitionIndex();
+      std::remove_copy_if(curr_copy.second.trans_out->begin(),
+                          curr_copy.second.trans_out->end(),
+                          std::back_inserter(interconnections),
+                          is_pruned_trans);
     }
   }
   res.instances.push_back(
       std::make_pair(mergeAutomata(automata, interconnections, "direct"), ""));
   return res;
 }
+
+AutomataSystem DirectEncoder::createFinalSystem(const AutomataSystem &s,
+                                                SystemVisInfo &s_vis) {
+  removeDanglingTransitions();
+  s_vis = SystemVisInfo(*(po_tls.tls.get()), *(po_tls.pa_order.get()));
+  return pruneAndMerge(s);
+}
+
+AutomataSystem DirectEncoder::createFinalSystem(const AutomataSystem &s) {
+  removeDanglingTransitions();
+  return pruneAndMerge(s);
+}
 /**
  * \internal
  * Appends a plan automata to the automata system and stores a copy of the
@@ -813,22 +912,84 @@ AutomataSystem DirectEncoder::createFinalSystem(const AutomataSystem &s,
  * Then the base timeline is created to initialize the PlanOrderedTLs member.
  * \endinternal
  */
+namespace {
+/**
+ * Prepends the start action to a plan, such that plan actions have the same
+ * indices as the states of the plan TA.
+ */
+std::vector<PlanAction> withStartAction(const std::vector<PlanAction> &plan) {
+  std::vector<PlanAction> res = plan;
+  res.insert(res.begin(),
+             PlanAction(ActionName(constants::START_PA, {}),
+                        Bounds(0, plan.front().absolute_time.lower_bound,
+                               ComparisonOp::LTE,
+                               plan.front().absolute_time.l_op),
+                        Bounds(0, std::numeric_limits<int>::max())));
+  return res;
+}
+} // end anonymous namespace
+
 DirectEncoder::DirectEncoder(AutomataSystem &s,
                              const ::std::vector<PlanAction> &plan,
                              const int base_pos) {
   Automaton plan_ta = generatePlanAutomaton(plan, constants::PLAN_TA_NAME);
-  this->plan = plan;
-  this->plan.insert(
-      this->plan.begin(),
-      PlanAction(ActionName(constants::START_PA, {}),
-                 Bounds(0, plan.front().absolute_time.lower_bound,
-                        ComparisonOp::LTE, plan.front().absolute_time.l_op),
-                 Bounds(0, std::numeric_limits<int>::max())));
+  this->plan = withStartAction(plan);
   s.instances.push_back(std::make_pair(plan_ta, ""));
   plan_ta_index = s.instances.size() - 1;
   generateBaseTimeLine(s, base_pos, plan_ta_index);
 }
 
+void DirectEncoder::replacePlanSuffix(AutomataSystem &s,
+                                      const ::std::vector<PlanAction> &new_plan,
+                                      size_t keep, const int base_pos) {
+  assert(keep > 0 && keep <= po_tls.pa_order->size());
+  for (auto pa = po_tls.pa_order->begin() + keep;
+       pa != po_tls.pa_order->end(); ++pa) {
+    po_tls.tls->erase(*pa);
+  }
+  po_tls.tls->erase(constants::QUERY);
+  po_tls.pa_order->resize(keep);
+  plan = withStartAction(new_plan);
+  s.instances[plan_ta_index].first =
+      generatePlanAutomaton(new_plan, constants::PLAN_TA_NAME);
+  generateBaseTimeLine(s, base_pos, plan_ta_index, keep);
+}
+
+size_t DirectEncoder::lastAffectedTimeLine(const EncICInfo &info,
+                                           const ::std::string &pa,
+                                           const ::std::string &end_pa) const {
+  const auto &pa_order = *po_tls.pa_order;
+  size_t last = pa_order.size() - 1;
+  size_t pa_index = std::find(pa_order.begin(), pa_order.end(), pa) -
+                    pa_order.begin();
+  if (pa_index > last) {
+    return last;
+  }
+  switch (info.type) {
+  case ICType::Future:
+  case ICType::Until: {
+    // the window starts upon pa and ends when the upper bound is exceeded
+    const UnaryInfo *unary = dynamic_cast<const UnaryInfo *>(&info);
+    const BinaryInfo *binary = dynamic_cast<const BinaryInfo *>(&info);
+    const TargetSpecs &specs = unary ? unary->specs : binary->specs;
+    std::pair<int, int> context = calculateContext(specs, pa, "");
+    return std::max(pa_index, static_cast<size_t>(context.first +
+                                                  context.second));
+  }
+  case ICType::UntilChain: {
+    // the chain is bounded by its end pa
+    size_t end_index =
+        std::find(pa_order.begin() + pa_index, pa_order.end(), end_pa) -
+        pa_order.begin();
+    return std::min(end_index, last);
+  }
+  default:
+    // past windows, invariants and no-ops only affect pa and its
+    // predecessors
+    return pa_index;
+  }
+}
+
 DirectEncoder DirectEncoder::mergeEncodings(const DirectEncoder &enc2) const {
   return DirectEncoder(po_tls.mergePlanOrderedTLs(enc2.po_tls), plan,
                        plan_ta_index);
@@ -846,6 +1007,10 @@ DirectEncoder::DirectEncoder(const PlanOrderedTLs &tls,
   }
 }
 
-DirectEncoder DirectEncoder::copy() {
-  return DirectEncoder(po_tls, plan, plan_ta_index);
+DirectEncoder DirectEncoder::copy() const {
+  DirectEncoder res(po_tls, plan, plan_ta_index);
+  res.encode_counter = encode_counter;
+  return res;
 }
+
+TlSizes DirectEncoder::getTlSizes() const { return po_tls.getTlSizes(); }
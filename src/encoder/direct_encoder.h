@@ -92,9 +92,12 @@ private:
    * @param base_pos position of the platform model in
    *        AutomataSystem::instances of \a s
    * \param plan_pos position of the plan in AutomataSystem::instances of \a s
+   * @param first_pa index of the first plan action (within the plan TA) to
+   *        generate a timeline for, the timelines of all previous plan
+   *        actions (and their transitions) have to be present already
    */
   void generateBaseTimeLine(AutomataSystem &s, const int base_pos,
-                            const int plan_pos);
+                            const int plan_pos, const size_t first_pa = 0);
 
   /**
    * Calculate the window of plan actions during which a temporal constraint is
@@ -118,7 +121,8 @@ private:
                                          ::std::string starting_pa,
                                          ::std::string ending_pa = "",
                                          bool look_ahead = true,
-                                         int lb_offset = 0, int ub_offset = 0);
+                                         int lb_offset = 0,
+                                         int ub_offset = 0) const;
 
   /**
    * Constructs a direct encoder by copying the the arguments to member
@@ -130,9 +134,38 @@ private:
                 const ::std::vector<PlanAction> &plan,
                 const size_t plan_ta_index);
 
+  /**
+   * Removes all outgoing transitions of TLEntries that do not connect
+   * existing states, as well as all transitions with unsatisfiable guards.
+   *
+   * Currently in rare cases a transition is not cleaned up properly during
+   * encoding, if the endpoints are manipulated.
+   */
+  void removeDanglingTransitions();
+
+  /**
+   * Prunes all states and transitions that do not lie on a path from an
+   * initial state to the query state and merges the remaining automata
+   * copies into a single automaton.
+   *
+   * Runs a single forward and backward reachability pass on an adjacency
+   * list view of the encoding, hence it is linear in the encoding size.
+   *
+   * @param s automata system containing the platform model and plan automaton
+   * @return automata system containing the automata that contains all encoding
+   *         information
+   */
+  AutomataSystem pruneAndMerge(const AutomataSystem &s) const;
+
 public:
   size_t getPlanTAIndex();
-  DirectEncoder copy();
+  /**
+   * Creates a deep copy of the encoding.
+   *
+   * @return encoder with copies of all timelines, that can be extended
+   *         independently of this encoder
+   */
+  DirectEncoder copy() const;
 
   /**
    * Encode an until chain.
@@ -343,6 +376,18 @@ public:
    */
   AutomataSystem createFinalSystem(const AutomataSystem &s,
                                    SystemVisInfo &s_vis);
+  /**
+   * Converts the PlanOrderedTLs representation of the encoding to an automata
+   * systen containing only one automaton without computing visual
+   * information.
+   *
+   * Use this if the resulting system is only passed to a solver.
+   *
+   * @param s automata system containing the platform model and plan automaton
+   * @return automata system containing the automata that contains all encoding
+   *         information
+   */
+  AutomataSystem createFinalSystem(const AutomataSystem &s);
   /**
    * Create a DirectEncoder Instance containing a merged encoding of this and
    * the argument encoding.
@@ -355,5 +400,51 @@ public:
    * @return encoder containing the merge between \a this and \a enc2
    */
   DirectEncoder mergeEncodings(const DirectEncoder &enc2) const;
+
+  /**
+   * Replaces the timelines of a plan suffix by base timelines of a new plan.
+   *
+   * Timelines of the first \a keep plan actions (including the start
+   * action) are kept together with everything encoded into them, the
+   * remaining ones are generated from scratch. The plan TA in \a s is
+   * replaced by the one of \a new_plan.
+   *
+   * Only valid if both plans agree on the first \a keep plan actions and
+   * their successor (which determines the invariant of the last kept
+   * timeline) and if all constraints encoded so far only affect the kept
+   * timelines (see lastAffectedTimeLine()).
+   *
+   * @param s automata system the encoding was created from
+   * @param new_plan plan to encode
+   * @param keep number of timelines to keep (at least 1)
+   * @param base_pos position of the platform model TA in \a s
+   */
+  void replacePlanSuffix(AutomataSystem &s,
+                         const ::std::vector<PlanAction> &new_plan,
+                         size_t keep, const int base_pos = 0);
+
+  /**
+   * Determines the last timeline an encoding step may modify.
+   *
+   * The estimate is conservative, all timelines after the returned one stay
+   * untouched when encoding \a info upon \a pa.
+   *
+   * @param info constraint to encode
+   * @param pa plan action the constraint is activated at
+   * @param end_pa plan action ending an until chain (only for #UntilChain)
+   * @return index of the last affected timeline in the plan order
+   */
+  size_t lastAffectedTimeLine(const EncICInfo &info, const ::std::string &pa,
+                              const ::std::string &end_pa = "") const;
+
+  /**
+   * Returns the sizes of the timelines forming the encoding.
+   *
+   * Useful to estimate the cost of merging encodings beforehand, see
+   * PlanOrderedTLs::predictMergeSizes().
+   *
+   * @return number of states and transitions per timeline
+   */
+  TlSizes getTlSizes() const;
 };
 } // end namespace taptenc
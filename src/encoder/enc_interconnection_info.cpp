@@ -4,8 +4,31 @@
  * \author (2019) Tarik Viehmann
  */
 #include "enc_interconnection_info.h"
+#include <string>
 
 using namespace taptenc;
+
+std::string taptenc::toString(ICType type) {
+  switch (type) {
+  case ICType::Future:
+    return "Future";
+  case ICType::NoOp:
+    return "NoOp";
+  case ICType::Past:
+    return "Past";
+  case ICType::Invariant:
+    return "Invariant";
+  case ICType::Until:
+    return "Until";
+  case ICType::UntilChain:
+    return "UntilChain";
+  case ICType::Since:
+    return "Since";
+  default:
+    return "Unknown";
+  }
+}
+
 bool EncICInfo::isFutureInfo() const {
   return type == ICType::Future || type == ICType::Until;
 }
@@ -42,6 +42,14 @@ enum ICType {
   Since
 };
 
+/**
+ * Returns the name of a constraint type.
+ *
+ * @param type constraint type
+ * @return name of \a type (e.g. "Future")
+ */
+::std::string toString(ICType type);
+
 /**
  * Target states together with associated time bounds.
  */
@@ -9,11 +9,13 @@
 #include "../timed-automata/timed_automata.h"
 #include "../utils.h"
 #include "filter.h"
+#include "logging.h"
 #include <algorithm>
 #include <iostream>
 #include <memory>
 #include <set>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 using namespace taptenc;
@@ -52,10 +54,10 @@ encoderutils::generatePlanAutomaton(const ::std::vector<PlanAction> &plan,
       std::make_shared<Clock>(constants::GLOBAL_CLOCK);
   for (auto it = full_plan.begin(); it != full_plan.end(); ++it) {
     if (it != full_plan.begin()) {
-      plan_states.back().inv = std::make_unique<ConjunctionCC>(
-          ConjunctionCC(*plan_states.back().inv.get(),
-                        ComparisonCC(abs_clock, it->absolute_time.r_op,
-                                     it->absolute_time.upper_bound)));
+      plan_states.back().inv = addConstraint(
+          *plan_states.back().inv.get(),
+          ComparisonCC(abs_clock, it->absolute_time.r_op,
+                       it->absolute_time.upper_bound));
     }
     if (it->name.id == constants::START_PA) {
       plan_states.push_back(State(it->name.id, TrueCC(), false, true));
@@ -70,10 +72,10 @@ encoderutils::generatePlanAutomaton(const ::std::vector<PlanAction> &plan,
   auto find_initial = std::find_if(plan_states.begin(), plan_states.end(),
                                    [](const State &s) { return s.initial; });
   if (find_initial == plan_states.end()) {
-    std::cout << "generatePlanAutomaton: no initial state found" << std::endl;
+    TAPTENC_LOG_WARN("generatePlanAutomaton: no initial state found");
   } else {
-    std::cout << "generatePlanAutomaton: initial state: " << find_initial->id
-              << std::endl;
+    TAPTENC_LOG_DEBUG("generatePlanAutomaton: initial state: "
+                      << find_initial->id);
   }
   std::vector<Transition> plan_transitions;
   int i = 0;
@@ -104,23 +106,38 @@ Automaton
 encoderutils::mergeAutomata(const ::std::vector<Automaton> &automata,
                             ::std::vector<Transition> &interconnections,
                             ::std::string prefix) {
-  std::set<State> res_states;
-  std::set<Transition> res_transitions(interconnections.begin(),
-                                       interconnections.end());
+  // deduplicate structurally, keeping the order of first occurrence
+  std::vector<State> res_states;
+  std::vector<Transition> res_transitions;
+  std::unordered_set<const State *, PointeeHash<State>, PointeeEqual<State>>
+      seen_states;
+  std::unordered_set<const Transition *, PointeeHash<Transition>,
+                     PointeeEqual<Transition>>
+      seen_transitions;
+  auto add_transitions = [&](const std::vector<Transition> &to_add) {
+    for (const auto &t : to_add) {
+      if (seen_transitions.insert(&t).second) {
+        res_transitions.push_back(t);
+      }
+    }
+  };
   std::set<std::shared_ptr<Clock>> res_clocks;
   std::set<std::string> res_bool_vars;
+  add_transitions(interconnections);
   for (const auto &ta : automata) {
-    res_states.insert(ta.states.begin(), ta.states.end());
-    res_transitions.insert(ta.transitions.begin(), ta.transitions.end());
+    for (const auto &s : ta.states) {
+      if (seen_states.insert(&s).second) {
+        res_states.push_back(s);
+      }
+    }
+    add_transitions(ta.transitions);
     for (const auto &cl : ta.clocks) {
       addClock(res_clocks, cl.get()->id);
     }
     res_bool_vars.insert(ta.bool_vars.begin(), ta.bool_vars.end());
   }
-  Automaton res(
-      std::vector<State>(res_states.begin(), res_states.end()),
-      std::vector<Transition>(res_transitions.begin(), res_transitions.end()),
-      prefix, false);
+  Automaton res(std::move(res_states), std::move(res_transitions), prefix,
+                false);
   res.clocks =
       std::set<std::shared_ptr<Clock>>(res_clocks.begin(), res_clocks.end());
   res.bool_vars =
@@ -192,8 +209,7 @@ void encoderutils::addTrapTransitions(Automaton &ta,
   auto trap = std::find_if(ta.states.begin(), ta.states.end(),
                            [](const State &s) { return s.id == "trap"; });
   if (trap == ta.states.end()) {
-    std::cout << "Encoder addTrapTransitions: trap not found. Abort."
-              << std::endl;
+    TAPTENC_LOG_ERROR("Encoder addTrapTransitions: trap not found. Abort.");
     return;
   }
   for (const auto &source : sources) {
@@ -204,9 +220,8 @@ void encoderutils::addTrapTransitions(Automaton &ta,
       ta.transitions.push_back(
           Transition(search->id, trap->id, "", guard, update, sync, passive));
     } else {
-      std::cout << "Encoder addTrapTransitions: id of source not "
-                   "found in TA (id "
-                << source.id << ")" << std::endl;
+      TAPTENC_LOG_WARN("Encoder addTrapTransitions: id of source not found "
+                       "in TA (id " << source.id << ")");
     }
   }
 }
@@ -218,9 +233,9 @@ void encoderutils::addBaseSyncs(AutomataSystem &s, const int base_pos) {
       trans.passive = false;
       s.globals.channels.push_back(Channel(ChanType::Broadcast, trans.sync));
     } else {
-      std::cout << "Encoder addBaseSyncs: transition " << trans.source_id
-                << " -> " << trans.dest_id << " already has sync " << trans.sync
-                << std::endl;
+      TAPTENC_LOG_WARN("Encoder addBaseSyncs: transition " << trans.source_id
+                       << " -> " << trans.dest_id << " already has sync "
+                       << trans.sync);
     }
   }
 }
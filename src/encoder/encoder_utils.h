@@ -34,6 +34,8 @@ namespace encoderutils {
 /**
  * Merges multiple automata together, states with identical names are melted
  * together.
+ * Duplicate states and transitions are detected by structural hashing, the
+ * order of first occurrence is kept.
  *
  * @param automata automata to merge together
  * @param interconnections transitions between the automata
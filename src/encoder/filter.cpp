@@ -8,6 +8,7 @@
 #include "../constants.h"
 #include "../timed-automata/timed_automata.h"
 #include "../utils.h"
+#include "logging.h"
 #include <algorithm>
 #include <iostream>
 #include <string>
@@ -18,10 +19,82 @@ using namespace taptenc;
 Filter::Filter(std::vector<State> arg_filter, bool arg_invert_effect) {
   invert_effect = arg_invert_effect;
   filter = arg_filter;
+  for (const auto &f_state : filter) {
+    filter_index.add(f_state.id);
+  }
+}
+
+void Filter::SuffixIndex::add(const std::string &suffix) {
+  std::string base_suffix = Filter::getBaseName(suffix);
+  if (base_suffix == "") {
+    wildcards.push_back(suffixes.size());
+  } else {
+    by_base[base_suffix].push_back(suffixes.size());
+  }
+  suffixes.push_back(suffix);
+}
+
+std::size_t Filter::SuffixIndex::findFirst(const std::string &name,
+                                           const std::string &prefix) const {
+  std::size_t res = suffixes.size();
+  if (!Filter::hasPrefix(name, prefix)) {
+    return res;
+  }
+  // candidate positions are sorted, hence the first hit of each list is the
+  // smallest matching position of that list
+  for (std::size_t pos : wildcards) {
+    if (Filter::hasSuffix(name, suffixes[pos])) {
+      res = pos;
+      break;
+    }
+  }
+  auto base_entry = by_base.find(Filter::getBaseName(name));
+  if (base_entry != by_base.end()) {
+    for (std::size_t pos : base_entry->second) {
+      if (pos > res) {
+        break;
+      }
+      if (Filter::hasSuffix(name, suffixes[pos])) {
+        res = pos;
+        break;
+      }
+    }
+  }
+  return res;
+}
+
+Filter::NameIndex::NameIndex(const std::vector<State> &arg_states)
+    : states(arg_states) {
+  for (std::size_t pos = 0; pos < states.size(); pos++) {
+    by_base[Filter::getBaseName(states[pos].id)].push_back(pos);
+  }
 }
 
-bool Filter::isFilterEndIt(const std::vector<State>::const_iterator &it) const {
-  bool res = it == filter.end();
+std::vector<State>::const_iterator
+Filter::NameIndex::findFirst(const std::string &prefix,
+                             const std::string &suffix) const {
+  std::string base_suffix = Filter::getBaseName(suffix);
+  if (base_suffix == "") {
+    return std::find_if(states.begin(), states.end(),
+                        [&prefix, &suffix](const State &s) {
+                          return Filter::matchesFilter(s.id, prefix, suffix);
+                        });
+  }
+  auto base_entry = by_base.find(base_suffix);
+  if (base_entry != by_base.end()) {
+    for (std::size_t pos : base_entry->second) {
+      const std::string &name = states[pos].id;
+      if (Filter::hasPrefix(name, prefix) && Filter::hasSuffix(name, suffix)) {
+        return states.begin() + pos;
+      }
+    }
+  }
+  return states.end();
+}
+
+bool Filter::isFiltered(const std::string &name,
+                        const std::string &prefix) const {
+  bool res = filter_index.findFirst(name, prefix) == filter_index.size();
   if (invert_effect) {
     res = !res;
   }
@@ -31,46 +104,36 @@ bool Filter::isFilterEndIt(const std::vector<State>::const_iterator &it) const {
 std::vector<State> Filter::getFilter() const { return filter; }
 
 std::string Filter::stripPrefix(std::string name, std::string prefix) {
-  if (name.size() >= prefix.size()) {
-    if (name.substr(0, prefix.size()) == prefix) {
-      return name.substr(prefix.size(), name.size());
-    }
+  if (hasPrefix(name, prefix)) {
+    return name.substr(prefix.size());
   }
-  std::cout << "Filter stripPrefix: " << prefix << " is no prefix of " << name
-            << std::endl;
+  TAPTENC_LOG_DEBUG("Filter stripPrefix: " << prefix << " is no prefix of "
+                    << name);
   return name;
 }
 
-bool Filter::hasSuffix(std::string name, std::string suffix) {
-  if (name.size() >= suffix.size()) {
-    return name.substr(name.size() - suffix.size(), suffix.size()) == suffix;
-  } else {
-    return false;
-  }
+bool Filter::hasSuffix(const std::string &name, const std::string &suffix) {
+  return name.size() >= suffix.size() &&
+         name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0;
 }
 
-bool Filter::hasPrefix(std::string name, std::string prefix) {
-  if (name.size() >= prefix.size()) {
-    return name.substr(0, prefix.size()) == prefix;
-  } else {
-    return false;
-  }
+bool Filter::hasPrefix(const std::string &name, const std::string &prefix) {
+  return name.size() >= prefix.size() &&
+         name.compare(0, prefix.size(), prefix) == 0;
 }
 
-bool Filter::matchesFilter(std::string name, std::string prefix,
-                           std::string suffix) {
+std::string Filter::getBaseName(const std::string &name) {
+  size_t pos = name.find_last_of(constants::BASE_SEP);
+  return (pos == std::string::npos) ? name : name.substr(pos + 1);
+}
+
+bool Filter::matchesFilter(const std::string &name, const std::string &prefix,
+                           const std::string &suffix) {
   if (not(hasPrefix(name, prefix) && hasSuffix(name, suffix))) {
     return false;
   } else {
-    std::string base_name =
-        (name.find(constants::BASE_SEP) == std::string::npos)
-            ? name
-            : getSuffix(name, constants::BASE_SEP);
-    std::string base_suffix =
-        (suffix.find(constants::BASE_SEP) == std::string::npos)
-            ? suffix
-            : getSuffix(suffix, constants::BASE_SEP);
-    return base_suffix == "" || base_name == base_suffix;
+    std::string base_suffix = getBaseName(suffix);
+    return base_suffix == "" || getBaseName(name) == base_suffix;
   }
 }
 
@@ -99,37 +162,26 @@ std::string Filter::getPrefix(std::string name, char marker) {
 void Filter::filterTransitionsInPlace(std::vector<Transition> &trans,
                                       std::string prefix,
                                       bool filter_source) const {
-  trans.erase(std::remove_if(
-                  trans.begin(), trans.end(),
-                  [filter_source, prefix, this](Transition &t) {
-                    std::string id =
-                        ((filter_source) ? t.source_id : t.dest_id);
-                    bool res =
-                        hasPrefix(id, prefix) &&
-                        isFilterEndIt(std::find_if(
-                            filter.begin(), filter.end(),
-                            [id, filter_source, prefix, this](const State &s) {
-                              return Filter::matchesFilter(id, prefix, s.id);
-                            }));
-                    return res;
-                  }),
+  trans.erase(std::remove_if(trans.begin(), trans.end(),
+                             [filter_source, &prefix, this](Transition &t) {
+                               const std::string &id =
+                                   ((filter_source) ? t.source_id : t.dest_id);
+                               return hasPrefix(id, prefix) &&
+                                      isFiltered(id, prefix);
+                             }),
               trans.end());
 }
 
 void Filter::filterAutomatonInPlace(Automaton &source,
                                     std::string prefix) const {
   source.states.erase(std::remove_if(source.states.begin(), source.states.end(),
-                                     [prefix, this](State &s) {
-                                       return isFilterEndIt(std::find_if(
-                                           filter.begin(), filter.end(),
-                                           [prefix, s, this](const State &f_s) {
-                                             return Filter::matchesFilter(
-                                                 s.id, prefix, f_s.id);
-                                           }));
+                                     [&prefix, this](State &s) {
+                                       return isFiltered(s.id, prefix);
                                      }),
                       source.states.end());
   filterTransitionsInPlace(source.transitions, prefix, true);
   filterTransitionsInPlace(source.transitions, prefix, false);
+  source.updateTransitionIndex();
 }
 
 Automaton Filter::copyAutomaton(const Automaton &source, std::string ta_prefix,
@@ -147,19 +199,13 @@ Automaton Filter::copyAutomaton(const Automaton &source, std::string ta_prefix,
                 *s.inv.get(), s.urgent, s.initial));
     }
   }
+  SuffixIndex copy_index;
+  for (const auto &s : res_states) {
+    copy_index.add(Filter::stripPrefix(s.id, ta_prefix));
+  }
   for (const auto &trans : source.transitions) {
-    auto source = std::find_if(res_states.begin(), res_states.end(),
-                               [trans, ta_prefix](const State &s) {
-                                 return Filter::matchesFilter(
-                                     trans.source_id, "",
-                                     Filter::stripPrefix(s.id, ta_prefix));
-                               });
-    auto dest = std::find_if(res_states.begin(), res_states.end(),
-                             [trans, ta_prefix](const State &s) {
-                               return Filter::matchesFilter(
-                                   trans.dest_id, "",
-                                   Filter::stripPrefix(s.id, ta_prefix));
-                             });
+    auto source = res_states.begin() + copy_index.findFirst(trans.source_id, "");
+    auto dest = res_states.begin() + copy_index.findFirst(trans.dest_id, "");
     if (source != res_states.end() && dest != res_states.end()) {
       if (strip_constraints) {
         res_transitions.push_back(Transition(source->id, dest->id, trans.action,
@@ -186,12 +232,9 @@ Automaton Filter::filterAutomaton(const Automaton &source,
                                   bool strip_constraints) const {
   std::vector<State> res_states;
   std::vector<Transition> res_transitions;
+  NameIndex source_index(source.states);
   for (const auto &f_state : filter) {
-    auto search = std::find_if(source.states.begin(), source.states.end(),
-                               [f_state, filter_prefix, this](const State &s) {
-                                 return Filter::matchesFilter(
-                                     s.id, filter_prefix, f_state.id);
-                               });
+    auto search = source_index.findFirst(filter_prefix, f_state.id);
     if (search != source.states.end()) {
       if (strip_constraints) {
         res_states.push_back(State(
@@ -207,19 +250,15 @@ Automaton Filter::filterAutomaton(const Automaton &source,
       //           << f_state.id << ")" << std::endl;
     }
   }
+  SuffixIndex copy_index;
+  for (const auto &s : res_states) {
+    copy_index.add(Filter::stripPrefix(s.id, ta_prefix));
+  }
   for (const auto &trans : source.transitions) {
-    auto source = std::find_if(
-        res_states.begin(), res_states.end(),
-        [trans, this, filter_prefix, ta_prefix](const State &s) {
-          return Filter::matchesFilter(trans.source_id, filter_prefix,
-                                       Filter::stripPrefix(s.id, ta_prefix));
-        });
-    auto dest = std::find_if(
-        res_states.begin(), res_states.end(),
-        [trans, this, filter_prefix, ta_prefix](const State &s) {
-          return Filter::matchesFilter(trans.dest_id, filter_prefix,
-                                       Filter::stripPrefix(s.id, ta_prefix));
-        });
+    auto source = res_states.begin() +
+                  copy_index.findFirst(trans.source_id, filter_prefix);
+    auto dest =
+        res_states.begin() + copy_index.findFirst(trans.dest_id, filter_prefix);
     if (source != res_states.end() && dest != res_states.end()) {
       if (strip_constraints) {
         res_transitions.push_back(Transition(source->id, dest->id, trans.action,
@@ -245,13 +284,7 @@ void Filter::addToTransitions(std::vector<Transition> &trans,
                               const update_t &update, std::string prefix,
                               bool filter_source) const {
   for (auto &tr : trans) {
-    auto search = std::find_if(
-        filter.begin(), filter.end(),
-        [filter_source, tr, prefix, this](const State &s) {
-          return Filter::matchesFilter(
-              ((filter_source) ? tr.source_id : tr.dest_id), prefix, s.id);
-        });
-    if (!isFilterEndIt(search)) {
+    if (!isFiltered(((filter_source) ? tr.source_id : tr.dest_id), prefix)) {
       tr.guard = addConstraint(*tr.guard.get(), guard);
       tr.update = addUpdate(tr.update, update);
     }
@@ -259,16 +292,14 @@ void Filter::addToTransitions(std::vector<Transition> &trans,
 }
 Filter Filter::updateFilter(const Automaton &ta) const {
   std::vector<State> update_filter;
+  NameIndex ta_index(ta.states);
   for (const auto &f_state : filter) {
-    auto search = std::find_if(
-        ta.states.begin(), ta.states.end(), [f_state, this](const State &s) {
-          return Filter::matchesFilter(s.id, "", f_state.id);
-        });
+    auto search = ta_index.findFirst("", f_state.id);
     if (search != ta.states.end()) {
       update_filter.push_back(*search);
     } else {
-      std::cout << "Filter updateFilter: base id of filter not found (id "
-                << f_state.id << ")" << std::endl;
+      TAPTENC_LOG_WARN("Filter updateFilter: base id of filter not found (id "
+                       << f_state.id << ")");
     }
   }
   return Filter(update_filter);
@@ -277,19 +308,12 @@ Filter Filter::updateFilter(const Automaton &ta) const {
 Filter Filter::reverseFilter(const Automaton &ta) const {
   std::vector<State> reverse_filter;
   for (const auto &ta_state : ta.states) {
-    auto search =
-        std::find_if(filter.begin(), filter.end(), [ta_state](const State &s) {
-          return Filter::matchesFilter(ta_state.id, "", s.id);
-        });
-    if (search == filter.end()) {
+    if (filter_index.findFirst(ta_state.id, "") == filter_index.size()) {
       reverse_filter.push_back(ta_state);
     }
   }
   return Filter(reverse_filter);
 }
 bool Filter::matchesId(const std::string id) const {
-  return !isFilterEndIt(
-      std::find_if(filter.begin(), filter.end(), [id](const State &s) {
-        return Filter::matchesFilter(id, "", s.id);
-      }));
+  return !isFiltered(id, "");
 }
@@ -6,6 +6,10 @@
  */
 #pragma once
 #include "../timed-automata/timed_automata.h"
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace taptenc {
 /**
@@ -13,17 +17,82 @@ namespace taptenc {
  */
 class Filter {
 private:
+  /**
+   * Index over a sequence of filter suffixes (as passed to matchesFilter())
+   * by their base names.
+   *
+   * Answers which suffix is the first one matched by a given name while only
+   * looking at suffixes that can match at all.
+   */
+  class SuffixIndex {
+  private:
+    ::std::vector<::std::string> suffixes;
+    /** Positions of suffixes with non-empty base name, grouped by it. */
+    ::std::unordered_map<::std::string, ::std::vector<::std::size_t>> by_base;
+    /** Positions of suffixes with empty base name, they match any base. */
+    ::std::vector<::std::size_t> wildcards;
+
+  public:
+    /** Appends a suffix to the index. */
+    void add(const ::std::string &suffix);
+    /**
+     * Finds the first suffix matched by a name.
+     *
+     * @param name name to match against the suffixes
+     * @param prefix prefix required for \a name
+     * @return the smallest position p such that
+     *         matchesFilter(name, prefix, suffix_p) holds or size() if there
+     *         is none
+     */
+    ::std::size_t findFirst(const ::std::string &name,
+                            const ::std::string &prefix) const;
+    ::std::size_t size() const { return suffixes.size(); }
+  };
+
+  /**
+   * Index over state names by their base names.
+   *
+   * The counterpart of SuffixIndex, answering which state is the first one
+   * that matches a given suffix.
+   */
+  class NameIndex {
+  private:
+    const ::std::vector<State> &states;
+    ::std::unordered_map<::std::string, ::std::vector<::std::size_t>> by_base;
+
+  public:
+    NameIndex(const ::std::vector<State> &arg_states);
+    /**
+     * Finds the first state matching a suffix.
+     *
+     * @param prefix prefix required for the state ids
+     * @param suffix suffix the state ids are matched against
+     * @return iterator to the first state s in the indexed states such that
+     *         matchesFilter(s.id, prefix, suffix) holds or the end iterator if
+     *         there is none
+     */
+    ::std::vector<State>::const_iterator
+    findFirst(const ::std::string &prefix, const ::std::string &suffix) const;
+  };
+
   /** Sieve to apply to the states/transition sources/destinations. */
   ::std::vector<State> filter;
+  /** Index over the ids of the states in \a filter. */
+  SuffixIndex filter_index;
   /**
    * If true, keeps the sieved out content instead of the sieved through stuff.
    * */
   bool invert_effect = false;
   /**
-   * Wrapper to check queries in \a filter. Inverts the output if \a
+   * Checks if a name matches any filter state. Inverts the output if \a
    * invert_effect is true.
+   *
+   * @param name id to check
+   * @param prefix prefix required for \a name
+   * @return true iff \a name matches (or does not match if \a invert_effect
+   *         is set) a filter state
    */
-  bool isFilterEndIt(const ::std::vector<State>::const_iterator &it) const;
+  bool isFiltered(const ::std::string &name, const ::std::string &prefix) const;
   /**
    * Checks if a string has a specified suffix.
    *
@@ -31,7 +100,8 @@ private:
    * @param suffix suffix to search in \a name
    * @return true, iff \a suffix is a suffix of \a name
    */
-  static bool hasSuffix(::std::string name, ::std::string suffix);
+  static bool hasSuffix(const ::std::string &name,
+                        const ::std::string &suffix);
   /**
    * Checks if a string has a specified prefix.
    *
@@ -39,7 +109,16 @@ private:
    * @param prefix prefix to search in \a name
    * @return true, iff \a prefix is a prefix of \a name
    */
-  static bool hasPrefix(::std::string name, ::std::string prefix);
+  static bool hasPrefix(const ::std::string &name,
+                        const ::std::string &prefix);
+  /**
+   * Gets the part of a name after the last occurance of constants::BASE_SEP.
+   *
+   * @param name name to get the base name from
+   * @return suffix of \a name after constants::BASE_SEP or \a name if it
+   *         does not contain constants::BASE_SEP
+   */
+  static ::std::string getBaseName(const ::std::string &name);
 
 public:
   /**
@@ -57,8 +136,9 @@ public:
    * @param prefix prefix to search in \a name
    * @param suffix suffix to search in \a name
    */
-  static bool matchesFilter(::std::string name, ::std::string prefix,
-                            ::std::string suffix);
+  static bool matchesFilter(const ::std::string &name,
+                            const ::std::string &prefix,
+                            const ::std::string &suffix);
   /**
    * Removes a prefix from a string.
    *
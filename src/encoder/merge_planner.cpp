@@ -0,0 +1,103 @@
+/** \file
+ * Plans the order in which multiple direct encodings are merged.
+ *
+ * \author: (2019) Tarik Viehmann
+ */
+
+#include "merge_planner.h"
+#include "plan_ordered_tls.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace taptenc;
+
+namespace {
+/** Encoding that is not consumed by a merge step yet. */
+struct pendingNode {
+  size_t node;
+  size_t depth;
+  TlSizes sizes;
+};
+
+size_t mergeCost(const TlSizes &sizes) {
+  EncodingSize total = PlanOrderedTLs::totalSize(sizes);
+  return total.states + total.transitions;
+}
+
+/**
+ * Replaces the pending nodes at \a pos and \a pos + 1 by their merge.
+ */
+void mergeAt(std::vector<pendingNode> &pending, size_t pos,
+             std::vector<MergeStep> &steps, size_t num_inputs) {
+  const pendingNode &left = pending[pos];
+  const pendingNode &right = pending[pos + 1];
+  pendingNode merged{
+      num_inputs + steps.size(), std::max(left.depth, right.depth) + 1,
+      PlanOrderedTLs::predictMergeSizes(left.sizes, right.sizes)};
+  steps.emplace_back(left.node, right.node, merged.depth, merged.sizes);
+  pending[pos] = merged;
+  pending.erase(pending.begin() + pos + 1);
+}
+} // end anonymous namespace
+
+std::vector<MergeStep>
+mergeplanner::planMerges(const std::vector<TlSizes> &sizes,
+                         MergeStrategy strategy) {
+  std::vector<MergeStep> steps;
+  std::vector<pendingNode> pending;
+  for (size_t i = 0; i < sizes.size(); i++) {
+    pending.push_back(pendingNode{i, 0, sizes[i]});
+  }
+  while (pending.size() > 1) {
+    switch (strategy) {
+    case LeftFold:
+      mergeAt(pending, 0, steps, sizes.size());
+      break;
+    case Balanced:
+      for (size_t i = 0; i + 1 < pending.size(); i++) {
+        mergeAt(pending, i, steps, sizes.size());
+      }
+      break;
+    case SmallestFirst: {
+      size_t best_pos = 0;
+      size_t best_cost = 0;
+      for (size_t i = 0; i + 1 < pending.size(); i++) {
+        size_t cost = mergeCost(PlanOrderedTLs::predictMergeSizes(
+            pending[i].sizes, pending[i + 1].sizes));
+        if (i == 0 || cost < best_cost) {
+          best_pos = i;
+          best_cost = cost;
+        }
+      }
+      mergeAt(pending, best_pos, steps, sizes.size());
+      break;
+    }
+    }
+  }
+  return steps;
+}
+
+EncodingSize
+mergeplanner::predictPeakSize(const std::vector<MergeStep> &steps) {
+  EncodingSize peak;
+  for (const auto &step : steps) {
+    EncodingSize curr = PlanOrderedTLs::totalSize(step.predicted);
+    if (curr.states + curr.transitions > peak.states + peak.transitions) {
+      peak = curr;
+    }
+  }
+  return peak;
+}
+
+std::string mergeplanner::toString(MergeStrategy strategy) {
+  switch (strategy) {
+  case LeftFold:
+    return "left fold";
+  case Balanced:
+    return "balanced";
+  case SmallestFirst:
+    return "smallest first";
+  }
+  return "unknown";
+}
@@ -0,0 +1,82 @@
+/** \file
+ * Plans the order in which multiple direct encodings are merged.
+ *
+ * \author: (2019) Tarik Viehmann
+ */
+
+#pragma once
+
+#include "plan_ordered_tls.h"
+#include <string>
+#include <vector>
+
+namespace taptenc {
+/**
+ * Strategies to combine multiple encodings by pairwise merges.
+ *
+ * Only neighbouring encodings are merged, hence the order of the platform
+ * components within the merged ids is the same for all strategies.
+ */
+enum MergeStrategy {
+  /** merge one encoding after another into the accumulated result */
+  LeftFold,
+  /** merge neighbouring encodings pairwise in rounds (balanced binary tree) */
+  Balanced,
+  /** always merge the neighbouring pair with the smallest predicted result */
+  SmallestFirst
+};
+
+/**
+ * One merge operation of a merge plan.
+ *
+ * Operands refer to nodes of the plan: the first nodes are the input
+ * encodings (in the given order), each step adds another node for its result.
+ */
+struct mergeStep {
+  /** node index of the first operand */
+  size_t left;
+  /** node index of the second operand */
+  size_t right;
+  /** steps of the same depth do not depend on each other */
+  size_t depth;
+  /** predicted timeline sizes of the result */
+  TlSizes predicted;
+  mergeStep(size_t arg_left, size_t arg_right, size_t arg_depth,
+            TlSizes arg_predicted)
+      : left(arg_left), right(arg_right), depth(arg_depth),
+        predicted(arg_predicted) {}
+};
+typedef struct mergeStep MergeStep;
+
+/**
+ * Contains functions to plan the merging of encodings.
+ */
+namespace mergeplanner {
+/**
+ * Determines the merge steps needed to combine encodings into one.
+ *
+ * @param sizes timeline sizes of the encodings to merge
+ * @param strategy strategy to pair the encodings
+ * @return merge steps in a valid execution order, the result of the last step
+ *         is the full merge (empty if less than two encodings are given)
+ */
+::std::vector<MergeStep> planMerges(const ::std::vector<TlSizes> &sizes,
+                                    MergeStrategy strategy);
+
+/**
+ * Returns the largest predicted result of a merge plan.
+ *
+ * @param steps merge plan
+ * @return predicted size of the largest intermediate (or final) merge
+ */
+EncodingSize predictPeakSize(const ::std::vector<MergeStep> &steps);
+
+/**
+ * Returns a human readable name of a merge strategy.
+ *
+ * @param strategy merge strategy
+ * @return name of \a strategy
+ */
+::std::string toString(MergeStrategy strategy);
+} // end namespace mergeplanner
+} // end namespace taptenc
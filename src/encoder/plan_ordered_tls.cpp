@@ -5,11 +5,13 @@
 #include "filter.h"
 #include "timed_automata.h"
 #include "utils.h"
+#include "logging.h"
 #include <algorithm>
 #include <iostream>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #define CONTEXT 2
@@ -43,14 +45,14 @@ OrigMap PlanOrderedTLs::createOrigMapping(std::string prefix) const {
   OrigMap res;
   for (const auto &curr_tl : *(tls.get())) {
     for (const auto &tl_entry : curr_tl.second) {
-      if (tl_entry.second.ta.prefix == constants::QUERY) {
+      if (tl_entry.second.ta->prefix == constants::QUERY) {
         continue;
       }
       std::string ta_prefix =
           prefix == ""
-              ? tl_entry.second.ta.prefix
-              : encoderutils::addToPrefix(tl_entry.second.ta.prefix, prefix);
-      res[ta_prefix] = tl_entry.second.ta.prefix;
+              ? tl_entry.second.ta->prefix
+              : encoderutils::addToPrefix(tl_entry.second.ta->prefix, prefix);
+      res[ta_prefix] = tl_entry.second.ta->prefix;
     }
   }
   return res;
@@ -64,16 +66,15 @@ PlanOrderedTLs PlanOrderedTLs::createWindow(std::string start_pa,
   auto start_pa_entry =
       std::find(pa_order.get()->begin(), pa_order.get()->end(), start_pa);
   if (start_pa_entry == pa_order.get()->end()) {
-    std::cout << "PlanOrderedTLs createWindow: could not find start pa "
-              << start_pa << std::endl;
+    TAPTENC_LOG_WARN("PlanOrderedTLs createWindow: could not find start pa "
+                     << start_pa);
     return new_window;
   }
   auto end_pa_entry = std::find(start_pa_entry, pa_order.get()->end(), end_pa);
   if (end_pa_entry == pa_order.get()->end()) {
-    std::cout << "PlanOrderedTLs createWindow: could not find end pa " << end_pa
-              << std::endl;
-    std::cout << "PlanOrderedTLs createWindow: prefix add" << prefix_add
-              << std::endl;
+    TAPTENC_LOG_WARN("PlanOrderedTLs createWindow: could not find end pa "
+                     << end_pa);
+    TAPTENC_LOG_WARN("PlanOrderedTLs createWindow: prefix add" << prefix_add);
     return new_window;
   }
   std::size_t context_start = start_pa_entry - pa_order.get()->begin();
@@ -90,7 +91,7 @@ PlanOrderedTLs PlanOrderedTLs::createWindow(std::string start_pa,
       // copy all original tls
       for (auto &tl_entry : curr_tl->second) {
         std::string ta_prefix =
-            encoderutils::addToPrefix(tl_entry.second.ta.prefix, prefix_add);
+            encoderutils::addToPrefix(tl_entry.second.ta->prefix, prefix_add);
         Automaton copy_ta = target_filter.filterAutomaton(tl_entry.second.ta,
                                                           ta_prefix, "", false);
         std::vector<Transition> cp_to_other_cp;
@@ -107,8 +108,8 @@ PlanOrderedTLs PlanOrderedTLs::createWindow(std::string start_pa,
         auto emp = new_tls.emplace(
             std::make_pair(ta_prefix, TlEntry(copy_ta, cp_to_other_cp)));
         if (emp.second == false) {
-          std::cout << "PlanOrderedTLs createWindow: failed to add prefix: "
-                    << prefix_add << std::endl;
+          TAPTENC_LOG_WARN("PlanOrderedTLs createWindow: failed to add prefix: "
+                           << prefix_add);
         }
       }
       // insert the new tls and also save them in the curr_window
@@ -122,18 +123,16 @@ PlanOrderedTLs PlanOrderedTLs::createWindow(std::string start_pa,
         curr_tl =
             tls.get()->find(pa_order.get()->at(context_start + tls_copied));
         if (curr_tl == tls.get()->end()) {
-          std::cout << "PlanOrderedTLs createWindow: cannot find next tl"
-                    << std::endl;
+          TAPTENC_LOG_WARN("PlanOrderedTLs createWindow: cannot find next tl");
         }
       } else {
         curr_tl = tls.get()->end();
       }
     }
   } else {
-    std::cout << "PlanOrderedTLs createWindow: done cannot find start tl. "
-                 "prefix "
-              << prefix_add << " context start pa "
-              << *(pa_order.get()->begin() + context_start) << std::endl;
+    TAPTENC_LOG_WARN("PlanOrderedTLs createWindow: done cannot find start "
+                     "tl. prefix " << prefix_add << " context start pa "
+                     << *(pa_order.get()->begin() + context_start));
   }
   for (const auto &pa : *(pa_order.get())) {
     new_window.pa_order.get()->push_back(pa);
@@ -149,16 +148,14 @@ void PlanOrderedTLs::createTransitionsToWindow(
   auto start_pa_entry =
       std::find(pa_order.get()->begin(), pa_order.get()->end(), start_pa);
   if (start_pa_entry == pa_order.get()->end()) {
-    std::cout << "PlanOrderedTLs createTransitionsBetweenWindows: could not "
-                 "find start pa "
-              << start_pa << std::endl;
+    TAPTENC_LOG_WARN("PlanOrderedTLs createTransitionsBetweenWindows: could "
+                     "not find start pa " << start_pa);
     return;
   }
   auto end_pa_entry = std::find(start_pa_entry, pa_order.get()->end(), end_pa);
   if (end_pa_entry == pa_order.get()->end()) {
-    std::cout << "PlanOrderedTLs createTransitionsBetweenWindows: could not "
-                 "find end pa "
-              << end_pa << std::endl;
+    TAPTENC_LOG_WARN("PlanOrderedTLs createTransitionsBetweenWindows: could "
+                     "not find end pa " << end_pa);
     return;
   }
   std::size_t context_start = start_pa_entry - pa_order.get()->begin();
@@ -184,22 +181,25 @@ void PlanOrderedTLs::createTransitionsToWindow(
           std::vector<Transition> res;
           res = encoderutils::createCopyTransitionsBetweenTAs(
               source_entry.second.ta, dest_entry->second.ta,
-              dest_entry->second.ta.states, guard, update, "");
+              dest_entry->second.ta->states, guard, update, "");
           if (add_succ_trans) {
             std::vector<Transition> res_succ =
                 encoderutils::createSuccessorTransitionsBetweenTAs(
                     base_ta, source_entry.second.ta, dest_entry->second.ta,
-                    source_entry.second.ta.states, guard, update);
+                    source_entry.second.ta->states, guard, update);
             target_filter.filterTransitionsInPlace(res, dest_entry->first,
                                                    false);
             target_filter.filterTransitionsInPlace(res_succ, dest_entry->first,
                                                    false);
-            source_entry.second.trans_out.insert(
-                source_entry.second.trans_out.end(), res_succ.begin(),
-                res_succ.end());
+            std::vector<Transition> &source_trans_out =
+                source_entry.second.trans_out.write();
+            source_trans_out.insert(source_trans_out.end(), res_succ.begin(),
+                                    res_succ.end());
           }
-          source_entry.second.trans_out.insert(
-              source_entry.second.trans_out.end(), res.begin(), res.end());
+          std::vector<Transition> &source_trans_out =
+              source_entry.second.trans_out.write();
+          source_trans_out.insert(source_trans_out.end(), res.begin(),
+                                  res.end());
         }
       }
     }
@@ -242,38 +242,32 @@ void PlanOrderedTLs::addOutgoingTransOfOrigTL(const TimeLine &orig_tl,
     if (orig_name != to_orig.end()) {
       const auto &orig_entry = orig_tl.find(orig_name->second);
       if (orig_entry != orig_tl.end()) {
-        for (const auto &tr : orig_entry->second.trans_out) {
+        // base names of the states are derived once per entry instead of
+        // once per state and outgoing transition
+        std::unordered_set<std::string> base_names;
+        for (const auto &s : tl_entry.second.ta->states) {
+          base_names.insert(Filter::getSuffix(s.id, constants::BASE_SEP));
+        }
+        for (const auto &tr : *orig_entry->second.trans_out) {
           if (Filter::getPrefix(tr.source_id, constants::TL_SEP) !=
               Filter::getPrefix(tr.dest_id, constants::TL_SEP)) {
             std::string source_base_name =
                 Filter::getSuffix(tr.source_id, constants::BASE_SEP);
-            const auto &source_state = std::find_if(
-                tl_entry.second.ta.states.begin(),
-                tl_entry.second.ta.states.end(),
-                [source_base_name](const State &s) {
-                  return Filter::getSuffix(s.id, constants::BASE_SEP) ==
-                         source_base_name;
-                });
-            if (source_state != tl_entry.second.ta.states.end()) {
-              tl_entry.second.trans_out.push_back(Transition(
-                  tl_entry.first +
-                      Filter::getSuffix(tr.source_id, constants::BASE_SEP),
-                  tr.dest_id, tr.action,
+            if (base_names.find(source_base_name) != base_names.end()) {
+              tl_entry.second.trans_out.write().push_back(Transition(
+                  tl_entry.first + source_base_name, tr.dest_id, tr.action,
                   *addConstraint(*tr.guard.get(), guard).get(), tr.update,
                   tr.sync));
             }
           }
         }
       } else {
-        std::cout
-            << "PlanOrderedTLs addOutgoingTransOfOrigTL: cannot find orig "
-               "tl entry "
-            << orig_name->second << std::endl;
+        TAPTENC_LOG_WARN("PlanOrderedTLs addOutgoingTransOfOrigTL: cannot "
+                         "find orig tl entry " << orig_name->second);
       }
     } else {
-      std::cout
-          << "PlanOrderedTLs addOutgoingTransOfOrigTL: orig mapping not found: "
-          << tl_entry.first << std::endl;
+      TAPTENC_LOG_WARN("PlanOrderedTLs addOutgoingTransOfOrigTL: orig "
+                       "mapping not found: " << tl_entry.first);
     }
   }
 }
@@ -282,12 +276,23 @@ std::vector<Transition> PlanOrderedTLs::addToPrefixOnTransitions(
     const std::vector<Transition> &trans, std::string to_add,
     bool on_inner_trans, bool on_outgoing_trans) {
   std::vector<Transition> res;
+  // transitions share their end points, so each renamed id is derived and
+  // interned only once
+  std::unordered_map<Symbol, Symbol> renamed;
+  auto rename = [&renamed, &to_add](const Symbol &id) -> const Symbol & {
+    auto search = renamed.find(id);
+    if (search == renamed.end()) {
+      search =
+          renamed.emplace(id, Symbol(encoderutils::addToPrefix(id, to_add)))
+              .first;
+    }
+    return search->second;
+  };
   for (const auto &tr : trans) {
     bool is_inner = Filter::getPrefix(tr.source_id, constants::TL_SEP) ==
                     Filter::getPrefix(tr.dest_id, constants::TL_SEP);
     if ((is_inner && on_inner_trans) || (!is_inner && on_outgoing_trans)) {
-      res.push_back(Transition(encoderutils::addToPrefix(tr.source_id, to_add),
-                               encoderutils::addToPrefix(tr.dest_id, to_add),
+      res.push_back(Transition(rename(tr.source_id), rename(tr.dest_id),
                                tr.action, *tr.guard.get(), tr.update, tr.sync));
     }
   }
@@ -341,16 +346,14 @@ void PlanOrderedTLs::addStateInvariantToWindow(std::string start_pa,
   auto start_pa_entry =
       std::find(pa_order.get()->begin(), pa_order.get()->end(), start_pa);
   if (start_pa_entry == pa_order.get()->end()) {
-    std::cout
-        << "PlanOrderedTLs addStateInvariantToWindow: could not find start pa "
-        << start_pa << std::endl;
+    TAPTENC_LOG_WARN("PlanOrderedTLs addStateInvariantToWindow: could not "
+                     "find start pa " << start_pa);
     return;
   }
   auto end_pa_entry = std::find(start_pa_entry, pa_order.get()->end(), end_pa);
   if (end_pa_entry == pa_order.get()->end()) {
-    std::cout
-        << "PlanOrderedTLs addStateInvariantToWindow: could not find end pa "
-        << end_pa << std::endl;
+    TAPTENC_LOG_WARN("PlanOrderedTLs addStateInvariantToWindow: could not "
+                     "find end pa " << end_pa);
     return;
   }
   size_t curr_pa_index = start_pa_entry - pa_order.get()->begin();
@@ -358,14 +361,14 @@ void PlanOrderedTLs::addStateInvariantToWindow(std::string start_pa,
   while (curr_pa_index <= end_pa_index) {
     auto curr_tl = tls.get()->find(*(pa_order.get()->begin() + curr_pa_index));
     if (curr_tl == tls.get()->end()) {
-      std::cout << "PlanOrderedTLs addStateInvariantToWindow: TLs for pa "
-                << *(pa_order.get()->begin() + curr_pa_index) << " not found"
-                << std::endl;
+      TAPTENC_LOG_WARN("PlanOrderedTLs addStateInvariantToWindow: TLs for pa "
+                       << *(pa_order.get()->begin() + curr_pa_index)
+                       << " not found");
       break;
     }
     for (auto &tl_entry : curr_tl->second) {
-      encoderutils::addInvariants(tl_entry.second.ta, tl_entry.second.ta.states,
-                                  inv);
+      Automaton &tl_ta = tl_entry.second.ta.write();
+      encoderutils::addInvariants(tl_ta, tl_ta.states, inv);
     }
     curr_pa_index++;
   }
@@ -378,8 +381,8 @@ Automaton PlanOrderedTLs::collapseTL(const TimeLine &tl, std::string tl_name,
   for (const auto &curr_copy : tl) {
     automata.push_back(curr_copy.second.ta);
     interconnections.insert(interconnections.end(),
-                            curr_copy.second.trans_out.begin(),
-                            curr_copy.second.trans_out.end());
+                            curr_copy.second.trans_out->begin(),
+                            curr_copy.second.trans_out->end());
   }
   std::copy_if(interconnections.begin(), interconnections.end(),
                std::back_inserter(outgoing), [tl_name](const Transition &tr) {
@@ -405,8 +408,8 @@ TimeLine PlanOrderedTLs::replaceStatesByTA(const Automaton &source_ta,
           encoderutils::mergeIds(ta_state.id, curr_trans.dest_id);
       std::string dummy_action = "";
       for (long int i = 0;
-           i < std::count(ta_state.id.begin(), ta_state.id.end(),
-                          constants::COMPONENT_SEP);
+           i < std::count(ta_state.id.str().begin(),
+                          ta_state.id.str().end(), constants::COMPONENT_SEP);
            i++) {
         dummy_action += constants::ACTION_SEP;
       }
@@ -425,15 +428,16 @@ TimeLine PlanOrderedTLs::replaceStatesByTA(const Automaton &source_ta,
     }
     // automata generation complete
     auto emp = product_tas.emplace(
-        make_pair(ta_state.id, TlEntry(state_ta, std::vector<Transition>())));
+        std::make_pair(ta_state.id.str(),
+                       TlEntry(state_ta, std::vector<Transition>())));
     if (emp.second == true) {
-      encoderutils::addInvariants(emp.first->second.ta,
-                                  emp.first->second.ta.states,
+      Automaton &product_ta = emp.first->second.ta.write();
+      encoderutils::addInvariants(product_ta, product_ta.states,
                                   *ta_state.inv.get());
     } else {
-      std::cout << "PlanOrderedTLs replaceStatesByTA: error while creating TA "
-                   "copy. Another copy with this name already exists: "
-                << ta_state.id << std::endl;
+      TAPTENC_LOG_WARN("PlanOrderedTLs replaceStatesByTA: error while "
+                       "creating TA copy. Another copy with this name "
+                       "already exists: " << ta_state.id);
     }
   }
   for (const auto &ta_trans : source_ta.transitions) {
@@ -447,13 +451,14 @@ TimeLine PlanOrderedTLs::replaceStatesByTA(const Automaton &source_ta,
         copy_trans.dest_id = encoderutils::mergeIds(ta_trans.dest_id, s.id);
         std::string dummy_action = "";
         for (long int i = 0;
-             i < std::count(s.id.begin(), s.id.end(), constants::COMPONENT_SEP);
+             i < std::count(s.id.str().begin(), s.id.str().end(),
+                            constants::COMPONENT_SEP);
              i++) {
           dummy_action += constants::ACTION_SEP;
         }
         copy_trans.action =
             encoderutils::mergeActions(dummy_action, ta_trans.action);
-        source_entry->second.trans_out.push_back(copy_trans);
+        source_entry->second.trans_out.write().push_back(copy_trans);
       }
       if (add_succ_trans) {
         for (const auto &tr : ta_to_insert.transitions) {
@@ -467,13 +472,13 @@ TimeLine PlanOrderedTLs::replaceStatesByTA(const Automaton &source_ta,
           succ_trans.update = addUpdate(succ_trans.update, tr.update);
           succ_trans.action =
               encoderutils::mergeActions(succ_trans.action, tr.action);
-          source_entry->second.trans_out.push_back(succ_trans);
+          source_entry->second.trans_out.write().push_back(succ_trans);
         }
       }
     } else {
-      std::cout << "PlanOrderedTLs replaceStatesByTA: error while "
-                   "connecting this states, associated automata not found"
-                << std::endl;
+      TAPTENC_LOG_WARN("PlanOrderedTLs replaceStatesByTA: error while "
+                       "connecting this states, associated automata not "
+                       "found");
     }
   }
 
@@ -502,7 +507,7 @@ PlanOrderedTLs::mergePlanOrderedTLs(const PlanOrderedTLs &other) const {
             entry.second.ta, merged_other_ta, entry.first, false);
         // what about outgoing trans?!!?!?!?!?!?
         std::vector<Transition> product_trans_out;
-        for (const auto &this_ic_trans : entry.second.trans_out) {
+        for (const auto &this_ic_trans : *entry.second.trans_out) {
           if (this_ic_trans.dest_id != constants::QUERY &&
               Filter::getPrefix(this_ic_trans.source_id, constants::TL_SEP) ==
                   Filter::getPrefix(this_ic_trans.dest_id, constants::TL_SEP)) {
@@ -514,8 +519,9 @@ PlanOrderedTLs::mergePlanOrderedTLs(const PlanOrderedTLs &other) const {
               copy_trans.dest_id =
                   encoderutils::mergeIds(this_ic_trans.dest_id, s.id);
               std::string dummy_action = "";
-              for (long int i = 0; i < std::count(s.id.begin(), s.id.end(),
-                                                  constants::COMPONENT_SEP);
+              for (long int i = 0;
+                   i < std::count(s.id.str().begin(), s.id.str().end(),
+                                  constants::COMPONENT_SEP);
                    i++) {
                 dummy_action += constants::ACTION_SEP;
               }
@@ -544,8 +550,8 @@ PlanOrderedTLs::mergePlanOrderedTLs(const PlanOrderedTLs &other) const {
             }
           }
         }
-        merged_res_ta.clocks.insert(entry.second.ta.clocks.begin(),
-                                    entry.second.ta.clocks.end());
+        merged_res_ta.clocks.insert(entry.second.ta->clocks.begin(),
+                                    entry.second.ta->clocks.end());
         merged_res_ta.clocks.insert(merged_other_ta.clocks.begin(),
                                     merged_other_ta.clocks.end());
         (*res.tls.get())[curr_tl.first].emplace(std::make_pair(
@@ -556,6 +562,52 @@ PlanOrderedTLs::mergePlanOrderedTLs(const PlanOrderedTLs &other) const {
   return res;
 }
 
+TlSizes PlanOrderedTLs::getTlSizes() const {
+  TlSizes res;
+  for (const auto &tl : *(tls.get())) {
+    EncodingSize &tl_size = res[tl.first];
+    for (const auto &entry : tl.second) {
+      tl_size.states += entry.second.ta->states.size();
+      tl_size.transitions +=
+          entry.second.ta->transitions.size() + entry.second.trans_out->size();
+      tl_size.copies++;
+    }
+  }
+  return res;
+}
+
+TlSizes PlanOrderedTLs::predictMergeSizes(const TlSizes &sizes1,
+                                          const TlSizes &sizes2) {
+  TlSizes res;
+  for (const auto &tl_size : sizes1) {
+    auto other_size = sizes2.find(tl_size.first);
+    if (other_size == sizes2.end()) {
+      continue;
+    }
+    if (tl_size.first == constants::QUERY) {
+      res.emplace(tl_size);
+      continue;
+    }
+    EncodingSize &merged = res[tl_size.first];
+    merged.states = tl_size.second.states * other_size->second.states;
+    merged.transitions =
+        tl_size.second.transitions * other_size->second.states +
+        tl_size.second.states * other_size->second.transitions;
+    merged.copies = tl_size.second.copies * other_size->second.copies;
+  }
+  return res;
+}
+
+EncodingSize PlanOrderedTLs::totalSize(const TlSizes &sizes) {
+  EncodingSize res;
+  for (const auto &tl_size : sizes) {
+    res.states += tl_size.second.states;
+    res.transitions += tl_size.second.transitions;
+    res.copies += tl_size.second.copies;
+  }
+  return res;
+}
+
 Automaton PlanOrderedTLs::productTA(const Automaton &ta1, const Automaton &ta2,
                                     std::string name, bool add_succ_trans) {
 
@@ -565,8 +617,8 @@ Automaton PlanOrderedTLs::productTA(const Automaton &ta1, const Automaton &ta2,
   for (const auto merged_entry : product_tas) {
     res_tas.push_back(merged_entry.second.ta);
     res_inner_trans.insert(res_inner_trans.end(),
-                           merged_entry.second.trans_out.begin(),
-                           merged_entry.second.trans_out.end());
+                           merged_entry.second.trans_out->begin(),
+                           merged_entry.second.trans_out->end());
   }
   return encoderutils::mergeAutomata(res_tas, res_inner_trans, name);
 }
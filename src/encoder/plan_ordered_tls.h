@@ -13,6 +13,18 @@
 
 namespace taptenc {
 typedef ::std::unordered_map<::std::string, ::std::string> OrigMap;
+/**
+ * Number of states and transitions of (a part of) an encoding.
+ */
+struct encodingSize {
+  size_t states = 0;
+  size_t transitions = 0;
+  /** number of automata copies (TlEntries) */
+  size_t copies = 0;
+};
+typedef struct encodingSize EncodingSize;
+/** Sizes of the timelines of an encoding, keyed like TimeLines. */
+typedef ::std::unordered_map<::std::string, EncodingSize> TlSizes;
 /**
  * Bundles functionalities to manipulate TimeLines.
  *
@@ -199,6 +211,32 @@ public:
    */
   PlanOrderedTLs mergePlanOrderedTLs(const PlanOrderedTLs &other) const;
 
+  /**
+   * Counts states and transitions (including outgoing ones) of each timeline.
+   * @return sizes of all timelines in tls
+   */
+  TlSizes getTlSizes() const;
+
+  /**
+   * Estimates the timeline sizes resulting from mergePlanOrderedTLs().
+   *
+   * Each timeline of the merge is a product of the corresponding timelines,
+   * hence the states multiply and the transitions of one timeline are copied
+   * for each state of the other one.
+   * @param sizes1 timeline sizes of the first encoding
+   * @param sizes2 timeline sizes of the second encoding
+   * @return predicted timeline sizes of the merge
+   */
+  static TlSizes predictMergeSizes(const TlSizes &sizes1,
+                                   const TlSizes &sizes2);
+
+  /**
+   * Sums up the sizes of all timelines.
+   * @param sizes timeline sizes
+   * @return total number of states and transitions
+   */
+  static EncodingSize totalSize(const TlSizes &sizes);
+
   /**
    * Constructs a product TA between two TAs.
    * @param ta1 first ta of the product
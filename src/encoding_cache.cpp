@@ -0,0 +1,356 @@
+/** \file
+ * Content-addressed cache of platform encodings and transformation results.
+ *
+ * \author (2019) Tarik Viehmann
+ */
+#include "encoding_cache.h"
+#include "logging.h"
+#include <algorithm>
+#include <cstdio>
+#include <dirent.h>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <sys/stat.h>
+#include <utime.h>
+
+using namespace taptenc;
+
+namespace {
+/** Header of persisted solutions, bump the version on format changes. */
+const std::string SOLUTION_HEADER = "taptenc-timed-trace 2";
+const std::string SOLUTION_SUFFIX = ".tt";
+
+void appendBounds(std::stringstream &ss, const Bounds &b) {
+  ss << b.lower_bound << computils::toString(b.l_op) << ","
+     << computils::toString(b.r_op) << b.upper_bound << ";";
+}
+
+void appendState(std::stringstream &ss, const State &s) {
+  ss << s.id.str() << "{" << s.inv->toString() << "}" << s.urgent << s.initial
+     << ";";
+}
+
+void appendStates(std::stringstream &ss, const std::vector<State> &states) {
+  ss << "[";
+  for (const auto &s : states) {
+    appendState(ss, s);
+  }
+  ss << "]";
+}
+
+void appendTargetSpecs(std::stringstream &ss, const TargetSpecs &specs) {
+  appendBounds(ss, specs.bounds);
+  appendStates(ss, specs.targets);
+}
+
+void appendActions(std::stringstream &ss,
+                   const std::vector<ActionName> &actions) {
+  ss << "[";
+  for (const auto &act : actions) {
+    ss << act.toString() << ";";
+  }
+  ss << "]";
+}
+
+/**
+ * Clock sets are ordered by pointers, hence sort the clock ids to obtain a
+ * deterministic fingerprint.
+ */
+void appendClocks(std::stringstream &ss,
+                  const std::set<std::shared_ptr<Clock>> &clocks) {
+  std::vector<std::string> ids;
+  for (const auto &cl : clocks) {
+    ids.push_back(cl->id.str());
+  }
+  std::sort(ids.begin(), ids.end());
+  ss << "[";
+  for (const auto &id : ids) {
+    ss << id << ";";
+  }
+  ss << "]";
+}
+} // end anonymous namespace
+
+EncodingCache::EncodingCache(std::string arg_persistence_dir,
+                             std::size_t max_encodings,
+                             std::size_t max_solutions,
+                             std::size_t arg_max_persisted)
+    : encodings(max_encodings), solutions(max_solutions),
+      persistence_dir(arg_persistence_dir), max_persisted(arg_max_persisted) {}
+
+EncodingCache::key_t EncodingCache::hashString(const std::string &str) {
+  key_t res = 14695981039346656037ULL;
+  for (unsigned char c : str) {
+    res ^= c;
+    res *= 1099511628211ULL;
+  }
+  return res;
+}
+
+std::string EncodingCache::fingerprint(const std::vector<PlanAction> &plan) {
+  std::stringstream ss;
+  ss << "plan:";
+  for (const auto &pa : plan) {
+    ss << pa.name.toString() << "(";
+    appendBounds(ss, pa.absolute_time);
+    appendBounds(ss, pa.duration);
+    appendBounds(ss, pa.delay_tolerance);
+    ss << ")";
+  }
+  return ss.str();
+}
+
+std::string EncodingCache::fingerprint(const Automaton &ta) {
+  std::stringstream ss;
+  ss << "ta:" << ta.prefix;
+  appendStates(ss, ta.states);
+  ss << "[";
+  for (const auto &t : ta.transitions) {
+    ss << t.source_id.str() << "->" << t.dest_id.str() << "{" << t.action
+       << "|" << t.guard->toString() << "|" << t.updateToString() << "|"
+       << t.sync << t.passive << "};";
+  }
+  ss << "]";
+  appendClocks(ss, ta.clocks);
+  ss << "[";
+  for (const auto &var : ta.bool_vars) {
+    ss << var << ";";
+  }
+  ss << "]";
+  return ss.str();
+}
+
+std::string EncodingCache::fingerprint(
+    const std::vector<std::unique_ptr<EncICInfo>> &constraints) {
+  std::stringstream ss;
+  ss << "ics:";
+  for (const auto &info : constraints) {
+    ss << info->name << "<" << toString(info->type) << ">";
+    appendActions(ss, info->activations);
+    switch (info->type) {
+    case ICType::Future:
+    case ICType::Past:
+    case ICType::NoOp:
+    case ICType::Invariant: {
+      const UnaryInfo *unary = dynamic_cast<const UnaryInfo *>(info.get());
+      appendTargetSpecs(ss, unary->specs);
+    } break;
+    case ICType::Until:
+    case ICType::Since: {
+      const BinaryInfo *binary = dynamic_cast<const BinaryInfo *>(info.get());
+      appendTargetSpecs(ss, binary->specs);
+      appendStates(ss, binary->pre_targets);
+    } break;
+    case ICType::UntilChain: {
+      const ChainInfo *chain = dynamic_cast<const ChainInfo *>(info.get());
+      for (const auto &specs : chain->specs_list) {
+        appendTargetSpecs(ss, specs);
+      }
+      appendActions(ss, chain->activations_end);
+    } break;
+    }
+    ss << ";";
+  }
+  return ss.str();
+}
+
+std::shared_ptr<const EncodingCache::Encoding>
+EncodingCache::findEncoding(const std::string &fp) {
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  const auto *entry = encodings.find(fp);
+  if (entry == nullptr) {
+    encoding_misses++;
+    return nullptr;
+  }
+  encoding_hits++;
+  return *entry;
+}
+
+void EncodingCache::storeEncoding(const std::string &fp,
+                                  const Encoding &encoding) {
+  auto entry = std::make_shared<const Encoding>(encoding.first.copy(),
+                                                encoding.second);
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  encodings.insert(fp, entry);
+}
+
+bool EncodingCache::findSolution(const std::string &fp, timed_trace_t &res) {
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  const auto *entry = solutions.find(fp);
+  if (entry != nullptr) {
+    solution_hits++;
+    res = *entry;
+    return true;
+  }
+  if (readSolution(fp, res)) {
+    solution_hits++;
+    solutions.insert(fp, res);
+    return true;
+  }
+  solution_misses++;
+  return false;
+}
+
+void EncodingCache::storeSolution(const std::string &fp,
+                                  const timed_trace_t &trace) {
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  if (solutions.insert(fp, trace)) {
+    writeSolution(fp, trace);
+  }
+}
+
+std::string EncodingCache::solutionFile(const std::string &fp) const {
+  std::stringstream ss;
+  ss << persistence_dir << "/" << std::hex << std::setw(16)
+     << std::setfill('0') << hashString(fp) << SOLUTION_SUFFIX;
+  return ss.str();
+}
+
+bool EncodingCache::readSolution(const std::string &fp,
+                                 timed_trace_t &res) const {
+  if (persistence_dir.empty()) {
+    return false;
+  }
+  std::string file = solutionFile(fp);
+  std::ifstream in(file);
+  if (!in) {
+    return false;
+  }
+  std::string line;
+  std::string tag;
+  std::size_t fp_length;
+  if (!std::getline(in, line) || line != SOLUTION_HEADER || !(in >> tag) ||
+      tag != "fingerprint" || !(in >> fp_length) || in.get() != '\n') {
+    TAPTENC_LOG_WARN("EncodingCache: ignoring malformed solution file "
+                     << file);
+    return false;
+  }
+  // files are named after the hash of the fingerprint, different problems
+  // with colliding hashes share a file
+  std::string stored_fp(fp_length, '\0');
+  if (!in.read(&stored_fp[0], fp_length) || stored_fp != fp) {
+    return false;
+  }
+  std::size_t num_entries;
+  if (!(in >> num_entries)) {
+    TAPTENC_LOG_WARN("EncodingCache: ignoring malformed solution file "
+                     << file);
+    return false;
+  }
+  timed_trace_t trace;
+  for (std::size_t i = 0; i < num_entries; i++) {
+    GroundedActionTime time;
+    std::size_t num_actions;
+    if (!(in >> time.earliest_start >> time.max_delay >> num_actions)) {
+      TAPTENC_LOG_WARN("EncodingCache: ignoring truncated solution file "
+                       << file);
+      return false;
+    }
+    // skip the rest of the line, actions are stored one per line
+    std::getline(in, line);
+    std::vector<std::string> actions;
+    for (std::size_t j = 0; j < num_actions && std::getline(in, line); j++) {
+      actions.push_back(line);
+    }
+    if (actions.size() != num_actions) {
+      TAPTENC_LOG_WARN("EncodingCache: ignoring truncated solution file "
+                       << file);
+      return false;
+    }
+    trace.push_back(std::make_pair(time, std::move(actions)));
+  }
+  res = std::move(trace);
+  // mark the file as recently used, see evictPersisted()
+  utime(file.c_str(), nullptr);
+  return true;
+}
+
+void EncodingCache::writeSolution(const std::string &fp,
+                                  const timed_trace_t &trace) const {
+  if (persistence_dir.empty() || max_persisted == 0) {
+    return;
+  }
+  // write to a temporary file first, such that concurrent readers never see
+  // partially written solutions
+  std::string file = solutionFile(fp);
+  std::string tmp_file = file + ".tmp";
+  {
+    std::ofstream out(tmp_file);
+    out << SOLUTION_HEADER << "\n"
+        << "fingerprint " << fp.size() << "\n"
+        << fp << "\n"
+        << trace.size() << "\n";
+    for (const auto &entry : trace) {
+      out << entry.first.earliest_start << " " << entry.first.max_delay << " "
+          << entry.second.size() << "\n";
+      for (const auto &act : entry.second) {
+        out << act << "\n";
+      }
+    }
+    if (!out) {
+      TAPTENC_LOG_WARN("EncodingCache: could not write " << tmp_file);
+      return;
+    }
+  }
+  if (std::rename(tmp_file.c_str(), file.c_str()) != 0) {
+    TAPTENC_LOG_WARN("EncodingCache: could not write " << file);
+    std::remove(tmp_file.c_str());
+    return;
+  }
+  evictPersisted();
+}
+
+void EncodingCache::evictPersisted() const {
+  DIR *dir = opendir(persistence_dir.c_str());
+  if (dir == nullptr) {
+    TAPTENC_LOG_WARN("EncodingCache: could not open " << persistence_dir);
+    return;
+  }
+  std::vector<std::pair<time_t, std::string>> files;
+  for (struct dirent *ent = readdir(dir); ent != nullptr;
+       ent = readdir(dir)) {
+    std::string name = ent->d_name;
+    if (name.size() <= SOLUTION_SUFFIX.size() ||
+        name.compare(name.size() - SOLUTION_SUFFIX.size(),
+                     SOLUTION_SUFFIX.size(), SOLUTION_SUFFIX) != 0) {
+      continue;
+    }
+    std::string path = persistence_dir + "/" + name;
+    struct stat info;
+    if (stat(path.c_str(), &info) == 0) {
+      files.push_back(std::make_pair(info.st_mtime, path));
+    }
+  }
+  closedir(dir);
+  if (files.size() <= max_persisted) {
+    return;
+  }
+  std::sort(files.begin(), files.end());
+  for (std::size_t i = 0; i < files.size() - max_persisted; i++) {
+    if (std::remove(files[i].second.c_str()) != 0) {
+      TAPTENC_LOG_WARN("EncodingCache: could not remove "
+                       << files[i].second);
+    }
+  }
+}
+
+std::size_t EncodingCache::getEncodingHits() const {
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  return encoding_hits;
+}
+
+std::size_t EncodingCache::getEncodingMisses() const {
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  return encoding_misses;
+}
+
+std::size_t EncodingCache::getSolutionHits() const {
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  return solution_hits;
+}
+
+std::size_t EncodingCache::getSolutionMisses() const {
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  return solution_misses;
+}
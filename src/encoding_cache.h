@@ -0,0 +1,203 @@
+/** \file
+ * Content-addressed cache of platform encodings and transformation results.
+ *
+ * \author (2019) Tarik Viehmann
+ */
+#pragma once
+
+#include "encoders.h"
+#include "enc_interconnection_info.h"
+#include "timed_automata.h"
+#include "utap_trace_parser.h"
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace taptenc {
+/**
+ * Remembers the encodings of single platform models and the timed traces of
+ * whole transformations, such that identical sub-problems are neither
+ * re-encoded nor re-solved.
+ *
+ * Entries are identified by a textual fingerprint of the inputs (plan,
+ * platform models and constraints), which is compared on every lookup. Timed
+ * traces can optionally be persisted to a directory and are reused by later
+ * runs. The files are named after a content hash of the fingerprint, which,
+ * unlike std::hash, is stable across program runs, and store the fingerprint
+ * itself to detect hash collisions. Encodings hold shared clock objects and
+ * are only kept in memory.
+ *
+ * The number of entries in memory and on disk is bounded, the least recently
+ * used entries are evicted first (on disk by file modification time).
+ *
+ * All operations are thread-safe, as platforms are encoded concurrently.
+ */
+class EncodingCache {
+public:
+  /** Encoding of a single platform model (see transformation::transform_plan) */
+  typedef ::std::pair<DirectEncoder, AutomataSystem> Encoding;
+  typedef ::std::uint64_t key_t;
+
+private:
+  /**
+   * Map from fingerprints to values holding at most \a capacity entries, the
+   * least recently used entry is evicted first.
+   */
+  template <typename V> class LRUMap {
+  private:
+    struct entry {
+      V value;
+      /** position of the entry within \a recency */
+      ::std::list<const ::std::string *>::iterator recency_pos;
+    };
+    ::std::size_t capacity;
+    ::std::unordered_map<::std::string, entry> entries;
+    /** keys of \a entries, most recently used first */
+    ::std::list<const ::std::string *> recency;
+
+  public:
+    explicit LRUMap(::std::size_t arg_capacity) : capacity(arg_capacity) {}
+
+    /** Returns the value of \a key (marked as used), nullptr if absent. */
+    const V *find(const ::std::string &key) {
+      auto search = entries.find(key);
+      if (search == entries.end()) {
+        return nullptr;
+      }
+      recency.splice(recency.begin(), recency, search->second.recency_pos);
+      return &search->second.value;
+    }
+
+    /**
+     * Adds a value unless \a key is already present.
+     *
+     * @return true iff \a key was not present
+     */
+    bool insert(const ::std::string &key, const V &value) {
+      if (capacity == 0) {
+        return true;
+      }
+      auto emplaced = entries.emplace(key, entry{value, {}});
+      if (!emplaced.second) {
+        return false;
+      }
+      recency.push_front(&emplaced.first->first);
+      emplaced.first->second.recency_pos = recency.begin();
+      if (entries.size() > capacity) {
+        entries.erase(entries.find(*recency.back()));
+        recency.pop_back();
+      }
+      return true;
+    }
+  };
+
+  LRUMap<::std::shared_ptr<const Encoding>> encodings;
+  LRUMap<timed_trace_t> solutions;
+  ::std::string persistence_dir;
+  ::std::size_t max_persisted;
+  mutable ::std::mutex cache_mutex;
+  ::std::size_t encoding_hits = 0;
+  ::std::size_t encoding_misses = 0;
+  ::std::size_t solution_hits = 0;
+  ::std::size_t solution_misses = 0;
+
+  /** Returns the file a solution with fingerprint \a fp is persisted to. */
+  ::std::string solutionFile(const ::std::string &fp) const;
+  /**
+   * Reads a persisted solution.
+   *
+   * @param fp fingerprint of the solution
+   * @param res timed trace to store the result in
+   * @return true iff a valid solution with fingerprint \a fp was found on
+   *         disk
+   */
+  bool readSolution(const ::std::string &fp, timed_trace_t &res) const;
+  /** Writes a solution to disk, failures are only logged. */
+  void writeSolution(const ::std::string &fp,
+                     const timed_trace_t &trace) const;
+  /**
+   * Removes the least recently used solution files, such that at most
+   * \a max_persisted remain.
+   */
+  void evictPersisted() const;
+
+public:
+  /**
+   * @param arg_persistence_dir if non-empty, timed traces are additionally
+   *        stored in and looked up from this (existing) directory
+   * @param max_encodings maximal number of encodings kept in memory
+   * @param max_solutions maximal number of timed traces kept in memory
+   * @param arg_max_persisted maximal number of timed traces kept in
+   *        \a arg_persistence_dir
+   */
+  EncodingCache(::std::string arg_persistence_dir = "",
+                ::std::size_t max_encodings = 64,
+                ::std::size_t max_solutions = 256,
+                ::std::size_t arg_max_persisted = 1024);
+
+  /**
+   * Fowler-Noll-Vo hash (FNV-1a, 64 bit) of a string.
+   *
+   * @param str string to hash
+   * @return hash value of \a str that is stable across runs and platforms
+   */
+  static key_t hashString(const ::std::string &str);
+  /** Returns a textual fingerprint of all plan action properties. */
+  static ::std::string fingerprint(const ::std::vector<PlanAction> &plan);
+  /** Returns a textual fingerprint of the structure of a platform model. */
+  static ::std::string fingerprint(const Automaton &ta);
+  /** Returns a textual fingerprint of a set of constraints. */
+  static ::std::string
+  fingerprint(const ::std::vector<::std::unique_ptr<EncICInfo>> &constraints);
+
+  /**
+   * Looks up the encoding of a platform model.
+   *
+   * @param fp fingerprint of the plan, the platform model and its
+   *        constraints
+   * @return cached encoding, nullptr if there is none
+   */
+  ::std::shared_ptr<const Encoding> findEncoding(const ::std::string &fp);
+  /**
+   * Stores the encoding of a platform model, existing entries are kept.
+   *
+   * @param fp fingerprint of the plan, the platform model and its
+   *        constraints
+   * @param encoding encoding and the system it was created from
+   */
+  void storeEncoding(const ::std::string &fp, const Encoding &encoding);
+  /**
+   * Looks up the timed trace of a transformation, in memory first, then in
+   * the persistence directory.
+   *
+   * @param fp fingerprint of the plan, all platform models and all
+   *        constraints
+   * @param res timed trace to store the result in
+   * @return true iff a cached solution was found
+   */
+  bool findSolution(const ::std::string &fp, timed_trace_t &res);
+  /**
+   * Stores the timed trace of a transformation (and persists it, if a
+   * persistence directory is given).
+   *
+   * @param fp fingerprint of the plan, all platform models and all
+   *        constraints
+   * @param trace resulting timed trace (empty if the plan is infeasible)
+   */
+  void storeSolution(const ::std::string &fp, const timed_trace_t &trace);
+
+  /** Returns the number of encodings answered from the cache. */
+  ::std::size_t getEncodingHits() const;
+  /** Returns the number of encodings that had to be computed. */
+  ::std::size_t getEncodingMisses() const;
+  /** Returns the number of transformations answered from the cache. */
+  ::std::size_t getSolutionHits() const;
+  /** Returns the number of transformations that had to be computed. */
+  ::std::size_t getSolutionMisses() const;
+};
+} // end namespace taptenc
@@ -0,0 +1,78 @@
+/** \file
+ * Leveled logging with compile-time and runtime filtering.
+ *
+ * \author (2019) Tarik Viehmann
+ */
+#include "logging.h"
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <string>
+
+using namespace taptenc;
+
+namespace {
+/** Marks that the level was not read from the environment yet. */
+constexpr int UNINITIALIZED_LEVEL = -1;
+std::atomic<int> curr_level{UNINITIALIZED_LEVEL};
+std::mutex sink_mutex;
+std::ostream *curr_sink = &std::cout;
+
+int initLevel() {
+  const char *env = std::getenv("TAPTENC_LOG_LEVEL");
+  LogLevel level = env == nullptr
+                       ? LogLevel::Info
+                       : logging::parseLevel(std::string(env), LogLevel::Info);
+  int expected = UNINITIALIZED_LEVEL;
+  // keep a level that was set concurrently
+  curr_level.compare_exchange_strong(expected, level);
+  return curr_level.load(std::memory_order_relaxed);
+}
+} // end anonymous namespace
+
+void logging::setLevel(LogLevel level) {
+  curr_level.store(level, std::memory_order_relaxed);
+}
+
+LogLevel logging::getLevel() {
+  int level = curr_level.load(std::memory_order_relaxed);
+  if (level == UNINITIALIZED_LEVEL) {
+    level = initLevel();
+  }
+  return static_cast<LogLevel>(level);
+}
+
+bool logging::isEnabled(LogLevel level) { return level >= getLevel(); }
+
+void logging::setSink(std::ostream &sink) {
+  std::lock_guard<std::mutex> lock(sink_mutex);
+  curr_sink = &sink;
+}
+
+void logging::write(LogLevel level, const std::string &msg) {
+  std::lock_guard<std::mutex> lock(sink_mutex);
+  *curr_sink << msg << '\n';
+  if (level >= LogLevel::Warning) {
+    curr_sink->flush();
+  }
+}
+
+LogLevel logging::parseLevel(const std::string &name, LogLevel fallback) {
+  if (name == "debug") {
+    return LogLevel::Debug;
+  }
+  if (name == "info") {
+    return LogLevel::Info;
+  }
+  if (name == "warning") {
+    return LogLevel::Warning;
+  }
+  if (name == "error") {
+    return LogLevel::Error;
+  }
+  if (name == "silent") {
+    return LogLevel::Silent;
+  }
+  return fallback;
+}
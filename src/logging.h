@@ -0,0 +1,107 @@
+/** \file
+ * Leveled logging with compile-time and runtime filtering.
+ *
+ * Messages are written via the TAPTENC_LOG_* macros, e.g.
+ *~~~
+ * TAPTENC_LOG_DEBUG("Filter stripPrefix: " << prefix << " is no prefix");
+ *~~~
+ * Messages below the compile-time level #TAPTENC_LOG_LEVEL are removed by
+ * the compiler, messages below the runtime level (see logging::setLevel())
+ * only cost a comparison. In both cases the message is not even formatted.
+ *
+ * \author (2019) Tarik Viehmann
+ */
+#pragma once
+
+#include <ostream>
+#include <sstream>
+#include <string>
+
+/**
+ * Minimal level of messages that are compiled in (see taptenc::LogLevel).
+ *
+ * Defaults to 0, so all messages can be enabled at runtime. Set e.g.
+ * -DTAPTENC_LOG_LEVEL=1 to compile out all debug messages.
+ */
+#ifndef TAPTENC_LOG_LEVEL
+#define TAPTENC_LOG_LEVEL 0
+#endif
+
+namespace taptenc {
+/**
+ * Severity of log messages.
+ */
+enum LogLevel {
+  /** diagnostics of internal steps, possibly emitted in hot loops */
+  Debug = 0,
+  /** progress of the transformation */
+  Info = 1,
+  /** unexpected situations the computation recovers from */
+  Warning = 2,
+  /** failures that abort a computation */
+  Error = 3,
+  /** disables all messages */
+  Silent = 4
+};
+
+/**
+ * Global logging configuration and output.
+ */
+namespace logging {
+/**
+ * Sets the minimal level of messages that are written.
+ *
+ * If never called, the level is read from the environment variable
+ * TAPTENC_LOG_LEVEL (debug, info, warning, error or silent), defaulting to
+ * info.
+ */
+void setLevel(LogLevel level);
+LogLevel getLevel();
+/**
+ * Checks whether messages of a level are written at runtime.
+ */
+bool isEnabled(LogLevel level);
+/**
+ * Sets the stream all messages are written to (std::cout by default).
+ *
+ * @param sink output stream, has to outlive all logging calls
+ */
+void setSink(::std::ostream &sink);
+/**
+ * Writes a message to the sink.
+ *
+ * Safe to call from multiple threads, messages are not interleaved.
+ * The sink is only flushed for warnings and errors.
+ *
+ * @param level level of the message
+ * @param msg message without trailing newline
+ */
+void write(LogLevel level, const ::std::string &msg);
+/**
+ * Parses a level name (debug, info, warning, error or silent).
+ *
+ * @param name level name
+ * @param fallback level returned if \a name is unknown
+ */
+LogLevel parseLevel(const ::std::string &name, LogLevel fallback);
+} // end namespace logging
+} // end namespace taptenc
+
+/**
+ * Writes a message of a given level, \a msg is a sequence of stream
+ * insertions.
+ */
+#define TAPTENC_LOG(level, msg)                                                \
+  do {                                                                         \
+    if ((level) >= TAPTENC_LOG_LEVEL &&                                        \
+        ::taptenc::logging::isEnabled(level)) {                                \
+      ::std::ostringstream taptenc_log_stream;                                 \
+      taptenc_log_stream << msg;                                               \
+      ::taptenc::logging::write(level, taptenc_log_stream.str());              \
+    }                                                                          \
+  } while (false)
+
+#define TAPTENC_LOG_DEBUG(msg) TAPTENC_LOG(::taptenc::LogLevel::Debug, msg)
+#define TAPTENC_LOG_INFO(msg) TAPTENC_LOG(::taptenc::LogLevel::Info, msg)
+#define TAPTENC_LOG_WARN(msg) TAPTENC_LOG(::taptenc::LogLevel::Warning, msg)
+#define TAPTENC_LOG_ERROR(msg) TAPTENC_LOG(::taptenc::LogLevel::Error, msg)
@@ -0,0 +1,74 @@
+/** \file
+ * Online monitoring of the execution of a timed trace.
+ *
+ * \author (2019) Tarik Viehmann
+ */
+#include "execution_monitor.h"
+#include "logging.h"
+#include <string>
+
+using namespace taptenc;
+
+ExecutionMonitor::ExecutionMonitor(UTAPTraceParser &arg_parser,
+                                   const timed_trace_t &arg_schedule)
+    : parser(arg_parser), schedule(arg_schedule) {}
+
+MonitorStatus ExecutionMonitor::fail(const std::string &reason) {
+  TAPTENC_LOG_WARN("ExecutionMonitor: replanning required, " << reason);
+  replanning_required = true;
+  return ReplanningRequired;
+}
+
+std::pair<timepoint, timepoint>
+ExecutionMonitor::getWindow(std::size_t pos) const {
+  const GroundedActionTime &timing = schedule.at(pos).first;
+  return std::make_pair(timing.earliest_start,
+                        timing.earliest_start + timing.max_delay);
+}
+
+MonitorStatus ExecutionMonitor::executed(std::size_t pos, timepoint time) {
+  if (replanning_required) {
+    return ReplanningRequired;
+  }
+  if (pos < next_pending || pos >= schedule.size()) {
+    TAPTENC_LOG_WARN("ExecutionMonitor executed: ignoring event of entry "
+                     << pos << ", next pending entry is " << next_pending);
+    return OnSchedule;
+  }
+  std::pair<timepoint, timepoint> window = getWindow(pos);
+  if (time < window.first) {
+    return fail("entry " + std::to_string(pos) + " executed at " +
+                std::to_string(time) + " before its earliest start " +
+                std::to_string(window.first));
+  }
+  if (time > window.second) {
+    return fail("entry " + std::to_string(pos) + " executed at " +
+                std::to_string(time) + " after its latest start " +
+                std::to_string(window.second));
+  }
+  timepoint delay = time - window.first;
+  const timed_trace_t &updated = parser.getCurrentTimedTrace();
+  if (!parser.applyDelayInPlace(pos, delay) ||
+      updated.size() != schedule.size() ||
+      updated[pos].first.earliest_start != time) {
+    return fail("delay of entry " + std::to_string(pos) +
+                " can not be propagated");
+  }
+  // only the groundings of the remaining entries change
+  for (std::size_t i = pos; i < schedule.size(); i++) {
+    schedule[i].first = updated[i].first;
+  }
+  next_pending = pos + 1;
+  return delay == 0 ? OnSchedule : Rescheduled;
+}
+
+MonitorStatus ExecutionMonitor::checkDeadline(timepoint now) {
+  if (replanning_required) {
+    return ReplanningRequired;
+  }
+  if (!isDone() && now > getWindow(next_pending).second) {
+    return fail("deadline of entry " + std::to_string(next_pending) +
+                " passed at " + std::to_string(now));
+  }
+  return OnSchedule;
+}
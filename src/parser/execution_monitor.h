@@ -0,0 +1,107 @@
+/** \file
+ * Online monitoring of the execution of a timed trace.
+ *
+ * \author (2019) Tarik Viehmann
+ */
+#pragma once
+
+#include "../constraints/constraints.h"
+#include "utap_trace_parser.h"
+#include <string>
+#include <utility>
+
+namespace taptenc {
+/**
+ * Assessment of the schedule after an event.
+ */
+enum MonitorStatus {
+  /** the event happened at the earliest possible time */
+  OnSchedule,
+  /** the event was late, the remaining schedule was shifted accordingly */
+  Rescheduled,
+  /** the remaining schedule is infeasible, a new plan is needed */
+  ReplanningRequired
+};
+
+/**
+ * Tracks the execution of a timed trace obtained from
+ * UTAPTraceParser::getTimedTrace().
+ *
+ * Entries of the timed trace are executed in order. Start and end of a plan
+ * action are separate entries, so "action i started/finished at t" both
+ * translate to "entry i was executed at t". Each entry has a feasible window
+ * [earliest_start, earliest_start + max_delay]. Every event propagates its
+ * delay (possibly 0) to the remaining schedule via
+ * UTAPTraceParser::applyDelayInPlace(), which only recomputes the zones and
+ * timings from the executed entry onward. Hence the cost of an event is
+ * linear in the length of the remaining trace (times the number of clocks),
+ * the executed prefix is not replayed.
+ *
+ * Once replanning is required, the monitor stays in that state.
+ */
+class ExecutionMonitor {
+private:
+  UTAPTraceParser &parser;
+  timed_trace_t schedule;
+  /** index of the first entry that was not executed yet */
+  ::std::size_t next_pending = 0;
+  bool replanning_required = false;
+
+  MonitorStatus fail(const ::std::string &reason);
+
+public:
+  /**
+   * Starts monitoring a timed trace.
+   *
+   * @param parser parser that produced \a schedule, has to outlive the
+   *               monitor and is updated with every late event
+   * @param schedule timed trace obtained from \a parser
+   */
+  ExecutionMonitor(UTAPTraceParser &parser, const timed_trace_t &schedule);
+
+  /**
+   * Reports that an entry of the timed trace was executed.
+   *
+   * Entries between the next pending one and \a pos are assumed to have been
+   * executed at their earliest start.
+   *
+   * @param pos index of the executed entry
+   * @param time global time of the execution
+   * @return status of the remaining schedule
+   */
+  MonitorStatus executed(::std::size_t pos, timepoint time);
+  /** Reports the start of a plan action, see executed(). */
+  MonitorStatus actionStarted(::std::size_t pos, timepoint time) {
+    return executed(pos, time);
+  }
+  /** Reports the end of a plan action, see executed(). */
+  MonitorStatus actionFinished(::std::size_t pos, timepoint time) {
+    return executed(pos, time);
+  }
+
+  /**
+   * Checks whether the next pending entry can still be executed in time.
+   *
+   * Meant to be called periodically by the control loop.
+   *
+   * @param now current global time
+   * @return ReplanningRequired iff the window of the next pending entry
+   *         has passed, OnSchedule otherwise
+   */
+  MonitorStatus checkDeadline(timepoint now);
+
+  /**
+   * Returns the feasible execution window of an entry.
+   *
+   * @param pos index of the entry
+   * @return earliest and latest start
+   */
+  ::std::pair<timepoint, timepoint> getWindow(::std::size_t pos) const;
+
+  const timed_trace_t &getSchedule() const { return schedule; }
+  ::std::size_t getNextPending() const { return next_pending; }
+  bool isReplanningRequired() const { return replanning_required; }
+  /** Checks whether all entries of the schedule were executed. */
+  bool isDone() const { return next_pending >= schedule.size(); }
+};
+} // end namespace taptenc
@@ -9,20 +9,27 @@
 #include "../encoder/filter.h"
 #include "../printer/printer.h"
 #include "../timed-automata/timed_automata.h"
-#include "../uppaal_calls.h"
+#include "../solver/solver.h"
 #include "../utils.h"
+#include "logging.h"
 #include <algorithm>
 #include <cassert>
+#include <cerrno>
 #include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
 #include <fstream>
 #include <iostream>
+#include <iterator>
+#include <limits>
 #include <sstream>
 #include <stdlib.h>
 #include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <unordered_map>
 
-using std::cout;
-using std::endl;
 using std::iostream;
 using std::pair;
 using std::string;
@@ -42,105 +49,84 @@ std::ostream &operator<<(std::ostream &os, const GroundedActionTime &g) {
   return os;
 }
 
-SpecialClocksInfo
-UTAPTraceParser::determineSpecialClockBounds(dbm_t differences) {
-  unordered_map<string, timepoint> ids;
-  SpecialClocksInfo res;
-  size_t x = 0;
-  size_t t0 = 0;
-  size_t glob = 0;
-  size_t num_clocks = trace_ta.clocks.size() + 1;
-  // Floyd-Warshall algorithm is applied here:
-  // 1. all entries are set to the maximum value
-  std::vector<std::vector<dbm_entry_t>> distances(
-      num_clocks,
-      std::vector<dbm_entry_t>(
-          num_clocks,
-          std::make_pair(std::numeric_limits<timepoint>::max(), true)));
-  // 2. all weights are added
-  for (const auto &edge : differences) {
-    auto ins_source = ids.insert(::std::make_pair(edge.first.first, x));
-    if (ins_source.second) {
-      if (edge.first.first.find(constants::GLOBAL_CLOCK) != string::npos) {
-        glob = x;
-      }
-      if (edge.first.first.find("t(0)") != string::npos) {
-        t0 = x;
-      }
-      x++;
-    }
-    auto ins_dest = ids.insert(::std::make_pair(edge.first.second, x));
-    if (ins_dest.second) {
-      if (edge.first.second.find(constants::GLOBAL_CLOCK) != string::npos) {
-        glob = x;
-      }
-      if (edge.first.second.find("t(0)") != string::npos) {
-        t0 = x;
-      }
-      x++;
-    }
-    distances[ins_source.first->second][ins_dest.first->second] = edge.second;
-  }
-  // 3. self loops get null costs
-  dbm_entry_t null_constraint = std::make_pair(0, false);
-  for (size_t i = 0; i < num_clocks; i++) {
-    distances[i][i] = null_constraint;
-  }
-  // 4. all possible shorter indirect routes are considered
-  for (size_t k = 0; k < num_clocks; k++) {
-    for (size_t i = 0; i < num_clocks; i++) {
-      for (size_t j = 0; j < num_clocks; j++) {
-        dbm_entry_t curr_indirect_path = distances[i][k] + distances[k][j];
-        if (distances[i][j] > curr_indirect_path) {
-          distances[i][j] = curr_indirect_path;
-        }
-      }
+namespace {
+/**
+ * Finds the first outgoing transition of a state satisfying a predicate,
+ * using the transition index of the automaton.
+ *
+ * @return iterator to the transition, ta.transitions.end() if there is none
+ */
+template <typename Pred>
+std::vector<Transition>::const_iterator
+findOutgoing(const Automaton &ta, const Symbol &source_id, Pred pred) {
+  std::shared_ptr<const TransitionIndex> index = ta.getTransitionIndex();
+  for (std::size_t pos : index->outgoing(source_id)) {
+    if (pred(ta.transitions[pos])) {
+      return ta.transitions.begin() + pos;
     }
   }
-  // 5. check for negative cycle (= self loop with negative costs)
-  bool valid = true;
-  for (size_t i = 0; i < num_clocks; i++) {
-    if (distances[i][i].first != 0) {
-      valid = false;
+  return ta.transitions.end();
+}
+
+/**
+ * Converts a bound of the trace representation to an encoded DBM bound,
+ * bounds at (negated) infinity are treated as no constraint.
+ */
+raw_t toRaw(const dbm_entry_t &entry) {
+  if (entry.first == std::numeric_limits<timepoint>::max() ||
+      entry.first == -std::numeric_limits<timepoint>::max()) {
+    return dbmutils::INF;
+  }
+  return dbmutils::encode(entry.first, entry.second);
+}
+
+dbm_entry_t toEntry(raw_t raw) {
+  if (raw == dbmutils::INF) {
+    return std::make_pair(std::numeric_limits<timepoint>::max(), true);
+  }
+  return std::make_pair(dbmutils::boundOf(raw), dbmutils::isStrict(raw));
+}
+} // end anonymous namespace
+
+DBM UTAPTraceParser::toDBM(const std::vector<ZoneBound> &zone,
+                           const std::vector<size_t> &clock_map) const {
+  DBM res = DBM::unconstrained(clock_indices.size() - 1);
+  for (const auto &bound : zone) {
+    size_t i = clock_map[bound.i];
+    size_t j = clock_map[bound.j];
+    if (i == string::npos || j == string::npos || i == j) {
+      continue;
     }
+    res.setEntry(i, j, std::min(res.get(i, j), bound.bound));
   }
-  // Floyd-Warshall end
+  return res;
+}
 
-  // check if there no negative cycles
-  if (!valid) {
-    std::cerr << "Error - Negative cycle in matrix" << std::endl;
+SpecialClocksInfo
+UTAPTraceParser::determineSpecialClockBounds(const DBM &zone) const {
+  SpecialClocksInfo res;
+  if (zone.isEmpty()) {
+    TAPTENC_LOG_ERROR("UTAPTraceParser determineSpecialClockBounds: Error, "
+                      "negative cycle in matrix");
     return res;
   }
   // determine maximum delay in the symbolic state
 
-  // Note that distances[t0][cl] holds the negated lower bound constraint on
-  // clock cl.
-  dbm_entry_t max_delay =
-      std::make_pair(std::numeric_limits<timepoint>::max(), false);
-  for (size_t i = 0; i < distances[t0].size(); i++) {
-    if (t0 != i) {
-      // the the lower bound is negated, so flip everything
-      // e.g. if the entries are representing (i-t0 < y) and (t0-i <= -x)
-      // then the entries are (<,y) and (<=, -x). To apply constraint
-      // arithmetric we have remodel the lb constraint:
-      // t0-i <= -x   <=>   i-t0 >= x
-      // The corresponding upper bound constraint describing the excluded set
-      // is i -t0 < x, or as entry: (<,x)
-      dbm_entry_t curr_lb = distances[t0][i];
-      // curr_lb.first *=-1;
-      // curr_lb.second = !curr_lb.second;
-      dbm_entry_t curr_max_delay = distances[i][t0] + curr_lb;
-      if (curr_max_delay < max_delay) {
-        max_delay = curr_max_delay;
-      }
-    }
+  // Note that entry (0, i) holds the negated lower bound constraint on
+  // clock i, hence (i, 0) + (0, i) is the difference between upper and lower
+  // bound of clock i.
+  raw_t max_delay = dbmutils::INF;
+  for (size_t i = 1; i < zone.getDimension(); i++) {
+    max_delay =
+        std::min(max_delay, dbmutils::add(zone.get(i, 0), zone.get(0, i)));
   }
   // to obtain the lower bound we have to negate the value, but not the
   // strictness property
-  dbm_entry_t glob_lb = distances[t0][glob];
+  dbm_entry_t glob_lb = toEntry(zone.get(0, global_clock_index));
   glob_lb.first *= -1;
-  res.global_clock = ::std::make_pair(glob_lb, distances[glob][t0]);
-  res.max_delay = max_delay;
+  res.global_clock =
+      ::std::make_pair(glob_lb, toEntry(zone.get(global_clock_index, 0)));
+  res.max_delay = toEntry(max_delay);
   return res;
 }
 
@@ -159,133 +145,71 @@ UTAPTraceParser::determineSpecialClockBounds(dbm_t differences) {
     trace_to_ta_ids.insert(std::make_pair(ta_state_id, source_state_it->id));
     trace_ta.states.push_back(ta_state);
   } else {
-    std::cout
-        << "UTAPTraceParser addStateToTraceTA: Error, source state not found: "
-        << state_id << std::endl;
+    TAPTENC_LOG_ERROR("UTAPTraceParser addStateToTraceTA: Error, source "
+                      "state not found: " << state_id);
   }
   return ta_state_id;
 }
 
-void UTAPTraceParser::parseState(std::string &currentReadLine) {
-  dbm_t closed_dbm;
-  size_t eow = currentReadLine.find_first_of(" \t");
-  // skip "State: "
-  currentReadLine = currentReadLine.substr(eow + 1);
-  // skip component name
-  eow = currentReadLine.find_first_of(".");
-  currentReadLine = currentReadLine.substr(eow + 1);
-  eow = currentReadLine.find_first_of(" ");
-  std::string parsed_state_name = currentReadLine.substr(0, eow);
-  // skip state name
-  currentReadLine = currentReadLine.substr(eow + 1);
-  while (currentReadLine != "") {
-    eow = currentReadLine.find_first_of("-");
-    string t_source = currentReadLine.substr(0, eow);
-    // skip source state and "-"
-    currentReadLine = currentReadLine.substr(eow + 1);
-    eow = currentReadLine.find_first_of("<");
-    string t_dest = currentReadLine.substr(0, eow);
-    t_source = Filter::getSuffix(t_source, '.');
-    t_dest = Filter::getSuffix(t_dest, '.');
-    bool strict = true;
-    // skip dest state and "<"
-    currentReadLine = currentReadLine.substr(eow + 1);
-    if (currentReadLine.front() == '=') {
-      // skip "="
-      // TODO: respect bounds when calculating time window
-      currentReadLine.erase(0, 1);
-      strict = false;
-    }
-    eow = currentReadLine.find_first_of(" \t");
-    int t_weight = stoi(currentReadLine.substr(0, eow));
-    currentReadLine = currentReadLine.substr(eow + 1);
-    auto ins = closed_dbm.insert(::std::make_pair(
-        ::std::make_pair(t_source, t_dest), std::make_pair(t_weight, strict)));
-    if (!ins.second) {
-      cout << "UTAPTraceParser parseState: ERROR duplicate dbm entry" << endl;
-    }
-  }
+void UTAPTraceParser::loadState(const SymbolicTraceState &state,
+                                const std::vector<size_t> &clock_map) {
   if (parsed) {
     // we currently parse a trace from the trace TA, therefore the name is
     // already correct.
-    ta_to_symbolic_state.insert(std::make_pair(parsed_state_name, closed_dbm));
+    ta_to_symbolic_state.insert(
+        std::make_pair(state.state_id, toDBM(state.zone, clock_map)));
   } else {
     size_t state_suffix = trace_ta.states.size();
     if (trace_ta.states.size() != 0) {
       state_suffix -= 1;
     }
     ta_to_symbolic_state.insert(
-        std::make_pair("trace" + std::to_string(state_suffix), closed_dbm));
+        std::make_pair("trace" + std::to_string(state_suffix),
+                       toDBM(state.zone, clock_map)));
   }
 }
 
-void UTAPTraceParser::parseTransition(std::string &currentReadLine) {
-  size_t eow = currentReadLine.find_first_of(" \t");
-  currentReadLine = currentReadLine.substr(eow + 1);
-  eow = currentReadLine.find_first_of(".");
-  string component = currentReadLine.substr(0, eow);
-  // skip component of source id
-  currentReadLine = currentReadLine.substr(eow + 1);
-  eow = currentReadLine.find_first_of(" \t");
-  string source_id = currentReadLine.substr(0, eow);
-  // skip source id
-  currentReadLine = currentReadLine.substr(eow + 1);
-  eow = currentReadLine.find_first_of(".");
-  // skip delimiter -> and component of dest id
-  currentReadLine = currentReadLine.substr(eow + 1);
-  eow = currentReadLine.find_first_of(" \t");
-  string dest_id = currentReadLine.substr(0, eow);
-  eow = currentReadLine.find_first_of("{");
-  // skip dest id (only labels remaining)
-  currentReadLine = currentReadLine.substr(eow + 1);
-  eow = currentReadLine.find_first_of(";");
-  string guard_str = currentReadLine.substr(0, eow);
-  // skip guard and "; "
-  currentReadLine = currentReadLine.substr(eow + 2);
-  eow = currentReadLine.find_first_of(";");
-  string sync_str = currentReadLine.substr(0, eow);
-  // skip sync and "; "
-  currentReadLine = currentReadLine.substr(eow + 2);
-  eow = currentReadLine.find_first_of(";");
-  string update_str = currentReadLine.substr(0, eow);
-  // remove empty guards
-  guard_str = (guard_str == "1") ? "" : convertCharsToHTML(guard_str);
-  sync_str = (sync_str == "0") ? "" : convertCharsToHTML(sync_str);
-  update_str = (update_str == "1") ? "" : convertCharsToHTML(update_str);
+void UTAPTraceParser::loadTransition(const SymbolicTraceTransition &trans) {
   // add parsed transition to trace ta
-  std::string trace_ta_source_id = source_id;
-  std::string trace_ta_dest_id = dest_id;
+  std::string trace_ta_source_id = trans.source_id;
+  std::string trace_ta_dest_id = trans.dest_id;
   // if the parser already parsed a trace this means that the now parsed state
   // ids correspond to the states of trace_ta, therefore only update the already
   // parsed guard.
   if (parsed) {
-    auto trans_entry = std::find_if(
-        trace_ta.transitions.begin(), trace_ta.transitions.end(),
-        [trace_ta_source_id, trace_ta_dest_id](const Transition &t) {
-          return t.source_id == trace_ta_source_id &&
-                 t.dest_id == trace_ta_dest_id;
-        });
+    auto trans_entry = trace_ta.transitions.end();
+    Symbol trace_ta_dest_sym(trace_ta_dest_id);
+    std::shared_ptr<const TransitionIndex> index =
+        trace_ta.getTransitionIndex();
+    for (std::size_t pos : index->outgoing(trace_ta_source_id)) {
+      if (trace_ta.transitions[pos].dest_id == trace_ta_dest_sym) {
+        trans_entry = trace_ta.transitions.begin() + pos;
+        break;
+      }
+    }
     if (trans_entry != trace_ta.transitions.end()) {
-      trans_entry->guard = std::make_unique<UnparsedCC>(UnparsedCC(guard_str));
+      trans_entry->guard =
+          ConstraintTable::instance().intern(UnparsedCC(trans.guard));
     } else {
-      std::cout << "UTAPTraceParser parseTransition: cannot find original "
-                   "transition while parsing trace from trace TA: "
-                << trace_ta_source_id << " -> " << trace_ta_dest_id
-                << std::endl;
+      TAPTENC_LOG_WARN("UTAPTraceParser loadTransition: cannot find "
+                       "original transition while parsing trace from trace "
+                       "TA: " << trace_ta_source_id << " -> "
+                       << trace_ta_dest_id);
     }
     // else add a fresh state to trace_ta.
   } else {
     if (trace_to_ta_ids.size() == 0) {
       // this is the first transition, so also create the source state
-      trace_ta_source_id = addStateToTraceTA(source_id);
+      trace_ta_source_id = addStateToTraceTA(trans.source_id);
     } else {
       trace_ta_source_id =
           "trace" + std::to_string((trace_to_ta_ids.size() - 1));
     }
-    trace_ta_dest_id = addStateToTraceTA(dest_id);
+    trace_ta_dest_id = addStateToTraceTA(trans.dest_id);
     trace_ta.transitions.push_back(Transition(
-        trace_ta_source_id, trace_ta_dest_id, "", UnparsedCC(guard_str),
-        Transition::updateFromString(update_str, trace_ta.clocks), sync_str));
+        trace_ta_source_id, trace_ta_dest_id, "", UnparsedCC(trans.guard),
+        Transition::updateFromString(trans.update, trace_ta.clocks),
+        trans.sync));
   }
 }
 
@@ -306,19 +230,20 @@ UTAPTraceParser::getActionsFromTraceTrans(const Transition &trans,
     return res;
   }
   if (pa_source_id != pa_dest_id) {
-    auto pa_trans = ::std::find_if(
-        plan_ta.transitions.begin(), plan_ta.transitions.end(),
-        [pa_source_id, pa_dest_id, guard_str, sync_str,
-         update_str](const Transition &t) {
-          return t.source_id == pa_source_id && t.dest_id == pa_dest_id &&
+    auto pa_trans = findOutgoing(
+        plan_ta, pa_source_id,
+        [pa_dest_id, guard_str, sync_str, update_str](const Transition &t) {
+          return t.dest_id == pa_dest_id &&
                  guard_str.find(t.guard.get()->toString()) != string::npos &&
                  sync_str.find(t.sync) != string::npos &&
                  update_str.find(t.updateToString()) != string::npos;
         });
     if (pa_trans == plan_ta.transitions.end()) {
-      cout << "ERROR:  cannot find plan ta transition: " << pa_source_id
-           << " -> " << pa_dest_id << " {" << guard_str << "; " << sync_str
-           << "; " << update_str << "}" << endl;
+      TAPTENC_LOG_ERROR("UTAPTraceParser getActionsFromTraceTrans: cannot "
+                        "find plan ta transition: "
+                        << pa_source_id << " -> " << pa_dest_id << " {"
+                        << guard_str << "; " << sync_str << "; " << update_str
+                        << "}");
     } else if (pa_trans->action != "") {
       res.push_back(pa_trans->action);
     } else {
@@ -328,12 +253,10 @@ UTAPTraceParser::getActionsFromTraceTrans(const Transition &trans,
   }
   string base_source_id = Filter::getSuffix(source_id, constants::BASE_SEP);
   string base_dest_id = Filter::getSuffix(dest_id, constants::BASE_SEP);
-  auto base_trans = ::std::find_if(
-      base_ta.transitions.begin(), base_ta.transitions.end(),
-      [base_source_id, base_dest_id, guard_str, sync_str,
-       update_str](const Transition &t) {
-        return t.source_id == base_source_id &&
-               t.dest_id.find(base_dest_id) != string::npos &&
+  auto base_trans = findOutgoing(
+      base_ta, base_source_id,
+      [base_dest_id, guard_str, sync_str, update_str](const Transition &t) {
+        return t.dest_id.str().find(base_dest_id) != string::npos &&
                isPiecewiseContained(t.guard.get()->toString(), guard_str,
                                     constants::CC_CONJUNCTION) &&
                sync_str.find(t.sync) != string::npos &&
@@ -342,9 +265,11 @@ UTAPTraceParser::getActionsFromTraceTrans(const Transition &trans,
       });
   if (base_trans == base_ta.transitions.end()) {
     if (base_source_id != base_dest_id) {
-      cout << "ERROR:  cannot find base ta transition: " << base_source_id
-           << " -> " << base_dest_id << " {" << guard_str << "; " << sync_str
-           << "; " << update_str << "}" << endl;
+      TAPTENC_LOG_ERROR("UTAPTraceParser getActionsFromTraceTrans: cannot "
+                        "find base ta transition: "
+                        << base_source_id << " -> " << base_dest_id << " {"
+                        << guard_str << "; " << sync_str << "; " << update_str
+                        << "}");
     }
   } else {
     std::vector<std::string> action_vec =
@@ -366,134 +291,430 @@ UTAPTraceParser::getActionsFromTraceTrans(const Transition &trans,
   return res;
 }
 
-timed_trace_t UTAPTraceParser::applyDelay(size_t delay_pos, timepoint delay) {
-  if (delay_pos >= trace_ta.transitions.size()) {
-    std::cout
-        << "UTAPTraceParser applyDelay: Error, delay pos not valid. Abort."
-        << std::endl;
-    return timed_trace_t();
+namespace {
+/**
+ * Appends the atomic constraints of x_i - x_j (op) constant.
+ *
+ * @return false iff the comparison is not convex (!=)
+ */
+bool addBounds(size_t i, size_t j, ComparisonOp op, timepoint constant,
+               std::vector<ZoneBound> &res) {
+  switch (op) {
+  case LT:
+  case LTE:
+    res.push_back(ZoneBound{i, j, dbmutils::encode(constant, op == LT)});
+    return true;
+  case GT:
+  case GTE:
+    res.push_back(ZoneBound{j, i, dbmutils::encode(-constant, op == GT)});
+    return true;
+  case EQ:
+    res.push_back(ZoneBound{i, j, dbmutils::encode(constant, false)});
+    res.push_back(ZoneBound{j, i, dbmutils::encode(-constant, false)});
+    return true;
+  default:
+    return false;
+  }
+}
+
+/**
+ * Parses an optionally negative decimal integer.
+ *
+ * @param str string to parse, has to consist of an optional '-' followed by
+ *        at least one digit
+ * @param value parsed integer, only set on success
+ * @return false iff \a str is no integer or does not fit into a timepoint
+ */
+bool parseInt(const std::string &str, timepoint &value) {
+  size_t digits_begin = (!str.empty() && str[0] == '-') ? 1 : 0;
+  if (str.size() == digits_begin ||
+      str.find_first_not_of("0123456789", digits_begin) != string::npos) {
+    return false;
+  }
+  errno = 0;
+  long parsed = std::strtol(str.c_str(), nullptr, 10);
+  if (errno == ERANGE || parsed < std::numeric_limits<timepoint>::min() ||
+      parsed > std::numeric_limits<timepoint>::max()) {
+    return false;
+  }
+  value = static_cast<timepoint>(parsed);
+  return true;
+}
+} // end anonymous namespace
+
+size_t UTAPTraceParser::clockIndexOf(const std::string &name) const {
+  if (name.find(constants::ZERO_CLOCK) != string::npos) {
+    return 0;
   }
+  auto index = clock_indices.find(Filter::getSuffix(trim(name), '.'));
+  return index == clock_indices.end() ? string::npos : index->second;
+}
+
+bool UTAPTraceParser::parseGuard(const std::string &guard,
+                                 std::vector<ZoneBound> &res) const {
+  std::string conj = guard;
+  replaceStringInPlace(conj, "&lt;", "<");
+  replaceStringInPlace(conj, "&gt;", ">");
+  replaceStringInPlace(conj, "&amp;", "&");
+  conj += "&&";
+  for (size_t begin = 0, end = conj.find("&&"); end != string::npos;
+       begin = end + 2, end = conj.find("&&", begin)) {
+    std::string atom = trim(conj.substr(begin, end - begin));
+    if (atom == "" || atom == "1" || atom == "true") {
+      continue;
+    }
+    size_t op_pos = atom.find_first_of("<>=!");
+    if (op_pos == string::npos || op_pos + 1 >= atom.size()) {
+      return false;
+    }
+    size_t op_len = atom[op_pos + 1] == '=' ? 2 : 1;
+    std::string op_str = atom.substr(op_pos, op_len);
+    ComparisonOp op;
+    if (op_str == "<") {
+      op = LT;
+    } else if (op_str == "<=") {
+      op = LTE;
+    } else if (op_str == ">") {
+      op = GT;
+    } else if (op_str == ">=") {
+      op = GTE;
+    } else if (op_str == "==") {
+      op = EQ;
+    } else {
+      return false;
+    }
+    std::string lhs = trim(atom.substr(0, op_pos));
+    std::string rhs = trim(atom.substr(op_pos + op_len));
+    timepoint constant = 0;
+    if (parseInt(lhs, constant)) {
+      // c op x  <=>  x (reversed op) c
+      std::swap(lhs, rhs);
+      op = computils::reverseOp(op);
+    } else if (!parseInt(rhs, constant)) {
+      return false;
+    }
+    // lhs is either a clock or a clock difference
+    size_t minus = lhs.find('-', 1);
+    size_t minuend =
+        clockIndexOf(minus == string::npos ? lhs : lhs.substr(0, minus));
+    size_t subtrahend =
+        minus == string::npos ? 0 : clockIndexOf(lhs.substr(minus + 1));
+    if (minuend == string::npos || subtrahend == string::npos ||
+        !addBounds(minuend, subtrahend, op, constant, res)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool UTAPTraceParser::toZoneBounds(const ClockConstraint &cc,
+                                   std::vector<ZoneBound> &res) const {
+  switch (cc.type) {
+  case CCType::TRUE:
+    return true;
+  case CCType::UNPARSED:
+    return parseGuard(cc.toString(), res);
+  case CCType::CONJUNCTION: {
+    const ConjunctionCC &conj = static_cast<const ConjunctionCC &>(cc);
+    for (const auto &cc_conjunct : conj.content) {
+      if (!toZoneBounds(*cc_conjunct, res)) {
+        return false;
+      }
+    }
+    return true;
+  }
+  case CCType::SIMPLE_BOUND: {
+    const ComparisonCC &comp = static_cast<const ComparisonCC &>(cc);
+    size_t cl = clockIndexOf(comp.clock->id.str());
+    return cl != string::npos &&
+           addBounds(cl, 0, comp.comp, comp.constant, res);
+  }
+  case CCType::DIFFERENCE: {
+    const DifferenceCC &diff = static_cast<const DifferenceCC &>(cc);
+    size_t minuend = clockIndexOf(diff.minuend->id.str());
+    size_t subtrahend = clockIndexOf(diff.subtrahend->id.str());
+    return minuend != string::npos && subtrahend != string::npos &&
+           addBounds(minuend, subtrahend, diff.comp, diff.difference, res);
+  }
+  default:
+    return false;
+  }
+}
+
+bool UTAPTraceParser::commitExecutionTimes(size_t delay_pos,
+                                           timepoint delay) {
   auto global_clock_it = std::find_if(
       trace_ta.clocks.begin(), trace_ta.clocks.end(),
       [](const auto &cl) { return cl.get()->id == constants::GLOBAL_CLOCK; });
-  if (global_clock_it != trace_ta.clocks.end()) {
-    for (size_t trans_offset = 0; trans_offset <= delay_pos; trans_offset++) {
-      auto ta_trans_it = trace_ta.transitions.begin() + trans_offset;
-      timepoint execute_at =
-          (parsed_trace.begin() + trans_offset)->first.earliest_start;
-      if (trans_offset == delay_pos) {
-        execute_at =
-            (parsed_trace.begin() + trans_offset)->first.earliest_start + delay;
-      }
-      ta_trans_it->guard = std::make_unique<ConjunctionCC>(
-          *ta_trans_it->guard.get(),
-          ComparisonCC(*global_clock_it, ComparisonOp::GTE, execute_at));
-    }
-    AutomataSystem trace_system;
-    trace_system.instances.push_back(std::make_pair(trace_ta, ""));
-    std::string query_str =
-        "E<> sys_" + trace_ta.prefix + "." + trace_ta.states.back().id;
-    uppaalcalls::solve(trace_system, "trace_ta", query_str);
-    ta_to_symbolic_state.clear();
-    parseTraceInfo("trace_ta.trace");
-
-    for (auto &cl_val : curr_clock_values) {
-      cl_val.second = std::make_pair(0, false);
-    }
-    std::vector<SpecialClocksInfo> timings = getTraceTimings();
-    assert(timings.size() == parsed_trace.size() + 1);
-    for (size_t i = delay_pos; i < parsed_trace.size(); i++) {
-      // (parsed_trace.begin() + i)->first = *(timings.begin() + i);
-      GroundedActionTime curr_action_grounding;
-      curr_action_grounding.earliest_start =
-          (timings.begin() + i + 1)->global_clock.first.first;
-      curr_action_grounding.max_delay =
-          (timings.begin() + i)->max_delay.first +
-          (timings.begin() + i)->global_clock.first.first -
-          curr_action_grounding.earliest_start;
-      (parsed_trace.begin() + i)->first = curr_action_grounding;
+  if (global_clock_it == trace_ta.clocks.end()) {
+    TAPTENC_LOG_ERROR("UTAPTraceParser applyDelay: Error, global clock "
+                      "not found. Abort.");
+    return false;
+  }
+  // earlier execution times are committed already and do not change
+  for (size_t trans_offset = std::min(num_committed, delay_pos);
+       trans_offset <= delay_pos; trans_offset++) {
+    auto ta_trans_it = trace_ta.transitions.begin() + trans_offset;
+    timepoint execute_at =
+        (parsed_trace.begin() + trans_offset)->first.earliest_start;
+    if (trans_offset == delay_pos) {
+      execute_at =
+          (parsed_trace.begin() + trans_offset)->first.earliest_start + delay;
     }
+    ta_trans_it->guard = ConstraintTable::instance().intern(ConjunctionCC(
+        *ta_trans_it->guard.get(),
+        ComparisonCC(*global_clock_it, ComparisonOp::GTE, execute_at)));
+  }
+  num_committed = std::max(num_committed, delay_pos + 1);
+  return true;
+}
+
+void UTAPTraceParser::updateTimedTrace(size_t delay_pos,
+                                       size_t first_changed_state) {
+  const std::vector<SpecialClocksInfo> &timings =
+      getTraceTimings(first_changed_state);
+  // parsed_trace omits the last transition to the final state
+  assert(timings.size() == parsed_trace.size() + 2);
+  for (size_t i = delay_pos; i < parsed_trace.size(); i++) {
+    GroundedActionTime curr_action_grounding;
+    curr_action_grounding.earliest_start =
+        (timings.begin() + i + 1)->global_clock.first.first;
+    curr_action_grounding.max_delay =
+        (timings.begin() + i)->max_delay.first +
+        (timings.begin() + i)->global_clock.first.first -
+        curr_action_grounding.earliest_start;
+    (parsed_trace.begin() + i)->first = curr_action_grounding;
+  }
+}
+
+timed_trace_t UTAPTraceParser::applyDelay(size_t delay_pos, timepoint delay,
+                                          Solver &solver) {
+  if (delay_pos >= trace_ta.transitions.size()) {
+    TAPTENC_LOG_ERROR("UTAPTraceParser applyDelay: Error, delay pos not "
+                      "valid. Abort.");
+    return timed_trace_t();
+  }
+  if (!commitExecutionTimes(delay_pos, delay)) {
     return parsed_trace;
-  } else {
-    std::cout
-        << "UTAPTraceParser applyDelay: Error, global clock not found. Abort."
-        << std::endl;
+  }
+  AutomataSystem trace_system;
+  trace_system.instances.push_back(std::make_pair(trace_ta, ""));
+  SolverResult solution =
+      solver.solve(trace_system, trace_ta.states.back().id);
+  if (solution.status != SolverStatus::Reachable) {
+    TAPTENC_LOG_ERROR("UTAPTraceParser applyDelay: Error, delayed trace "
+                      "is not feasible. Abort.");
     return parsed_trace;
   }
+  ta_to_symbolic_state.clear();
+  loadTrace(solution.trace);
+  // all zones are replaced by the new trace
+  updateTimedTrace(delay_pos, 0);
+  return parsed_trace;
 }
 
-::std::vector<SpecialClocksInfo> UTAPTraceParser::getTraceTimings() {
-  std::vector<SpecialClocksInfo> res;
-  if (parsed == true) {
-    for (auto ta_trans = trace_ta.transitions.begin();
-         ta_trans != trace_ta.transitions.end(); ++ta_trans) {
-      if (ta_trans == trace_ta.transitions.begin()) {
-        auto src_dbm_it = ta_to_symbolic_state.find(ta_trans->source_id);
-        if (src_dbm_it != ta_to_symbolic_state.end()) {
-          res.push_back(determineSpecialClockBounds(src_dbm_it->second));
-        } else {
-          std::cout << "ERROR, dbm not found: " << ta_trans->source_id
-                    << std::endl;
-        }
-      }
-      auto dst_dbm_it = ta_to_symbolic_state.find(ta_trans->dest_id);
-      if (dst_dbm_it != ta_to_symbolic_state.end()) {
-        SpecialClocksInfo src_duration =
-            determineSpecialClockBounds(dst_dbm_it->second);
-        // add upper bound to previous (=source) state
-        res.back().global_clock.second = src_duration.global_clock.first;
-        // determine the updated upper bound of t(0) - global_clock by
-        // adding the negated previous bound together with the current one.
-        // Note that the bound is stored by negated by default, therefore
-        // the current lb is actually negated.
-        dbm_entry_t last_lb = res.back().global_clock.first;
-        dbm_entry_t progress = src_duration.global_clock.first;
-        // last_lb.first *= -1;
-        progress = progress - last_lb;
-        // progress all clocks
-        for (const auto &cl : trace_ta.clocks) {
-          curr_clock_values[cl] = curr_clock_values[cl] + progress;
-        }
-        // reset clocks on transition
-        for (const auto &cl_up : ta_trans->update) {
-          curr_clock_values[cl_up] = std::make_pair(0, false);
-        }
-        // update the dbm
-        for (const auto &cl : trace_ta.clocks) {
-          auto cl_lb_entry =
-              std::find_if(dst_dbm_it->second.begin(), dst_dbm_it->second.end(),
-                           [cl](const auto &entry) {
-                             return entry.first.first == "t(0)" &&
-                                    entry.first.second == cl.get()->id;
-                           });
-          if (cl_lb_entry == dst_dbm_it->second.end()) {
-            std::cout << "create new entry" << std::endl;
-            dst_dbm_it->second[std::make_pair("t(0)", cl.get()->id)] =
-                curr_clock_values[cl];
-            dst_dbm_it->second[std::make_pair("t(0)", cl.get()->id)].first *=
-                -1;
-          } else {
-            cl_lb_entry->second = curr_clock_values[cl];
-            cl_lb_entry->second.first *= -1;
-          }
-        }
-        res.push_back(determineSpecialClockBounds(dst_dbm_it->second));
-      } else {
-        std::cout << "ERROR, dbm not found: " << ta_trans->dest_id << std::endl;
-      }
+timed_trace_t UTAPTraceParser::applyDelay(size_t delay_pos, timepoint delay) {
+  if (!applyDelayInPlace(delay_pos, delay) &&
+      (delay_pos >= trace_ta.transitions.size() ||
+       delay_pos >= parsed_trace.size())) {
+    return timed_trace_t();
+  }
+  return parsed_trace;
+}
+
+bool UTAPTraceParser::applyDelayInPlace(size_t delay_pos, timepoint delay) {
+  if (delay_pos >= trace_ta.transitions.size() ||
+      delay_pos >= parsed_trace.size()) {
+    TAPTENC_LOG_ERROR("UTAPTraceParser applyDelay: Error, delay pos not "
+                      "valid. Abort.");
+    return false;
+  }
+  // translate all constraints of the remaining trace before anything is
+  // modified, vectors are indexed relative to delay_pos
+  size_t num_trans = trace_ta.transitions.size();
+  size_t num_remaining = num_trans - delay_pos;
+  std::vector<std::vector<ZoneBound>> guards(num_remaining);
+  std::vector<std::vector<ZoneBound>> invariants(num_remaining + 1);
+  std::vector<const State *> locs(num_remaining + 1, nullptr);
+  std::vector<DBM> zones;
+  for (size_t k = delay_pos; k <= num_trans; k++) {
+    const Symbol &id = k < num_trans ? trace_ta.transitions[k].source_id
+                                     : trace_ta.transitions[k - 1].dest_id;
+    // trace_ta is a chain, state k is the source of transition k
+    const State *loc = (k < trace_ta.states.size() &&
+                        trace_ta.states[k].id == id)
+                           ? &trace_ta.states[k]
+                           : nullptr;
+    bool supported =
+        loc != nullptr &&
+        toZoneBounds(*loc->inv, invariants[k - delay_pos]) &&
+        (k == num_trans ||
+         toZoneBounds(*trace_ta.transitions[k].guard, guards[k - delay_pos]));
+    if (!supported) {
+      TAPTENC_LOG_ERROR("UTAPTraceParser applyDelay: Error, constraints of "
+                        << id << " can not be propagated in memory. Abort.");
+      return false;
+    }
+    locs[k - delay_pos] = loc;
+  }
+  auto start_zone = ta_to_symbolic_state.find(locs[0]->id.str());
+  if (start_zone == ta_to_symbolic_state.end() || global_clock_index == 0) {
+    TAPTENC_LOG_ERROR("UTAPTraceParser applyDelay: Error, zone or global "
+                      "clock not found. Abort.");
+    return false;
+  }
+  guards[0].push_back(ZoneBound{
+      0, global_clock_index,
+      dbmutils::encode(
+          -(parsed_trace[delay_pos].first.earliest_start + delay), false)});
+  // successor zones along the trace
+  zones.push_back(start_zone->second);
+  for (size_t k = 0; k < num_remaining; k++) {
+    DBM succ = zones.back();
+    bool feasible = applyBounds(succ, guards[k]);
+    for (const auto &cl : trace_ta.transitions[delay_pos + k].update) {
+      succ.reset(clock_indices.at(cl->id.str()));
+    }
+    feasible = feasible && applyBounds(succ, invariants[k + 1]);
+    if (feasible && !locs[k + 1]->urgent) {
+      succ.up();
+      applyBounds(succ, invariants[k + 1]);
+    }
+    if (!feasible) {
+      TAPTENC_LOG_ERROR("UTAPTraceParser applyDelay: Error, delayed trace "
+                        "is not feasible. Abort.");
+      return false;
+    }
+    zones.push_back(succ);
+  }
+  // keep only valuations from which the remaining trace can be taken
+  for (size_t k = num_remaining; k > 0; k--) {
+    DBM pre = zones[k];
+    for (const auto &cl : trace_ta.transitions[delay_pos + k - 1].update) {
+      size_t cl_index = clock_indices.at(cl->id.str());
+      pre.constrain(cl_index, 0, dbmutils::LE_ZERO);
+      pre.constrain(0, cl_index, dbmutils::LE_ZERO);
+      pre.free(cl_index);
     }
+    applyBounds(pre, guards[k - 1]);
+    DBM &prev = zones[k - 1];
+    pre.intersect(prev);
+    if (!locs[k - 1]->urgent) {
+      pre.down();
+      pre.intersect(prev);
+    }
+    prev = pre;
+  }
+  commitExecutionTimes(delay_pos, delay);
+  for (size_t k = 0; k <= num_remaining; k++) {
+    ta_to_symbolic_state.at(locs[k]->id.str()) = zones[k];
+  }
+  updateTimedTrace(delay_pos, delay_pos);
+  return true;
+}
+
+bool UTAPTraceParser::applyBounds(DBM &zone,
+                                  const std::vector<ZoneBound> &bounds) {
+  for (const auto &b : bounds) {
+    if (!zone.constrain(b.i, b.j, b.bound)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+const ::std::vector<SpecialClocksInfo> &
+UTAPTraceParser::getTraceTimings(size_t first_changed_state) {
+  std::vector<SpecialClocksInfo> &res = last_timings;
+  if (parsed != true) {
+    TAPTENC_LOG_ERROR("UTAPTraceParser getTimedTrace: Trace was not "
+                      "parsed yet. Abort. ");
+    res.clear();
     return res;
+  }
+  bool complete = res.size() == trace_ta.transitions.size() + 1 &&
+                  clock_values_at.size() == res.size();
+  // the step of the transition into the first changed state is redone, as
+  // it also sets the upper bound of the state before
+  size_t first_trans = 0;
+  if (complete && first_changed_state > 0 &&
+      first_changed_state < res.size()) {
+    first_trans = first_changed_state - 1;
+    res.resize(first_changed_state);
+    clock_values_at.resize(first_changed_state);
+    size_t cl_pos = 0;
+    for (const auto &cl : trace_ta.clocks) {
+      curr_clock_values[cl] = clock_values_at.back()[cl_pos++];
+    }
   } else {
-    std::cout
-        << "UTAPTraceParser getTimedTrace: Trace was not parsed yet. Abort. "
-        << std::endl;
-    return res;
+    res.clear();
+    clock_values_at.clear();
+    for (auto &cl_val : curr_clock_values) {
+      cl_val.second = std::make_pair(0, false);
+    }
+  }
+  std::vector<raw_t> lower_bounds(clock_indices.size());
+  std::vector<dbm_entry_t> clock_values;
+  for (auto ta_trans = trace_ta.transitions.begin() + first_trans;
+       ta_trans != trace_ta.transitions.end(); ++ta_trans) {
+    if (clock_values_at.empty()) {
+      auto src_dbm_it = ta_to_symbolic_state.find(ta_trans->source_id);
+      if (src_dbm_it != ta_to_symbolic_state.end()) {
+        res.push_back(determineSpecialClockBounds(src_dbm_it->second));
+      } else {
+        TAPTENC_LOG_ERROR("ERROR, dbm not found: " << ta_trans->source_id);
+      }
+      clock_values.clear();
+      for (const auto &cl : trace_ta.clocks) {
+        clock_values.push_back(curr_clock_values[cl]);
+      }
+      clock_values_at.push_back(clock_values);
+    }
+    auto dst_dbm_it = ta_to_symbolic_state.find(ta_trans->dest_id);
+    if (dst_dbm_it != ta_to_symbolic_state.end()) {
+      DBM zone = dst_dbm_it->second;
+      SpecialClocksInfo src_duration = determineSpecialClockBounds(zone);
+      // add upper bound to previous (=source) state
+      res.back().global_clock.second = src_duration.global_clock.first;
+      // determine the updated upper bound of t(0) - global_clock by
+      // adding the negated previous bound together with the current one.
+      // Note that the bound is stored by negated by default, therefore
+      // the current lb is actually negated.
+      dbm_entry_t last_lb = res.back().global_clock.first;
+      dbm_entry_t progress = src_duration.global_clock.first;
+      // last_lb.first *= -1;
+      progress = progress - last_lb;
+      // progress all clocks
+      for (const auto &cl : trace_ta.clocks) {
+        curr_clock_values[cl] = curr_clock_values[cl] + progress;
+      }
+      // reset clocks on transition
+      for (const auto &cl_up : ta_trans->update) {
+        curr_clock_values[cl_up] = std::make_pair(0, false);
+      }
+      // tighten the (negated) lower bounds of the zone to the clock values
+      // of the fastest run, the zone stays canonical without a full closure
+      std::fill(lower_bounds.begin(), lower_bounds.end(), dbmutils::INF);
+      clock_values.clear();
+      for (const auto &cl : trace_ta.clocks) {
+        dbm_entry_t lb = curr_clock_values[cl];
+        clock_values.push_back(lb);
+        lb.first *= -1;
+        lower_bounds[clock_indices.at(cl->id.str())] = toRaw(lb);
+      }
+      clock_values_at.push_back(clock_values);
+      zone.constrainRow(0, lower_bounds);
+      res.push_back(determineSpecialClockBounds(zone));
+    } else {
+      TAPTENC_LOG_ERROR("ERROR, dbm not found: " << ta_trans->dest_id);
+    }
   }
+  return res;
 }
 
 timed_trace_t UTAPTraceParser::getTimedTrace(const Automaton &base_ta,
                                              const Automaton &plan_ta) {
-  std::vector<SpecialClocksInfo> trace_timings = getTraceTimings();
+  const std::vector<SpecialClocksInfo> &trace_timings = getTraceTimings();
   timed_trace_t res;
   assert(trace_timings.size() == trace_ta.transitions.size() + 1);
   // the last transition goes to fin, hence we skip it
@@ -523,58 +744,320 @@ timed_trace_t UTAPTraceParser::getTimedTrace(const Automaton &base_ta,
   return res;
 }
 
-bool UTAPTraceParser::parseTraceInfo(const std::string &file) {
-  // file
-  std::fstream fileStream;
-  std::string currentReadLine;
-  fileStream.open(file, std::fstream::in); // open the file in Input mode
-  if (getline(fileStream, currentReadLine)) {
-    if (currentReadLine.size() > 5) {
-      if (currentReadLine.substr(0, 5) == "State") {
-        parseState(currentReadLine);
+namespace {
+/**
+ * Read-only content of a file, memory mapped if possible.
+ */
+class MappedFile {
+private:
+  void *mapping = MAP_FAILED;
+  size_t size = 0;
+  /** Holds the content if the file could not be mapped. */
+  std::string fallback;
+  bool is_open = false;
+
+public:
+  explicit MappedFile(const std::string &file) {
+    int fd = open(file.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return;
+    }
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+      size = static_cast<size_t>(info.st_size);
+      mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapping != MAP_FAILED) {
+        madvise(mapping, size, MADV_SEQUENTIAL);
+      }
+    }
+    close(fd);
+    if (mapping == MAP_FAILED) {
+      std::ifstream stream(file, std::ios::binary);
+      fallback.assign(std::istreambuf_iterator<char>(stream),
+                      std::istreambuf_iterator<char>());
+    }
+    is_open = true;
+  }
+  ~MappedFile() {
+    if (mapping != MAP_FAILED) {
+      munmap(mapping, size);
+    }
+  }
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  bool isOpen() const { return is_open; }
+  const char *begin() const {
+    return mapping != MAP_FAILED ? static_cast<const char *>(mapping)
+                                 : fallback.data();
+  }
+  const char *end() const {
+    return mapping != MAP_FAILED ? begin() + size : begin() + fallback.size();
+  }
+};
+
+/**
+ * Single-pass tokenizer for .trace files (output of uppaal).
+ *
+ * Tokens are character ranges of the input, only the ids and labels stored
+ * in the resulting trace are copied. Clock names are resolved to their index
+ * in SymbolicTrace::clocks on first occurrence.
+ */
+class TraceLexer {
+private:
+  const char *pos;
+  const char *input_end;
+  const char *line_begin = nullptr;
+  const char *line_end = nullptr;
+  SymbolicTrace &trace;
+  std::unordered_map<std::string, size_t> clock_ids;
+  /** Reused buffer to look up clock names without allocations. */
+  std::string key;
+
+  /**
+   * Finds the first occurrence of one of the characters in \a chars.
+   *
+   * @return position of the match or \a to if there is none
+   */
+  static const char *findFirstOf(const char *from, const char *to,
+                                 const char *chars) {
+    for (; from < to; from++) {
+      if (std::strchr(chars, *from) != nullptr) {
+        return from;
+      }
+    }
+    return to;
+  }
+
+  size_t clockId(const char *from, const char *to) {
+    const char *suffix = to;
+    while (suffix > from && *(suffix - 1) != '.') {
+      suffix--;
+    }
+    key.assign(suffix, to);
+    auto ins = clock_ids.insert(std::make_pair(key, trace.clocks.size()));
+    if (ins.second) {
+      trace.clocks.push_back(key);
+    }
+    return ins.first->second;
+  }
+
+  static raw_t parseBound(const char *from, const char *to, bool strict) {
+    bool negative = from < to && *from == '-';
+    if (negative) {
+      from++;
+    }
+    timepoint value = 0;
+    for (; from < to && *from >= '0' && *from <= '9'; from++) {
+      value = value * 10 + (*from - '0');
+    }
+    return dbmutils::encode(negative ? -value : value, strict);
+  }
+
+public:
+  TraceLexer(const char *begin, const char *end, SymbolicTrace &arg_trace)
+      : pos(begin), input_end(end), trace(arg_trace) {
+    if (trace.clocks.empty()) {
+      trace.clocks.push_back(constants::ZERO_CLOCK);
+    }
+    for (size_t i = 0; i < trace.clocks.size(); i++) {
+      clock_ids.insert(std::make_pair(trace.clocks[i], i));
+    }
+  }
+
+  /**
+   * Advances to the next line.
+   *
+   * @return false iff the input is exhausted, the current line is empty then
+   */
+  bool nextLine() {
+    if (pos >= input_end) {
+      line_begin = line_end = input_end;
+      return false;
+    }
+    line_begin = pos;
+    line_end = static_cast<const char *>(
+        std::memchr(pos, '\n', static_cast<size_t>(input_end - pos)));
+    if (line_end == nullptr) {
+      line_end = input_end;
+    }
+    pos = line_end < input_end ? line_end + 1 : input_end;
+    return true;
+  }
+
+  size_t lineLength() const { return line_end - line_begin; }
+  bool lineStartsWith(const char *prefix) const {
+    size_t len = std::strlen(prefix);
+    return lineLength() >= len && std::memcmp(line_begin, prefix, len) == 0;
+  }
+  std::string line() const { return std::string(line_begin, line_end); }
+
+  /**
+   * Parses the current line, which holds a state, e.g.
+   * "State: comp.loc t(0)-comp.x<=0 comp.x-t(0)<5 ".
+   */
+  SymbolicTraceState parseState() {
+    SymbolicTraceState res;
+    // skip "State: " and the component name
+    const char *p = findFirstOf(line_begin, line_end, " \t");
+    p = findFirstOf(p, line_end, ".");
+    p = std::min(p + 1, line_end);
+    const char *eow = findFirstOf(p, line_end, " ");
+    res.state_id.assign(p, eow);
+    p = eow;
+    while (true) {
+      while (p < line_end && (*p == ' ' || *p == '\t')) {
+        p++;
+      }
+      if (p == line_end) {
+        break;
+      }
+      const char *minus = findFirstOf(p, line_end, "-");
+      const char *comp = findFirstOf(minus, line_end, "<");
+      if (comp == line_end) {
+        TAPTENC_LOG_WARN("UTAPTraceParser parseState: malformed bound in "
+                         << line());
+        break;
+      }
+      size_t minuend = clockId(p, minus);
+      size_t subtrahend = clockId(minus + 1, comp);
+      bool strict = true;
+      p = comp + 1;
+      if (p < line_end && *p == '=') {
+        strict = false;
+        p++;
+      }
+      eow = findFirstOf(p, line_end, " \t");
+      res.zone.push_back(
+          ZoneBound{minuend, subtrahend, parseBound(p, eow, strict)});
+      p = eow;
+    }
+    return res;
+  }
+
+  /**
+   * Parses the current line, which holds a transition, e.g.
+   * "Transition: comp.a -> comp.b {x < 5; ch!; x := 0;}".
+   */
+  SymbolicTraceTransition parseTransition() {
+    SymbolicTraceTransition res;
+    // skip "Transition: " and the component of the source id
+    const char *p = findFirstOf(line_begin, line_end, " \t");
+    p = std::min(findFirstOf(p, line_end, ".") + 1, line_end);
+    const char *eow = findFirstOf(p, line_end, " \t");
+    res.source_id.assign(p, eow);
+    // skip delimiter -> and component of dest id
+    p = std::min(findFirstOf(eow, line_end, ".") + 1, line_end);
+    eow = findFirstOf(p, line_end, " \t");
+    res.dest_id.assign(p, eow);
+    // skip dest id (only labels remaining)
+    p = std::min(findFirstOf(p, line_end, "{") + 1, line_end);
+    std::string labels[3];
+    for (auto &label : labels) {
+      eow = findFirstOf(p, line_end, ";");
+      label.assign(p, eow);
+      // skip label and "; "
+      p = std::min(eow + 2, line_end);
+    }
+    // remove empty labels
+    res.guard = (labels[0] == "1") ? "" : convertCharsToHTML(labels[0]);
+    res.sync = (labels[1] == "0") ? "" : convertCharsToHTML(labels[1]);
+    res.update = (labels[2] == "1") ? "" : convertCharsToHTML(labels[2]);
+    return res;
+  }
+};
+} // end anonymous namespace
+
+bool UTAPTraceParser::readTraceFile(const std::string &file,
+                                    SymbolicTrace &trace) {
+  MappedFile content(file);
+  if (!content.isOpen()) {
+    TAPTENC_LOG_WARN("UTAPTraceParser readTraceFile: cannot open " << file);
+    return false;
+  }
+  TraceLexer lexer(content.begin(), content.end(), trace);
+  if (lexer.nextLine()) {
+    if (lexer.lineLength() > 5) {
+      if (lexer.lineStartsWith("State")) {
+        trace.states.push_back(lexer.parseState());
       }
     } else {
-      std::cout << "UTAPTraceParser parseTraceInfo: expected trace to begin "
-                   "with inital state, but read: "
-                << currentReadLine << std::endl;
+      TAPTENC_LOG_WARN("UTAPTraceParser parseTraceInfo: expected trace to "
+                       "begin with inital state, but read: "
+                       << lexer.line());
       return false;
     }
   } else {
-    std::cout << "UTAPTraceParser parseTraceInfo: trace not valid" << std::endl;
+    TAPTENC_LOG_WARN("UTAPTraceParser parseTraceInfo: trace not valid");
     return false;
   }
-  while (getline(fileStream, currentReadLine)) {
-    if (currentReadLine.size() > 10 &&
-        currentReadLine.substr(0, 10) == "Transition") {
-      parseTransition(currentReadLine);
-      getline(fileStream, currentReadLine);
-      if (currentReadLine != "") {
-        std::cout << "UTAPTraceParser parseTraceInfo: expected empty line "
-                     "after transition, but read: "
-                  << currentReadLine << std::endl;
+  while (lexer.nextLine()) {
+    if (lexer.lineLength() > 10 && lexer.lineStartsWith("Transition")) {
+      trace.transitions.push_back(lexer.parseTransition());
+      lexer.nextLine();
+      if (lexer.lineLength() != 0) {
+        TAPTENC_LOG_WARN("UTAPTraceParser parseTraceInfo: expected empty "
+                         "line after transition, but read: "
+                         << lexer.line());
         return false;
       }
-      if (getline(fileStream, currentReadLine)) {
-        if (currentReadLine.size() > 5) {
-          if (currentReadLine.substr(0, 5) == "State") {
-            parseState(currentReadLine);
+      if (lexer.nextLine()) {
+        if (lexer.lineLength() > 5) {
+          if (lexer.lineStartsWith("State")) {
+            trace.states.push_back(lexer.parseState());
           }
         } else {
-          std::cout << "UTAPTraceParser parseTraceInfo: expected state after "
-                       "transition, but read: "
-                    << currentReadLine << std::endl;
+          TAPTENC_LOG_WARN("UTAPTraceParser parseTraceInfo: expected state "
+                           "after transition, but read: " << lexer.line());
           return false;
         }
       }
+    }
+  }
+  return true;
+}
+
+bool UTAPTraceParser::loadTrace(const SymbolicTrace &trace) {
+  if (trace.states.size() != trace.transitions.size() + 1) {
+    TAPTENC_LOG_WARN("UTAPTraceParser loadTrace: trace not valid, got "
+                     << trace.states.size() << " states and "
+                     << trace.transitions.size() << " transitions");
+    return false;
+  }
+  // resolve the clocks of the trace once
+  std::vector<size_t> clock_map;
+  clock_map.reserve(trace.clocks.size());
+  for (const auto &cl : trace.clocks) {
+    auto index = clock_indices.find(cl);
+    if (cl.find(constants::ZERO_CLOCK) != string::npos) {
+      clock_map.push_back(0);
+    } else if (index != clock_indices.end()) {
+      clock_map.push_back(index->second);
     } else {
-      continue;
+      TAPTENC_LOG_WARN("UTAPTraceParser loadTrace: unknown clock " << cl);
+      clock_map.push_back(string::npos);
     }
   }
-  fileStream.close();
+  // guards of trace_ta are replaced, execution times need to be committed
+  // again
+  num_committed = 0;
+  loadState(trace.states.front(), clock_map);
+  for (size_t i = 0; i < trace.transitions.size(); i++) {
+    loadTransition(trace.transitions[i]);
+    loadState(trace.states[i + 1], clock_map);
+  }
   parsed = true;
   return true;
 }
 
+bool UTAPTraceParser::parseTraceInfo(const std::string &file) {
+  SymbolicTrace trace;
+  if (!readTraceFile(file, trace)) {
+    return false;
+  }
+  return loadTrace(trace);
+}
+
 UTAPTraceParser::UTAPTraceParser(const AutomataSystem &s)
     : trace_ta(Automaton({}, {}, "trace_ta", false)) {
   trace_ta.clocks.insert(s.globals.clocks.begin(), s.globals.clocks.end());
@@ -583,8 +1066,14 @@ UTAPTraceParser::UTAPTraceParser(const AutomataSystem &s)
                          ta.first.states.end());
     trace_ta.clocks.insert(ta.first.clocks.begin(), ta.first.clocks.end());
   }
+  clock_indices.insert(std::make_pair(constants::ZERO_CLOCK, 0));
   for (const auto &cl : trace_ta.clocks) {
     curr_clock_values.insert(std::make_pair(cl, std::make_pair(0, false)));
+    const std::string &id = cl->id.str();
+    auto ins = clock_indices.insert(std::make_pair(id, clock_indices.size()));
+    if (ins.second && id.find(constants::GLOBAL_CLOCK) != string::npos) {
+      global_clock_index = ins.first->second;
+    }
   }
 }
 } // end namespace taptenc
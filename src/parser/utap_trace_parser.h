@@ -8,11 +8,14 @@
 #include "../constraints/constraints.h"
 #include "../timed-automata/timed_automata.h"
 #include "../utils.h"
+#include "../verifier/dbm.h"
 #include <string>
 #include <ostream>
 #include <unordered_map>
+#include <vector>
 
 namespace taptenc {
+class Solver;
 /**
  * Constraint, where the first entry encodes the bound, the second entry
  * encodes the strictness (true = strict)
@@ -41,12 +44,54 @@ struct groundedActionTime {
 typedef groundedActionTime GroundedActionTime;
 
 /**
- * Different bounds representation, where [clock1,clock2] -> (i,true) means
- * clock1 - clock2 <= i.
+ * Single bound clock_i - clock_j (bound) of a zone, where clocks are
+ * referenced by their index in SymbolicTrace::clocks.
  */
-typedef ::std::unordered_map<::std::pair<::std::string, ::std::string>,
-                             dbm_entry_t>
-    dbm_t;
+struct zoneBound {
+  ::std::size_t i;
+  ::std::size_t j;
+  raw_t bound;
+};
+typedef struct zoneBound ZoneBound;
+
+/**
+ * Symbolic state of a trace, given by a location and the non-trivial bounds
+ * of its zone in canonical form.
+ */
+struct symbolicTraceState {
+  ::std::string state_id;
+  ::std::vector<ZoneBound> zone;
+};
+typedef struct symbolicTraceState SymbolicTraceState;
+
+/**
+ * Transition of a symbolic trace, labels are stored in their printed form
+ * (empty if the transition has no such label).
+ */
+struct symbolicTraceTransition {
+  ::std::string source_id;
+  ::std::string dest_id;
+  ::std::string guard;
+  ::std::string sync;
+  ::std::string update;
+};
+typedef struct symbolicTraceTransition SymbolicTraceTransition;
+
+/**
+ * Alternating sequence of symbolic states and transitions, starting and
+ * ending with a state. Hence there is always one more state than there are
+ * transitions.
+ */
+struct symbolicTrace {
+  /**
+   * Clock ids referenced by the zones, index 0 is the reference clock
+   * constants::ZERO_CLOCK.
+   */
+  ::std::vector<::std::string> clocks;
+  ::std::vector<SymbolicTraceState> states;
+  ::std::vector<SymbolicTraceTransition> transitions;
+};
+typedef struct symbolicTrace SymbolicTrace;
 
 /**
  * Stores a timed trace by holding time constraints and the actions that are
@@ -71,6 +116,24 @@ public:
    */
   bool parseTraceInfo(const ::std::string &file);
 
+  /**
+   * Loads a symbolic trace, e.g. one obtained by parsing a .trace file
+   * (see readTraceFile()) or from an in-process reachability check.
+   *
+   * @param trace symbolic trace of the automata system
+   * @return true iff the trace is valid
+   */
+  bool loadTrace(const SymbolicTrace &trace);
+
+  /**
+   * Reads a .trace file (output of uppaal) into a symbolic trace.
+   *
+   * @param file name of the file containing the trace
+   * @param trace symbolic trace to store the file content in
+   * @return true iff parsing was successful
+   */
+  static bool readTraceFile(const ::std::string &file, SymbolicTrace &trace);
+
   /**
    * Applies a delay to the concrete trace and calculates a new temporal trace
    * from it.
@@ -78,9 +141,47 @@ public:
    * @param delay_pos index of concrete state where the delay occured
    * @param delay delay duration (full duration of the visit in the state at
    *        position \a delay_pos)
+   * @param solver solver used to recompute the trace
+   */
+  timed_trace_t applyDelay(size_t delay_pos, timepoint delay, Solver &solver);
+
+  /**
+   * Applies a delay to the concrete trace without solving the trace TA again.
+   *
+   * The zones of the stored symbolic states from \a delay_pos onward are
+   * updated along the fixed sequence of trace transitions using DBM
+   * operations only. This requires all guards and invariants of the
+   * remaining trace to be conjunctions of clock (difference) bounds, which
+   * holds for traces of the direct encodings.
+   *
+   * @param delay_pos index of concrete state where the delay occured
+   * @param delay delay duration (full duration of the visit in the state at
+   *        position \a delay_pos)
+   * @return updated timed trace, the unchanged one if the delay can not be
+   *         applied
    */
   timed_trace_t applyDelay(size_t delay_pos, timepoint delay);
 
+  /**
+   * Applies a delay like applyDelay(size_t, timepoint), but only updates the
+   * stored timed trace (see getCurrentTimedTrace()) instead of returning a
+   * copy of it.
+   *
+   * Only the part of the trace from \a delay_pos onward is recomputed, hence
+   * the cost depends on the length of the remaining trace.
+   *
+   * @param delay_pos index of concrete state where the delay occured
+   * @param delay delay duration
+   * @return true iff the delay was applied
+   */
+  bool applyDelayInPlace(size_t delay_pos, timepoint delay);
+
+  /**
+   * Returns the timed trace as computed by the last call to getTimedTrace(),
+   * including all delays applied since.
+   */
+  const timed_trace_t &getCurrentTimedTrace() const { return parsed_trace; }
+
   /**
    * Extracts the timed trace after a trace has been parsed.
    *
@@ -97,16 +198,76 @@ private:
   std::unordered_map<std::string, std::string> trace_to_ta_ids;
   std::vector<State> source_states;
   std::unordered_map<::std::shared_ptr<Clock>, dbm_entry_t> curr_clock_values;
-  std::unordered_map<std::string, dbm_t> ta_to_symbolic_state;
+  std::unordered_map<std::string, DBM> ta_to_symbolic_state;
+  /** DBM index of each clock of trace_ta, constants::ZERO_CLOCK has index 0. */
+  std::unordered_map<std::string, std::size_t> clock_indices;
+  std::size_t global_clock_index = 0;
   timed_trace_t parsed_trace;
+  /** number of leading transitions of trace_ta with committed execution time */
+  size_t num_committed = 0;
+  /** result of the last getTraceTimings() call */
+  ::std::vector<SpecialClocksInfo> last_timings;
+  /** clock values of the fastest run in each state of the last timings */
+  ::std::vector<::std::vector<dbm_entry_t>> clock_values_at;
 
   /**
    * Calculates the fastest concrete trace timings from a parsed symbolic trace.
    *
+   * The timings of the states before \a first_changed_state are reused from
+   * the previous call, if there is one for the same trace.
+   *
+   * @param first_changed_state index of the first state of the trace whose
+   *        zone changed since the previous call, 0 recomputes everything
    * @return Timings of the concrete trace ordered according to the symbolic
    *         state orderings.
    */
-  ::std::vector<SpecialClocksInfo> getTraceTimings();
+  const ::std::vector<SpecialClocksInfo> &
+  getTraceTimings(size_t first_changed_state = 0);
+  /**
+   * Recomputes the groundings of parsed_trace from the stored zones.
+   *
+   * @param delay_pos first action of parsed_trace to update
+   * @param first_changed_state index of the first state whose zone changed
+   *        (see getTraceTimings())
+   */
+  void updateTimedTrace(size_t delay_pos, size_t first_changed_state);
+  /**
+   * Conjoins the execution times of the actions up to \a delay_pos to the
+   * guards of trace_ta, the action at \a delay_pos is delayed by \a delay.
+   * Actions committed by earlier calls are skipped.
+   *
+   * @return false iff trace_ta has no global clock
+   */
+  bool commitExecutionTimes(size_t delay_pos, timepoint delay);
+  /**
+   * Looks up the DBM index of a clock referenced in a trace.
+   *
+   * @param name clock name, possibly prefixed by its component
+   * @return index in clock_indices, ::std::string::npos if unknown
+   */
+  ::std::size_t clockIndexOf(const ::std::string &name) const;
+  /**
+   * Parses a printed guard (e.g. "x &gt;= 5 &amp;&amp; y - x &lt; 3") into
+   * atomic bounds over clock_indices.
+   *
+   * @return false iff the guard is no conjunction of clock (difference)
+   *         bounds
+   */
+  bool parseGuard(const ::std::string &guard,
+                  ::std::vector<ZoneBound> &res) const;
+  /**
+   * Translates a clock constraint to atomic bounds over clock_indices.
+   *
+   * @return false iff \a cc is no conjunction of clock (difference) bounds
+   */
+  bool toZoneBounds(const ClockConstraint &cc,
+                    ::std::vector<ZoneBound> &res) const;
+  /**
+   * Intersects a zone with atomic bounds.
+   *
+   * @return false iff the resulting zone is empty
+   */
+  static bool applyBounds(DBM &zone, const ::std::vector<ZoneBound> &bounds);
   /**
    * Retrieves all actions that are associated to a given trace transition.
    *
@@ -127,27 +288,41 @@ private:
    */
   ::std::string addStateToTraceTA(::std::string state_id);
 
+  /**
+   * Converts a zone of a loaded trace to a DBM over the clocks of trace_ta
+   * in O(n^2). The zone is expected to be canonical, as the ones printed by
+   * tracer and created by ZoneReachability.
+   *
+   * @param zone bounds of a symbolic state
+   * @param clock_map index in clock_indices for each clock of the trace
+   *                  (::std::string::npos for unknown clocks)
+   * @return DBM with the bounds of \a zone
+   */
+  DBM toDBM(const ::std::vector<ZoneBound> &zone,
+            const ::std::vector<::std::size_t> &clock_map) const;
+
   /**
    * Calculates bounds of the special clock counting global time from a DBM.
    *
-   * @param differences different bound matrix of a symbolic state
+   * @param zone canonical DBM of a symbolic state (see toDBM())
    * @return SpecialClockInfo holding bounds on global time and maximal delay
-   *          possible in the symbolic state described by \a differences
+   *          possible in the symbolic state described by \a zone
    */
-  SpecialClocksInfo determineSpecialClockBounds(dbm_t differences);
+  SpecialClocksInfo determineSpecialClockBounds(const DBM &zone) const;
 
   /**
-   * Parses a line from a .trace file (output of uppaal) containing a
-   * transition.
+   * Adds a transition of a symbolic trace to the trace TA.
    *
-   * @param currentReadLine line from a .trace file containing transition info
+   * @param trans transition of the symbolic trace
    */
-  void parseTransition(std::string &currentReadLine);
+  void loadTransition(const SymbolicTraceTransition &trans);
   /**
-   * Parses a line from a .trace file (output of uppaal) containing a state.
+   * Stores the zone of a symbolic trace state.
    *
-   * @param currentReadLine line from a .trace file containing state info
+   * @param state state of the symbolic trace
+   * @param clock_map index in clock_indices for each clock of the trace
    */
-  void parseState(std::string &currentReadLine);
+  void loadState(const SymbolicTraceState &state,
+                 const ::std::vector<::std::size_t> &clock_map);
 };
 } // end namespace taptenc
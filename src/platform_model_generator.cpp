@@ -11,6 +11,7 @@
 #include "utils.h"
 #include <algorithm>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <string>
 #include <time.h>
@@ -267,6 +268,56 @@ vector<unique_ptr<EncICInfo>> benchmarkgenerator::generatePerceptionConstraints(
   return activations;
 }
 
+vector<unique_ptr<EncICInfo>>
+benchmarkgenerator::generatePerceptionTypeConstraints(
+    const Automaton &perception_ta) {
+  vector<State> pic_filter({perception_ta.states[3]});
+  vector<State> icp_done_filter({perception_ta.states[5]});
+  vector<State> puck_sense_filter({perception_ta.states[6]});
+  vector<State> cam_off_filter(
+      {perception_ta.states[0], perception_ta.states[6]});
+  vector<State> cam_on_filter({perception_ta.states[1], perception_ta.states[2],
+                               perception_ta.states[3], perception_ta.states[4],
+                               perception_ta.states[5]});
+  Bounds full_bounds(0, numeric_limits<int>::max());
+  Bounds icp_bounds(5, 15);
+  Bounds recent_bounds(0, 20);
+  vector<ActionName> goto_start({ActionName(
+      "startgoto", {std::string() + constants::VAR_PREFIX + "m",
+                    std::string() + constants::VAR_PREFIX + "n"})});
+  vector<ActionName> goto_end({ActionName(
+      "endgoto", {std::string() + constants::VAR_PREFIX + "m",
+                  std::string() + constants::VAR_PREFIX + "n"})});
+  vector<ActionName> pick_start({ActionName(
+      "startpick", {std::string() + constants::VAR_PREFIX + "o",
+                    std::string() + constants::VAR_PREFIX + "m"})});
+  vector<ActionName> put_start({ActionName(
+      "startput", {std::string() + constants::VAR_PREFIX + "o",
+                   std::string() + constants::VAR_PREFIX + "m"})});
+  vector<unique_ptr<EncICInfo>> activations;
+  // camera is off (or only checks for pucks) when arriving at a machine
+  activations.emplace_back(make_unique<UnaryInfo>(
+      "cam_off_n", ICType::NoOp, goto_end,
+      TargetSpecs(full_bounds, cam_off_filter)));
+  // camera stays off while driving
+  activations.emplace_back(make_unique<UnaryInfo>(
+      "cam_off_i", ICType::Invariant, goto_start,
+      TargetSpecs(full_bounds, cam_off_filter)));
+  // a picture was taken before putting a product
+  activations.emplace_back(make_unique<UnaryInfo>(
+      "pic_p", ICType::Past, put_start,
+      TargetSpecs(full_bounds, pic_filter)));
+  // keep the camera running until icp finishes
+  activations.emplace_back(make_unique<BinaryInfo>(
+      "icp_u", ICType::Until, pick_start,
+      TargetSpecs(icp_bounds, icp_done_filter), cam_on_filter));
+  // the puck was sensed recently and the camera stayed on since
+  activations.emplace_back(make_unique<BinaryInfo>(
+      "sense_s", ICType::Since, pick_start,
+      TargetSpecs(recent_bounds, puck_sense_filter), perception_ta.states));
+  return activations;
+}
+
 vector<unique_ptr<EncICInfo>>
 benchmarkgenerator::generateCommConstraints(const Automaton &comm_ta,
                                             ::std::string machine) {
@@ -426,3 +477,294 @@ benchmarkgenerator::generatePositionConstraints(const Automaton &pos_ta) {
     return pos_constraints;
   }
 }
+
+namespace {
+/**
+ * Translates the number encoding of a machine used by generatePlan() to its
+ * name.
+ *
+ * @param i machine number
+ * @return machine name
+ */
+std::string idToMachineStr(int i) {
+  if (i == -1)
+    return "start";
+  if (i == 0)
+    return "bs";
+  if (i == 1)
+    return "cs1";
+  if (i == 2)
+    return "cs2";
+  if (i == 3)
+    return "rs1";
+  if (i == 4)
+    return "rs2";
+  if (i == 5)
+    return "ds";
+  return "nomachine";
+}
+
+/**
+ * Adds two bounds, the resulting bound is strict if the summands differ.
+ *
+ * @param a first summand
+ * @param b second summand
+ * @return sum of \a a and \a b
+ */
+Bounds addBounds(const Bounds &a, const Bounds &b) {
+  return Bounds(safeAddition(a.lower_bound, b.lower_bound),
+                safeAddition(a.upper_bound, b.upper_bound),
+                a.l_op == b.l_op ? a.l_op : ComparisonOp::LT,
+                a.r_op == b.r_op ? a.r_op : ComparisonOp::LT);
+}
+
+/**
+ * Appends the start and end actions of a grasping action to a plan.
+ *
+ * @param plan plan to extend
+ * @param grasp name of the grasping action
+ * @param obj object that is grasped
+ * @param m machine number at which the grasping happens
+ * @param abs_bounds absolute time bounds of the grasping action
+ * @return absolute time bounds after the grasping action
+ */
+Bounds addGrasp(::std::vector<PlanAction> &plan, std::string grasp,
+                std::string obj, int m, const bounds abs_bounds) {
+  Bounds grasp_bounds(15, 20);
+  Bounds end_bounds(0, 30);
+  Bounds res_abs_bounds = abs_bounds;
+  plan.push_back(
+      PlanAction(ActionName("start" + grasp, {obj, idToMachineStr(m)}),
+                 res_abs_bounds, grasp_bounds));
+  res_abs_bounds = addBounds(res_abs_bounds, grasp_bounds);
+  plan.push_back(PlanAction(ActionName("end" + grasp, {obj, idToMachineStr(m)}),
+                            res_abs_bounds, end_bounds));
+  res_abs_bounds = addBounds(res_abs_bounds, end_bounds);
+  return res_abs_bounds;
+}
+
+/**
+ * Appends the start and end actions of a move action to a plan.
+ *
+ * Nothing is appended if the robot is already at its destination.
+ *
+ * @param plan plan to extend
+ * @param curr_pos current machine number
+ * @param dest_pos destination machine number
+ * @param abs_bounds absolute time bounds of the move action
+ * @return absolute time bounds after the move action
+ */
+Bounds addGoto(::std::vector<PlanAction> &plan, int curr_pos, int dest_pos,
+               const bounds abs_bounds) {
+  Bounds goto_bounds(30, 45);
+  Bounds end_bounds(0, 30);
+  Bounds res_abs_bounds = abs_bounds;
+  // std::cout << res_abs_bounds.lower_bound << "," <<
+  // res_abs_bounds.upper_bound
+  //           << std::endl;
+  if (curr_pos != dest_pos) {
+    plan.push_back(
+        PlanAction(ActionName("startgoto", {idToMachineStr(curr_pos),
+                                            idToMachineStr(dest_pos)}),
+                   res_abs_bounds, goto_bounds));
+    res_abs_bounds = addBounds(res_abs_bounds, goto_bounds);
+    // std::cout << res_abs_bounds.lower_bound << "," <<
+    // res_abs_bounds.upper_bound
+    //           << std::endl;
+    plan.push_back(PlanAction(ActionName("endgoto", {idToMachineStr(curr_pos),
+                                                     idToMachineStr(dest_pos)}),
+                              res_abs_bounds, end_bounds));
+    res_abs_bounds = addBounds(res_abs_bounds, end_bounds);
+    // std::cout << res_abs_bounds.lower_bound << "," <<
+    // res_abs_bounds.upper_bound
+    //           << std::endl;
+  }
+  return res_abs_bounds;
+}
+} // end anonymous namespace
+
+::std::vector<PlanAction>
+benchmarkgenerator::generatePlan(long unsigned int plan_length) {
+  // std::cout << "enter plan gen " << std::endl;
+  Bounds instant_bounds(0, 0);
+  Bounds no_bounds(0, numeric_limits<int>::max());
+  Bounds goto_bounds(30, 45);
+  Bounds grasp_bounds(15, 20);
+  Bounds end_bounds(0, 30);
+  /*
+   * Encode MPS via numbers:
+   *  - -1  = START
+   *  - 0   = BS
+   *  - 1,2 = CS
+   *  - 3,4 = RS
+   *  - 5   = DS
+   *
+   */
+  ::std::vector<PlanAction> plan;
+  Bounds abs_bounds(0, 30);
+  plan.push_back(PlanAction(ActionName("startplan", {"arg0", "arg1"}),
+                            abs_bounds, instant_bounds));
+  int cc_count = 0;
+  int tr_count = 0;
+  int wp_count = 0;
+  int curr_pos = -1;
+  for (int k = 0; k < 10; k++) {
+    if (plan.size() > plan_length) {
+      break;
+    }
+    int cs = rand() % 2 + 1;
+    int ds = 5;
+    int num_rings = rand() % 4;
+    // std::cout << "cs: " << cs << " num_rings: " << num_rings << std::endl;
+    std::vector<int> rs_ring_count(5, 0);
+    std::vector<int> req_rs;
+    std::vector<int> req_pay;
+    for (int i = 1; i <= num_rings; i++) {
+      req_rs.push_back(rand() % 2 + 3);
+      req_pay.push_back(rand() % 3);
+      // std::cout << "ring " << i << " req " << *(req_pay.end() - 1) << " from
+      // "
+      //           << *(req_rs.end() - 1) << std::endl;
+    }
+    int curr_step = 0;
+    int req_steps = num_rings + 2;
+    bool cs_buffered = false;
+    std::vector<bool> occupied(6, false);
+    bool abort = false;
+    bool full_game = false;
+    while (curr_step != req_steps) {
+      if (plan.size() > plan_length) {
+        break;
+      }
+      // if (abs_bounds.lower_bound > 1200) {
+      //   full_game = true;
+      //   break;
+      // }
+      int op_cs = rand() % 2;
+      if ((!(cs_buffered && !occupied[cs])) &&
+          (op_cs == 1 || curr_step == num_rings)) {
+        if (cs_buffered) {
+          int feed_rs = rand() % 2 + 3;
+          rs_ring_count[feed_rs]++;
+          if (rs_ring_count[feed_rs] == 4) {
+            abort = true;
+            break;
+          }
+          // feed cc
+          abs_bounds = addGoto(plan, curr_pos, cs, abs_bounds);
+          abs_bounds = addGrasp(plan, "pick", "cc" + std::to_string(cc_count),
+                                cs, abs_bounds);
+          abs_bounds = addGoto(plan, cs, feed_rs, abs_bounds);
+          abs_bounds = addGrasp(plan, "pay", "cc" + std::to_string(cc_count),
+                                feed_rs, abs_bounds);
+          // std::cout << "feed cc to " << feed_rs << " from " << curr_pos
+          //           << " to " << feed_rs << std::endl;
+          curr_pos = feed_rs;
+          occupied[cs] = false;
+          cc_count++;
+        } else {
+          cs_buffered = true;
+          occupied[cs] = true;
+          abs_bounds = addGoto(plan, curr_pos, cs, abs_bounds);
+          abs_bounds =
+              addGrasp(plan, "getshelf", "cc" + std::to_string(cc_count), cs,
+                       abs_bounds);
+          abs_bounds = addGrasp(plan, "put", "cc" + std::to_string(cc_count),
+                                cs, abs_bounds);
+          // buffer cap
+          // std::cout << "buffer cap" << std::endl;
+          curr_pos = cs;
+        }
+      }
+      if (op_cs == 1) {
+        // std::cout << "hat" << std::endl;
+        continue;
+      }
+      if (op_cs == 0 && curr_step < num_rings) {
+        if (req_pay[curr_step] <= rs_ring_count[req_rs[curr_step]]) {
+          rs_ring_count[req_rs[curr_step]] -= req_pay[curr_step];
+          // mount ring
+          int prev = -1;
+          if (curr_step > 0) {
+            prev = req_rs[curr_step - 1];
+          }
+          abs_bounds = addGoto(plan, curr_pos, prev, abs_bounds);
+          abs_bounds = addGrasp(plan, "pick", "wp" + std::to_string(wp_count),
+                                prev, abs_bounds);
+          abs_bounds = addGoto(plan, prev, req_rs[curr_step], abs_bounds);
+          abs_bounds = addGrasp(plan, "put", "wp" + std::to_string(wp_count),
+                                req_rs[curr_step], abs_bounds);
+          // std::cout << "mount ring on " << req_rs[curr_step] << std::endl;
+          curr_pos = req_rs[curr_step];
+          curr_step++;
+        } else {
+          int source_mat = rand() % 3;
+          // get material
+          std::string get = "pick";
+          if (source_mat > 0) {
+            get = "getshelf";
+          }
+          abs_bounds = addGoto(plan, curr_pos, source_mat, abs_bounds);
+          abs_bounds = addGrasp(plan, get, "tr" + std::to_string(tr_count),
+                                source_mat, abs_bounds);
+          abs_bounds = addGoto(plan, source_mat, req_rs[curr_step], abs_bounds);
+          abs_bounds = addGrasp(plan, "pay", "tr" + std::to_string(tr_count),
+                                req_rs[curr_step], abs_bounds);
+          tr_count++;
+          curr_pos = source_mat;
+          rs_ring_count[req_rs[curr_step]]++;
+          // std::cout << "get material from " << source_mat << " to feed in "
+          //           << req_rs[curr_step] << std::endl;
+        }
+      }
+      if (curr_step == num_rings && cs_buffered && !occupied[cs]) {
+        // std::cout << "finalize product" << curr_step << std::endl;
+        int source = 0;
+        if (curr_step > 0) {
+          source = req_rs[curr_step - 1];
+        }
+        abs_bounds = addGoto(plan, curr_pos, source, abs_bounds);
+        abs_bounds = addGrasp(plan, "pick", "wp" + std::to_string(wp_count),
+                              source, abs_bounds);
+        abs_bounds = addGoto(plan, source, cs, abs_bounds);
+        abs_bounds = addGrasp(plan, "put", "wp" + std::to_string(wp_count), cs,
+                              abs_bounds);
+        abs_bounds = addGrasp(plan, "pick", "wp" + std::to_string(wp_count), cs,
+                              abs_bounds);
+        abs_bounds = addGoto(plan, cs, ds, abs_bounds);
+        abs_bounds = addGrasp(plan, "put", "wp" + std::to_string(wp_count), ds,
+                              abs_bounds);
+        curr_pos = ds;
+        // std::cout << "finalize product done" << std::endl;
+        // finalize
+        curr_step++;
+        curr_step++;
+      }
+    }
+    if (abort) {
+      // std::cout << "aborted" << std::endl;
+      return generatePlan(plan_length);
+    }
+    if (full_game) {
+      // std::cout << "full_game" << std::endl;
+      break;
+    }
+    wp_count++;
+  }
+  while (plan.size() >= plan_length) {
+    plan.pop_back();
+  }
+  plan.push_back(PlanAction(ActionName("endplan", {"arg0", "arg1"}), abs_bounds,
+                            instant_bounds));
+  // for (auto &p : plan) {
+  //   std::cout << p.name.toString() << " "
+  //             << computils::toString(p.absolute_time.l_op)
+  //             << p.absolute_time.lower_bound << ","
+  //             << p.absolute_time.upper_bound
+  //             << computils::toString(p.absolute_time.r_op);
+  //   std::cout << " " << computils::toString(p.duration.l_op)
+  //             << p.duration.lower_bound << "," << p.duration.upper_bound
+  //             << computils::toString(p.duration.r_op) << std::endl;
+  // }
+  return plan;
+}
@@ -3,6 +3,7 @@
  *
  * \author (2019) Tarik Viehmann
  */
+#include "constraints/constraints.h"
 #include "encoder/enc_interconnection_info.h"
 #include "timed-automata/timed_automata.h"
 #include <memory>
@@ -56,6 +57,17 @@ Automaton generateCommTA(::std::string machine);
 ::std::vector<::std::unique_ptr<EncICInfo>>
 generatePerceptionConstraints(const Automaton &perception_ta);
 
+/**
+ * Generates one constraint of each type not used by
+ * generatePerceptionConstraints() (NoOp, Past, Invariant, Until and Since)
+ * for the perception TA, such that the encodings of all constraint types can
+ * be benchmarked.
+ *
+ * @param perception_ta automaton that models the camera, icp and puck check
+ * @return constraint activation mapping for the perception TA
+ */
+::std::vector<::std::unique_ptr<EncICInfo>>
+generatePerceptionTypeConstraints(const Automaton &perception_ta);
 /**
  * Generates constraints for the communication TA (see generateCommTA()).
  *
@@ -86,5 +98,17 @@ generateCalibrationConstraints(const Automaton &calib_ta);
  */
 ::std::vector<::std::unique_ptr<EncICInfo>>
 generatePositionConstraints(const Automaton &pos_ta);
+
+/**
+ * Generates a random plan of the RCLL domain.
+ *
+ * The plan consists of grasping and moving actions to produce random
+ * products, enclosed by a start and an end action. Uses rand(), seed it via
+ * srand() to obtain reproducible plans.
+ *
+ * @param plan_length maximal number of plan actions
+ * @return plan with absolute time bounds and durations
+ */
+::std::vector<PlanAction> generatePlan(long unsigned int plan_length);
 } // end namespace benchmarkgenerator
 } // end namespace taptenc
@@ -8,6 +8,7 @@
 #include "../timed-automata/timed_automata.h"
 #include "../timed-automata/vis_info.h"
 #include "../utils.h"
+#include <ostream>
 #include <string>
 #include <vector>
 
@@ -34,10 +35,24 @@ public:
    */
   virtual void print(const AutomataSystem &s, SystemVisInfo &s_vis_info,
                      ::std::string filename) = 0;
+  /**
+   * Prints an automata system to a file without any layout information.
+   *
+   * Use this if the file is not meant to be displayed, e.g. if it is only
+   * passed to a solver. This avoids the computation of SystemVisInfo.
+   *
+   * @param s automata system to print
+   * @param filename name of the resulting file including file extension
+   */
+  virtual void print(const AutomataSystem &s, ::std::string filename) = 0;
 };
 /**
  * xml printer to produce xml files compatible with uppaal 4.0 syntax.
  *
+ * The output is streamed directly to the destination without assembling
+ * intermediate strings. Layout coordinates are optional in uppaal's xml
+ * format, hence they can be omitted if the output is only fed to a solver.
+ *
  * See also #taptenc::xmlprinterutils for used helper functions.
  */
 class XMLPrinter : Printer {
@@ -48,6 +63,32 @@ public:
    */
   void print(const AutomataSystem &s, SystemVisInfo &s_vis_info,
              ::std::string filename);
+  /**
+   * Prints an automata system in xml format compatible with uppaal 4.0 syntax
+   * to an output stream.
+   *
+   * @param s automata system to print
+   * @param s_vis_info visualization information for \a s
+   * @param out stream to write to (e.g. a file, a pipe or a memory buffer)
+   */
+  void print(const AutomataSystem &s, SystemVisInfo &s_vis_info,
+             ::std::ostream &out);
+  /**
+   * Prints an automata system to a xml file compatible with uppaal 4.0 syntax
+   * without any layout coordinates.
+   *
+   * @param s automata system to print
+   * @param filename name of the resulting file including file extension
+   */
+  void print(const AutomataSystem &s, ::std::string filename);
+  /**
+   * Prints an automata system in xml format compatible with uppaal 4.0 syntax
+   * to an output stream without any layout coordinates.
+   *
+   * @param s automata system to print
+   * @param out stream to write to (e.g. a file, a pipe or a memory buffer)
+   */
+  void print(const AutomataSystem &s, ::std::ostream &out);
 };
 
 /**
@@ -61,11 +102,18 @@ public:
    * Prints an automata system to a xta file compatible with uppaal 3.0 syntax.
    *
    * Does NOT print an associated ugi file containing display information,
-   * because this is not supported yet.
+   * because this is not supported yet, hence \a s_vis_info is ignored.
    *
    *  \copydetails Printer::print()
    */
   void print(const AutomataSystem &s, SystemVisInfo &s_vis_info,
              ::std::string filename);
+  /**
+   * Prints an automata system to a xta file compatible with uppaal 3.0 syntax.
+   *
+   * @param s automata system to print
+   * @param filename name of the resulting file including file extension
+   */
+  void print(const AutomataSystem &s, ::std::string filename);
 };
 } // end namespace taptenc
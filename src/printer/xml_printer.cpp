@@ -11,7 +11,6 @@
 #include "printer.h"
 #include <fstream>
 #include <iostream>
-#include <sstream>
 #include <string>
 #include <vector>
 
@@ -35,191 +34,207 @@ constexpr char XML_HEADER[]{
     "\n<nta>"};
 
 /**
- * Creates an xml formatted string (according to uppaal 4.0 syntax) that
- * holds information of a state.
+ * Size of the buffer used when writing xml files.
  *
+ * Encodings easily consist of several megabytes of xml, a larger buffer
+ * reduces the number of write calls.
+ */
+constexpr std::size_t XML_FILE_BUFFER_SIZE = 1 << 16;
+
+/**
+ * Writes the coordinate attributes of an xml element.
+ *
+ * @param out stream to write to
+ * @param pos x and y position, nothing is written if \a pos is nullptr
+ * @param y_offset offset added to the y coordinate
+ */
+void printXMLpos(std::ostream &out, const std::pair<int, int> *pos,
+                 int y_offset = 0) {
+  if (pos != nullptr) {
+    out << " x=\"" << pos->first << "\" y=\"" << pos->second + y_offset
+        << "\"";
+  }
+}
+
+/**
+ * Writes xml formatted information (according to uppaal 4.0 syntax) of a
+ * state.
+ *
+ * @param out stream to write to
  * @param s state to xml format
- * @param pos x and y position of \a s
- * @return xml formatted string of \a s accoding to uppaal 4.0 xml format
+ * @param pos x and y position of \a s, nullptr to omit all coordinates
  */
-std::string toString(const State &s, const std::pair<int, int> &pos) {
-  std::stringstream res;
-  res << "<location id=\"" << s.id << "\" x=\"" << pos.first << "\" y=\""
-      << pos.second << "\">";
+void printXMLstate(std::ostream &out, const State &s,
+                   const std::pair<int, int> *pos) {
+  out << "<location id=\"" << s.id << "\"";
+  printXMLpos(out, pos);
+  out << ">";
   if (s.id != "") {
-    res << "<name x=\"" << pos.first << "\" y=\"" << pos.second - 20 << "\">"
-        << s.id << "</name>";
+    out << "<name";
+    printXMLpos(out, pos, -20);
+    out << ">" << s.id << "</name>";
   }
   if (s.inv.get()->type != CCType::TRUE) {
-    res << "<label kind=\"invariant\" x=\"" << pos.first << "\" y=\""
-        << pos.second + 10 << "\">" << s.inv.get()->toString() << "</label>";
+    out << "<label kind=\"invariant\"";
+    printXMLpos(out, pos, 10);
+    out << ">" << s.inv.get()->toString() << "</label>";
   }
   if (s.urgent) {
-    res << "<urgent/>" << std::endl;
+    out << "<urgent/>\n";
   }
-  res << "</location>";
-  return res.str();
+  out << "</location>\n";
 }
 
 /*
- * Creates an xml formatted string (according to uppaal 4.0 syntax) that holds
- * information of a transition.
+ * Writes xml formatted information (according to uppaal 4.0 syntax) of a
+ * transition.
  *
+ * @param out stream to write to
  * @param t transition to xml format
  * @param v vector of nails, needs to contain at least one position in order to
- *          encode the label positions
- * @return xml formatted string of \a s accoding to uppaal 4.0 xml format
- * OR empty string, if \a v is empty
+ *          encode the label positions, nullptr to omit all coordinates
  */
-std::string toString(const Transition &t,
-                     const std::vector<std::pair<int, int>> &v) {
-  std::stringstream res;
-  if (v.size() == 0) {
+void printXMLtransition(std::ostream &out, const Transition &t,
+                        const std::vector<std::pair<int, int>> *v) {
+  if (v != nullptr && v->size() == 0) {
     std::cout
-        << "XMLPrinter toString(Transition): unexpected empty std::vector, "
+        << "XMLPrinter printXMLtransition: unexpected empty std::vector, "
            "mid_point missing!"
         << std::endl;
-    return "";
+    return;
   }
-  res << "<transition>";
-  res << "<source ref=\"" << t.source_id << "\"/>";
-  res << "<target ref=\"" << t.dest_id << "\"/>";
-  if (t.sync != "" && t.passive)
-    res << "<label kind=\"synchronisation\" x=\"" << v[0].first << "\" y=\""
-        << v[0].second + 10 << "\">" << t.sync << "?"
-        << "</label>" << std::endl;
-  if (t.sync != "" && t.passive == false)
-    res << "<label kind=\"synchronisation\" x=\"" << v[0].first << "\" y=\""
-        << v[0].second + 10 << "\">" << t.sync << "!"
-        << "</label>" << std::endl;
-  if (t.guard.get()->type != CCType::TRUE)
-    res << "<label kind=\"guard\" x=\"" << v[0].first << "\" y=\""
-        << v[0].second - 20 << "\">" << t.guard.get()->toString() << "</label>"
-        << std::endl;
-  if (t.update.size() > 0)
-    res << "<label kind=\"assignment\" x=\"" << v[0].first << "\" y=\""
-        << v[0].second - 40 << "\">" << t.updateToString() << "</label>"
-        << std::endl;
-  if (v.size() > 0) {
-    for (auto it = v.begin() + 1; it != v.end(); ++it) {
-      res << "<nail x=\"" << it->first << "\" y=\"" << it->second << "\"/>"
-          << std::endl;
+  const std::pair<int, int> *mid_point = v == nullptr ? nullptr : &(*v)[0];
+  out << "<transition>";
+  out << "<source ref=\"" << t.source_id << "\"/>";
+  out << "<target ref=\"" << t.dest_id << "\"/>";
+  if (t.sync != "") {
+    out << "<label kind=\"synchronisation\"";
+    printXMLpos(out, mid_point, 10);
+    out << ">" << t.sync << (t.passive ? "?" : "!") << "</label>\n";
+  }
+  if (t.guard.get()->type != CCType::TRUE) {
+    out << "<label kind=\"guard\"";
+    printXMLpos(out, mid_point, -20);
+    out << ">" << t.guard.get()->toString() << "</label>\n";
+  }
+  if (t.update.size() > 0) {
+    out << "<label kind=\"assignment\"";
+    printXMLpos(out, mid_point, -40);
+    out << ">" << t.updateToString() << "</label>\n";
+  }
+  if (v != nullptr) {
+    for (auto it = v->begin() + 1; it != v->end(); ++it) {
+      out << "<nail";
+      printXMLpos(out, &(*it));
+      out << "/>\n";
     }
   }
-  res << "</transition>" << std::endl;
-  return res.str();
+  out << "</transition>\n";
 }
 
 /**
- * Appends the global definitions formatted according to uppaal 4.0 xml syntax
- * to a file.
+ * Writes the global definitions formatted according to uppaal 4.0 xml syntax.
  *
  * Also  opens the nta tag which has to be closed later by printXMLend()
  *
+ * @param out stream to write to
  * @param g global automata system variables
- * @param filename name of file to append the formatted info
  */
-void printXMLstart(const AutomataGlobals &g, std::string filename) {
-  std::ofstream myfile;
-  myfile.open(filename);
-  myfile << XML_HEADER;
-  myfile << "<declaration>";
+void printXMLstart(std::ostream &out, const AutomataGlobals &g) {
+  out << XML_HEADER;
+  out << "<declaration>";
   if (g.clocks.size() > 0) {
-    myfile << "clock ";
+    out << "clock ";
     for (auto it = g.clocks.begin(); it != g.clocks.end(); ++it) {
       if (it != g.clocks.begin()) {
-        myfile << ", ";
+        out << ", ";
       }
-      myfile << it->get()->id;
+      out << it->get()->id;
     }
-    myfile << "; " << std::endl;
+    out << "; \n";
   }
   bool empty = true;
   for (auto it = g.channels.begin(); it != g.channels.end(); ++it) {
     if (it->type == ChanType::Broadcast) {
       if (empty == false) {
-        myfile << ", ";
+        out << ", ";
       }
       if (empty == true) {
-        myfile << "broadcast chan ";
+        out << "broadcast chan ";
       }
-      myfile << it->name;
+      out << it->name;
       empty = false;
     }
   }
   if (empty == false) {
-    myfile << "; " << std::endl;
+    out << "; \n";
   }
   empty = true;
   for (auto it = g.channels.begin(); it != g.channels.end(); ++it) {
     if (it->type == ChanType::Binary) {
       if (empty == false) {
-        myfile << ", ";
+        out << ", ";
       }
       if (empty == true) {
-        myfile << "chan ";
+        out << "chan ";
       }
-      myfile << it->name;
+      out << it->name;
       empty = false;
     }
   }
   if (empty == false) {
-    myfile << "; " << std::endl;
+    out << "; \n";
   }
-  myfile << "</declaration>" << std::endl;
-  myfile.close();
+  out << "</declaration>\n";
 }
 
 /**
- * Appends a closing nta tag to a file.
+ * Writes a closing nta tag.
  *
  * Use when all templates are written. Closes the nta tag contained in
  * #XML_HEADER that is written by printXMLstart().
  *
- * @param filename name of file to append the formatted info
+ * @param out stream to write to
  */
-void printXMLend(std::string filename) {
-  std::ofstream myfile;
-  myfile.open(filename, std::ios_base::app);
-  myfile << "</nta>" << std::endl;
-  myfile.close();
-}
+void printXMLend(std::ostream &out) { out << "</nta>" << std::endl; }
 
 /**
- * Appends a xml encoded automaton template to a file.
+ * Writes a xml encoded automaton template.
  *
  * Currently templates are not really supported, because of the modeling of
  * AutomataSystem::instances.
  *
+ * @param out stream to write to
  * @param s Automata System that contains the template in questiom
- * @param s_vis_info visual information associated with \a s
+ * @param s_vis_info visual information associated with \a s, nullptr to omit
+ *        all coordinates
  * @param index template index in AutomataSystem::instances of \a s
- * @param filename name of file to append the formatted template
  */
-void printXMLtemplate(const AutomataSystem &s, SystemVisInfo &s_vis_info,
-                      int index, std::string filename) {
-  std::ofstream myfile;
-  myfile.open(filename, std::ios_base::app);
-  myfile << "<template>";
-  myfile << "<name x=\"0\" y=\"0\">" << s.instances[index].first.prefix
-         << "</name>" << std::endl;
-  myfile << "<declaration>" << std::endl;
+void printXMLtemplate(std::ostream &out, const AutomataSystem &s,
+                      SystemVisInfo *s_vis_info, int index) {
+  out << "<template>";
+  out << "<name" << (s_vis_info != nullptr ? " x=\"0\" y=\"0\"" : "") << ">"
+      << s.instances[index].first.prefix << "</name>\n";
+  out << "<declaration>\n";
   for (auto toplevelit = s.instances[index].first.clocks.begin();
        toplevelit != s.instances[index].first.clocks.end(); ++toplevelit) {
-    myfile << "clock " << toplevelit->get()->id << ";" << std::endl;
+    out << "clock " << toplevelit->get()->id << ";\n";
   }
   for (auto toplevelit = s.instances[index].first.bool_vars.begin();
        toplevelit != s.instances[index].first.bool_vars.end(); ++toplevelit) {
-    myfile << "bool " << *toplevelit << " = false;" << std::endl;
+    out << "bool " << *toplevelit << " = false;\n";
   }
-  myfile << "</declaration>" << std::endl;
+  out << "</declaration>\n";
   bool initial_state_set = false;
   std::string init_id;
   for (auto toplevelit = s.instances[index].first.states.begin();
        toplevelit != s.instances[index].first.states.end(); ++toplevelit) {
-    myfile << toString(*toplevelit,
-                       s_vis_info.getStatePos(index, toplevelit->id))
-           << std::endl;
+    if (s_vis_info != nullptr) {
+      std::pair<int, int> pos = s_vis_info->getStatePos(index, toplevelit->id);
+      printXMLstate(out, *toplevelit, &pos);
+    } else {
+      printXMLstate(out, *toplevelit, nullptr);
+    }
     if (initial_state_set == false && toplevelit->initial == true) {
       init_id = toplevelit->id;
       initial_state_set = true;
@@ -232,47 +247,91 @@ void printXMLtemplate(const AutomataSystem &s, SystemVisInfo &s_vis_info,
     init_id = s.instances[index].first.states.begin()->id;
     initial_state_set = true;
   }
-  myfile << "<init ref=\"" << init_id << "\"/>";
+  out << "<init ref=\"" << init_id << "\"/>";
   for (auto toplevelit = s.instances[index].first.transitions.begin();
        toplevelit != s.instances[index].first.transitions.end(); ++toplevelit) {
-    myfile << toString(*toplevelit,
-                       s_vis_info.getTransitionPos(index, toplevelit->source_id,
-                                                   toplevelit->dest_id))
-           << std::endl;
+    if (s_vis_info != nullptr) {
+      std::vector<std::pair<int, int>> nails = s_vis_info->getTransitionPos(
+          index, toplevelit->source_id, toplevelit->dest_id);
+      printXMLtransition(out, *toplevelit, &nails);
+    } else {
+      printXMLtransition(out, *toplevelit, nullptr);
+    }
+    out << "\n";
   }
-  myfile << "</template>" << std::endl;
-  myfile.close();
+  out << "</template>\n";
 }
 
 /**
- * Appends xml encoding of a system declaration to file.
+ * Writes the xml encoding of a system declaration.
  *
  * Currently a non-empty parameter list of an entry in \a instances requires
  * the associated automaton to already contain the assigned parameter values.
  *
+ * @param out stream to write to
  * @param instances instances consisting of an automaton and a string
  *        containing the parameter list.
- * @param filename name of file to append the formatted system definition
  */
 void printXMLsystem(
-    const std::vector<std::pair<Automaton, std::string>> &instances,
-    std::string filename) {
-  std::ofstream myfile;
-  myfile.open(filename, std::ios_base::app);
-  myfile << "<system>" << std::endl;
-  std::string system = "system ";
+    std::ostream &out,
+    const std::vector<std::pair<Automaton, std::string>> &instances) {
+  out << "<system>\n";
+  for (auto toplevelit = instances.begin(); toplevelit != instances.end();
+       ++toplevelit) {
+    out << "sys_" << toplevelit->first.prefix << " = "
+        << toplevelit->first.prefix << "(" << toplevelit->second << ");\n";
+  }
+  out << "system ";
   for (auto toplevelit = instances.begin(); toplevelit != instances.end();
        ++toplevelit) {
     if (toplevelit != instances.begin()) {
-      system += ", ";
+      out << ", ";
     }
-    std::string component = "sys_" + toplevelit->first.prefix;
-    myfile << component << " = " << toplevelit->first.prefix << "("
-           << toplevelit->second << ");" << std::endl;
-    system += component;
+    out << "sys_" << toplevelit->first.prefix;
   }
-  myfile << system << ";" << std::endl;
-  myfile << "</system>" << std::endl;
+  out << ";\n";
+  out << "</system>\n";
+}
+
+/**
+ * Writes a whole automata system.
+ *
+ * @param out stream to write to
+ * @param s automata system to print
+ * @param s_vis_info visual information associated with \a s, nullptr to omit
+ *        all coordinates
+ */
+void printXML(std::ostream &out, const AutomataSystem &s,
+              SystemVisInfo *s_vis_info) {
+  printXMLstart(out, s.globals);
+  for (auto it = s.instances.begin(); it != s.instances.end(); ++it) {
+    printXMLtemplate(out, s, s_vis_info, it - s.instances.begin());
+  }
+  printXMLsystem(out, s.instances);
+  printXMLend(out);
+}
+
+/**
+ * Opens a file with an enlarged buffer and writes a whole automata system.
+ *
+ * @param filename name of the resulting file
+ * @param s automata system to print
+ * @param s_vis_info visual information associated with \a s, nullptr to omit
+ *        all coordinates
+ */
+void printXML(const std::string &filename, const AutomataSystem &s,
+              SystemVisInfo *s_vis_info) {
+  std::vector<char> buffer(XML_FILE_BUFFER_SIZE);
+  std::ofstream myfile;
+  // has to be set before opening the file to take effect
+  myfile.rdbuf()->pubsetbuf(buffer.data(), buffer.size());
+  myfile.open(filename, std::ios_base::trunc);
+  if (!myfile.is_open()) {
+    std::cout << "XMLPrinter print: could not open file " << filename
+              << std::endl;
+    return;
+  }
+  printXML(myfile, s, s_vis_info);
   myfile.close();
 }
 } // end namespace xmlprinterutils
@@ -280,11 +339,18 @@ void printXMLsystem(
 
 void XMLPrinter::print(const AutomataSystem &s, SystemVisInfo &s_vis_info,
                        std::string filename) {
-  xmlprinterutils::printXMLstart(s.globals, filename);
-  for (auto it = s.instances.begin(); it != s.instances.end(); ++it) {
-    xmlprinterutils::printXMLtemplate(s, s_vis_info, it - s.instances.begin(),
-                                      filename);
-  }
-  xmlprinterutils::printXMLsystem(s.instances, filename);
-  xmlprinterutils::printXMLend(filename);
+  xmlprinterutils::printXML(filename, s, &s_vis_info);
+}
+
+void XMLPrinter::print(const AutomataSystem &s, SystemVisInfo &s_vis_info,
+                       std::ostream &out) {
+  xmlprinterutils::printXML(out, s, &s_vis_info);
+}
+
+void XMLPrinter::print(const AutomataSystem &s, std::string filename) {
+  xmlprinterutils::printXML(filename, s, nullptr);
+}
+
+void XMLPrinter::print(const AutomataSystem &s, std::ostream &out) {
+  xmlprinterutils::printXML(out, s, nullptr);
 }
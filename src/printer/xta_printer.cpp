@@ -234,13 +234,15 @@ void printXTAsystem(
 } // end namespace xtaprinterutils
 } // end namespace taptenc
 
-void XTAPrinter::print(const AutomataSystem &s, SystemVisInfo &s_vis_info,
+void XTAPrinter::print(const AutomataSystem &s, SystemVisInfo &,
                        std::string filename) {
+  print(s, filename);
+}
+
+void XTAPrinter::print(const AutomataSystem &s, std::string filename) {
   xtaprinterutils::printXTAstart(s, filename);
   for (auto it = s.instances.begin(); it != s.instances.end(); ++it) {
     xtaprinterutils::printXTAtemplate(s, it - s.instances.begin(), filename);
   }
-  std::cout << "useless output: " << s_vis_info.getStatePos(0, "").first
-            << std::endl;
   xtaprinterutils::printXTAsystem(s.instances, filename);
 }
@@ -1,9 +1,12 @@
 #include "constants.h"
 #include "encoders.h"
+#include "encoding_cache.h"
 #include "filter.h"
 #include "plan_ordered_tls.h"
 #include "platform_model_generator.h"
 #include "printer.h"
+#include "report.h"
+#include "solvers.h"
 #include "transformation.h"
 #include "timed_automata.h"
 #include "uppaal_calls.h"
@@ -31,7 +34,7 @@ using namespace std;
 
 void append_prefix_to_states(vector<State> &arg_states, string prefix) {
   for (auto it = arg_states.begin(); it != arg_states.end(); ++it) {
-    it->id += prefix;
+    it->id = it->id + prefix;
   }
 }
 
@@ -82,7 +85,7 @@ Automaton generateSyncPlanAutomaton(
     std::unique_ptr<ClockConstraint> guard;
     update_t update = {};
     auto prev_state = (it - 1);
-    if (prev_state->id.substr(0, 5) != "alpha") {
+    if (prev_state->id.str().substr(0, 5) != "alpha") {
       sync_op = Filter::getPrefix(prev_state->id, constants::PA_SEP);
       guard = std::make_unique<TrueCC>();
     } else {
@@ -141,263 +144,13 @@ createModularEncoding(AutomataSystem &system, const AutomataGlobals g,
 //   return enc;
 // }
 
-std::string idToMachineStr(int i) {
-  if (i == -1)
-    return "start";
-  if (i == 0)
-    return "bs";
-  if (i == 1)
-    return "cs1";
-  if (i == 2)
-    return "cs2";
-  if (i == 3)
-    return "rs1";
-  if (i == 4)
-    return "rs2";
-  if (i == 5)
-    return "ds";
-  return "nomachine";
-}
-
-Bounds addBounds(const Bounds &a, const Bounds &b) {
-  return Bounds(safeAddition(a.lower_bound, b.lower_bound),
-                safeAddition(a.upper_bound, b.upper_bound),
-                a.l_op == b.l_op ? a.l_op : ComparisonOp::LT,
-                a.r_op == b.r_op ? a.r_op : ComparisonOp::LT);
-}
-
-Bounds addGrasp(::std::vector<PlanAction> &plan, std::string grasp,
-                std::string obj, int m, const bounds abs_bounds) {
-  Bounds grasp_bounds(15, 20);
-  Bounds end_bounds(0, 30);
-  Bounds res_abs_bounds = abs_bounds;
-  plan.push_back(
-      PlanAction(ActionName("start" + grasp, {obj, idToMachineStr(m)}),
-                 res_abs_bounds, grasp_bounds));
-  res_abs_bounds = addBounds(res_abs_bounds, grasp_bounds);
-  plan.push_back(PlanAction(ActionName("end" + grasp, {obj, idToMachineStr(m)}),
-                            res_abs_bounds, end_bounds));
-  res_abs_bounds = addBounds(res_abs_bounds, end_bounds);
-  return res_abs_bounds;
-}
-Bounds addGoto(::std::vector<PlanAction> &plan, int curr_pos, int dest_pos,
-               const bounds abs_bounds) {
-  Bounds goto_bounds(30, 45);
-  Bounds end_bounds(0, 30);
-  Bounds res_abs_bounds = abs_bounds;
-  // std::cout << res_abs_bounds.lower_bound << "," <<
-  // res_abs_bounds.upper_bound
-  //           << std::endl;
-  if (curr_pos != dest_pos) {
-    plan.push_back(
-        PlanAction(ActionName("startgoto", {idToMachineStr(curr_pos),
-                                            idToMachineStr(dest_pos)}),
-                   res_abs_bounds, goto_bounds));
-    res_abs_bounds = addBounds(res_abs_bounds, goto_bounds);
-    // std::cout << res_abs_bounds.lower_bound << "," <<
-    // res_abs_bounds.upper_bound
-    //           << std::endl;
-    plan.push_back(PlanAction(ActionName("endgoto", {idToMachineStr(curr_pos),
-                                                     idToMachineStr(dest_pos)}),
-                              res_abs_bounds, end_bounds));
-    res_abs_bounds = addBounds(res_abs_bounds, end_bounds);
-    // std::cout << res_abs_bounds.lower_bound << "," <<
-    // res_abs_bounds.upper_bound
-    //           << std::endl;
-  }
-  return res_abs_bounds;
-}
-
-::std::vector<PlanAction> generatePlan(long unsigned int plan_length) {
-  // std::cout << "enter plan gen " << std::endl;
-  Bounds instant_bounds(0, 0);
-  Bounds no_bounds(0, numeric_limits<int>::max());
-  Bounds goto_bounds(30, 45);
-  Bounds grasp_bounds(15, 20);
-  Bounds end_bounds(0, 30);
-  /*
-   * Encode MPS via numbers:
-   *  - -1  = START
-   *  - 0   = BS
-   *  - 1,2 = CS
-   *  - 3,4 = RS
-   *  - 5   = DS
-   *
-   */
-  ::std::vector<PlanAction> plan;
-  Bounds abs_bounds(0, 30);
-  plan.push_back(PlanAction(ActionName("startplan", {"arg0", "arg1"}),
-                            abs_bounds, instant_bounds));
-  int cc_count = 0;
-  int tr_count = 0;
-  int wp_count = 0;
-  int curr_pos = -1;
-  for (int k = 0; k < 10; k++) {
-    if (plan.size() > plan_length) {
-      break;
-    }
-    int cs = rand() % 2 + 1;
-    int ds = 5;
-    int num_rings = rand() % 4;
-    // std::cout << "cs: " << cs << " num_rings: " << num_rings << std::endl;
-    std::vector<int> rs_ring_count(5, 0);
-    std::vector<int> req_rs;
-    std::vector<int> req_pay;
-    for (int i = 1; i <= num_rings; i++) {
-      req_rs.push_back(rand() % 2 + 3);
-      req_pay.push_back(rand() % 3);
-      // std::cout << "ring " << i << " req " << *(req_pay.end() - 1) << " from
-      // "
-      //           << *(req_rs.end() - 1) << std::endl;
-    }
-    int curr_step = 0;
-    int req_steps = num_rings + 2;
-    bool cs_buffered = false;
-    std::vector<bool> occupied(6, false);
-    bool abort = false;
-    bool full_game = false;
-    while (curr_step != req_steps) {
-      if (plan.size() > plan_length) {
-        break;
-      }
-      // if (abs_bounds.lower_bound > 1200) {
-      //   full_game = true;
-      //   break;
-      // }
-      int op_cs = rand() % 2;
-      if ((!(cs_buffered && !occupied[cs])) &&
-          (op_cs == 1 || curr_step == num_rings)) {
-        if (cs_buffered) {
-          int feed_rs = rand() % 2 + 3;
-          rs_ring_count[feed_rs]++;
-          if (rs_ring_count[feed_rs] == 4) {
-            abort = true;
-            break;
-          }
-          // feed cc
-          abs_bounds = addGoto(plan, curr_pos, cs, abs_bounds);
-          abs_bounds = addGrasp(plan, "pick", "cc" + std::to_string(cc_count),
-                                cs, abs_bounds);
-          abs_bounds = addGoto(plan, cs, feed_rs, abs_bounds);
-          abs_bounds = addGrasp(plan, "pay", "cc" + std::to_string(cc_count),
-                                feed_rs, abs_bounds);
-          // std::cout << "feed cc to " << feed_rs << " from " << curr_pos
-          //           << " to " << feed_rs << std::endl;
-          curr_pos = feed_rs;
-          occupied[cs] = false;
-          cc_count++;
-        } else {
-          cs_buffered = true;
-          occupied[cs] = true;
-          abs_bounds = addGoto(plan, curr_pos, cs, abs_bounds);
-          abs_bounds =
-              addGrasp(plan, "getshelf", "cc" + std::to_string(cc_count), cs,
-                       abs_bounds);
-          abs_bounds = addGrasp(plan, "put", "cc" + std::to_string(cc_count),
-                                cs, abs_bounds);
-          // buffer cap
-          // std::cout << "buffer cap" << std::endl;
-          curr_pos = cs;
-        }
-      }
-      if (op_cs == 1) {
-        // std::cout << "hat" << std::endl;
-        continue;
-      }
-      if (op_cs == 0 && curr_step < num_rings) {
-        if (req_pay[curr_step] <= rs_ring_count[req_rs[curr_step]]) {
-          rs_ring_count[req_rs[curr_step]] -= req_pay[curr_step];
-          // mount ring
-          int prev = -1;
-          if (curr_step > 0) {
-            prev = req_rs[curr_step - 1];
-          }
-          abs_bounds = addGoto(plan, curr_pos, prev, abs_bounds);
-          abs_bounds = addGrasp(plan, "pick", "wp" + std::to_string(wp_count),
-                                prev, abs_bounds);
-          abs_bounds = addGoto(plan, prev, req_rs[curr_step], abs_bounds);
-          abs_bounds = addGrasp(plan, "put", "wp" + std::to_string(wp_count),
-                                req_rs[curr_step], abs_bounds);
-          // std::cout << "mount ring on " << req_rs[curr_step] << std::endl;
-          curr_pos = req_rs[curr_step];
-          curr_step++;
-        } else {
-          int source_mat = rand() % 3;
-          // get material
-          std::string get = "pick";
-          if (source_mat > 0) {
-            get = "getshelf";
-          }
-          abs_bounds = addGoto(plan, curr_pos, source_mat, abs_bounds);
-          abs_bounds = addGrasp(plan, get, "tr" + std::to_string(tr_count),
-                                source_mat, abs_bounds);
-          abs_bounds = addGoto(plan, source_mat, req_rs[curr_step], abs_bounds);
-          abs_bounds = addGrasp(plan, "pay", "tr" + std::to_string(tr_count),
-                                req_rs[curr_step], abs_bounds);
-          tr_count++;
-          curr_pos = source_mat;
-          rs_ring_count[req_rs[curr_step]]++;
-          // std::cout << "get material from " << source_mat << " to feed in "
-          //           << req_rs[curr_step] << std::endl;
-        }
-      }
-      if (curr_step == num_rings && cs_buffered && !occupied[cs]) {
-        // std::cout << "finalize product" << curr_step << std::endl;
-        int source = 0;
-        if (curr_step > 0) {
-          source = req_rs[curr_step - 1];
-        }
-        abs_bounds = addGoto(plan, curr_pos, source, abs_bounds);
-        abs_bounds = addGrasp(plan, "pick", "wp" + std::to_string(wp_count),
-                              source, abs_bounds);
-        abs_bounds = addGoto(plan, source, cs, abs_bounds);
-        abs_bounds = addGrasp(plan, "put", "wp" + std::to_string(wp_count), cs,
-                              abs_bounds);
-        abs_bounds = addGrasp(plan, "pick", "wp" + std::to_string(wp_count), cs,
-                              abs_bounds);
-        abs_bounds = addGoto(plan, cs, ds, abs_bounds);
-        abs_bounds = addGrasp(plan, "put", "wp" + std::to_string(wp_count), ds,
-                              abs_bounds);
-        curr_pos = ds;
-        // std::cout << "finalize product done" << std::endl;
-        // finalize
-        curr_step++;
-        curr_step++;
-      }
-    }
-    if (abort) {
-      // std::cout << "aborted" << std::endl;
-      return generatePlan(plan_length);
-    }
-    if (full_game) {
-      // std::cout << "full_game" << std::endl;
-      break;
-    }
-    wp_count++;
-  }
-  while (plan.size() >= plan_length) {
-    plan.pop_back();
-  }
-  plan.push_back(PlanAction(ActionName("endplan", {"arg0", "arg1"}), abs_bounds,
-                            instant_bounds));
-  // for (auto &p : plan) {
-  //   std::cout << p.name.toString() << " "
-  //             << computils::toString(p.absolute_time.l_op)
-  //             << p.absolute_time.lower_bound << ","
-  //             << p.absolute_time.upper_bound
-  //             << computils::toString(p.absolute_time.r_op);
-  //   std::cout << " " << computils::toString(p.duration.l_op)
-  //             << p.duration.lower_bound << "," << p.duration.upper_bound
-  //             << computils::toString(p.duration.r_op) << std::endl;
-  // }
-  return plan;
-}
 int main(int argc, char **argv) {
   /* initialize random seed: */
   srand(time(NULL));
   if (uppaalcalls::getEnvVar("VERIFYTA_DIR") == "") {
-    cout << "ERROR: VERIFYTA_DIR not set!" << endl;
-    return -1;
+    cout << "VERIFYTA_DIR not set, only systems supported by the native "
+            "solver can be solved"
+         << endl;
   }
   int jay = 0;
   int num_runs_per_category = 1;
@@ -443,10 +196,18 @@ int main(int argc, char **argv) {
 
   XMLPrinter printer;
   vector<uppaalcalls::timedelta> time_observed;
+  NativeSolver solver(std::make_unique<VerifytaSolver>("merged"));
+  // identical plans are only transformed once, TAPTENC_CACHE_DIR additionally
+  // persists the results across runs
+  EncodingCache cache(uppaalcalls::getEnvVar("TAPTENC_CACHE_DIR"));
   for (int k = 0; k < num_runs_per_category; k++) {
 		// init plan
-    vector<PlanAction> plan = generatePlan(plan_length);
-		auto res = taptenc::transformation::transform_plan(plan, platform_tas, platform_constraints);
+    vector<PlanAction> plan = benchmarkgenerator::generatePlan(plan_length);
+    Report report;
+		auto res = taptenc::transformation::transform_plan(
+        plan, platform_tas, platform_constraints, solver, 1, SmallestFirst,
+        &report, &cache);
+    std::cout << report.toString();
 		for ( const auto &entry : res ) {
 		  std::cout << entry.first << " : ";
 		 for (const auto &act : entry.second) {
@@ -0,0 +1,87 @@
+/** \file
+ * Instrumentation of the plan transformation (phase timings and counters).
+ *
+ * \author (2019) Tarik Viehmann
+ */
+#include "report.h"
+#include <chrono>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+using namespace taptenc;
+
+Report::Report(const Report &other) {
+  std::lock_guard<std::mutex> lock(other.report_mutex);
+  times = other.times;
+  counters = other.counters;
+}
+
+Report &Report::operator=(const Report &other) {
+  if (this != &other) {
+    std::map<std::string, duration> other_times = other.getTimes();
+    std::map<std::string, long> other_counters = other.getCounters();
+    std::lock_guard<std::mutex> lock(report_mutex);
+    times = std::move(other_times);
+    counters = std::move(other_counters);
+  }
+  return *this;
+}
+
+void Report::addTime(const std::string &phase, duration time) {
+  std::lock_guard<std::mutex> lock(report_mutex);
+  times[phase] += time;
+}
+
+void Report::addCount(const std::string &counter, long value) {
+  std::lock_guard<std::mutex> lock(report_mutex);
+  counters[counter] += value;
+}
+
+void Report::add(const Report &other) {
+  for (const auto &time : other.getTimes()) {
+    addTime(time.first, time.second);
+  }
+  for (const auto &counter : other.getCounters()) {
+    addCount(counter.first, counter.second);
+  }
+}
+
+std::map<std::string, Report::duration> Report::getTimes() const {
+  std::lock_guard<std::mutex> lock(report_mutex);
+  return times;
+}
+
+std::map<std::string, long> Report::getCounters() const {
+  std::lock_guard<std::mutex> lock(report_mutex);
+  return counters;
+}
+
+std::string Report::toString() const {
+  std::stringstream res;
+  res << std::fixed << std::setprecision(3);
+  for (const auto &time : getTimes()) {
+    res << time.first << ": " << time.second.count() / 1000.0 << " ms"
+        << std::endl;
+  }
+  for (const auto &counter : getCounters()) {
+    res << counter.first << ": " << counter.second << std::endl;
+  }
+  return res.str();
+}
+
+ScopedTimer::ScopedTimer(Report *arg_report, const std::string &arg_phase)
+    : report(arg_report), phase(arg_report != nullptr ? arg_phase : ""),
+      start(std::chrono::steady_clock::now()) {}
+
+void ScopedTimer::stop() {
+  if (report != nullptr) {
+    report->addTime(phase, std::chrono::duration_cast<Report::duration>(
+                               std::chrono::steady_clock::now() - start));
+    report = nullptr;
+  }
+}
+
+ScopedTimer::~ScopedTimer() { stop(); }
@@ -0,0 +1,97 @@
+/** \file
+ * Instrumentation of the plan transformation (phase timings and counters).
+ *
+ * \author (2019) Tarik Viehmann
+ */
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace taptenc {
+/**
+ * Collects timings and counters of the phases of a plan transformation.
+ *
+ * Values recorded under the same name are summed up. Names are hierarchical,
+ * separated by '/' (e.g. "encoding/Future" or "encoding/Future/states").
+ * Recording is thread-safe, as platforms are encoded concurrently. Hence,
+ * times of concurrent phases add up to more than the elapsed wall time.
+ */
+class Report {
+public:
+  typedef ::std::chrono::microseconds duration;
+
+private:
+  mutable ::std::mutex report_mutex;
+  ::std::map<::std::string, duration> times;
+  ::std::map<::std::string, long> counters;
+
+public:
+  Report() = default;
+  Report(const Report &other);
+  Report &operator=(const Report &other);
+
+  /**
+   * Adds time spent in a phase.
+   *
+   * @param phase name of the phase
+   * @param time time to add
+   */
+  void addTime(const ::std::string &phase, duration time);
+  /**
+   * Increases a counter.
+   *
+   * @param counter name of the counter
+   * @param value value to add
+   */
+  void addCount(const ::std::string &counter, long value = 1);
+  /**
+   * Merges all times and counters of another report into this one.
+   */
+  void add(const Report &other);
+
+  /** Returns the accumulated times, ordered by phase name. */
+  ::std::map<::std::string, duration> getTimes() const;
+  /** Returns the accumulated counters, ordered by counter name. */
+  ::std::map<::std::string, long> getCounters() const;
+  /**
+   * Formats the report as one line per time (in ms) and counter.
+   */
+  ::std::string toString() const;
+};
+
+/**
+ * Measures the time from its construction until its destruction and adds it
+ * to a report.
+ *
+ * Does nothing if no report is given, such that instrumented code does not
+ * need to distinguish whether a report is requested.
+ */
+class ScopedTimer {
+private:
+  Report *report;
+  ::std::string phase;
+  ::std::chrono::steady_clock::time_point start;
+
+public:
+  /**
+   * Starts the measurement.
+   *
+   * @param arg_report report to add the time to, may be nullptr
+   * @param arg_phase name of the measured phase
+   */
+  ScopedTimer(Report *arg_report, const ::std::string &arg_phase);
+  ScopedTimer(const ScopedTimer &) = delete;
+  ScopedTimer &operator=(const ScopedTimer &) = delete;
+  /**
+   * Stops the measurement and adds the elapsed time to the report.
+   *
+   * Subsequent calls and the destruction have no effect.
+   */
+  void stop();
+  /** Stops the measurement, if not done already (see stop()). */
+  ~ScopedTimer();
+};
+} // end namespace taptenc
@@ -0,0 +1,124 @@
+/** \file
+ * Solver backend memorizing the results of another solver.
+ *
+ * \author (2019) Tarik Viehmann
+ */
+#include "cached_solver.h"
+#include "../constraints/constraints.h"
+#include <algorithm>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace taptenc;
+
+CachedSolver::CachedSolver(std::unique_ptr<Solver> arg_backend,
+                           std::size_t arg_capacity)
+    : backend(std::move(arg_backend)), capacity(arg_capacity) {}
+
+namespace {
+/**
+ * Clock sets are ordered by pointers, hence sort the clock ids to obtain a
+ * deterministic description.
+ */
+void appendClocks(std::stringstream &ss,
+                  const std::set<std::shared_ptr<Clock>> &clocks) {
+  std::vector<std::string> ids;
+  for (const auto &cl : clocks) {
+    ids.push_back(cl->id.str());
+  }
+  std::sort(ids.begin(), ids.end());
+  ss << "[";
+  for (const auto &id : ids) {
+    ss << id << ";";
+  }
+  ss << "]";
+}
+
+void appendBoolVars(std::stringstream &ss,
+                    const std::vector<std::string> &bool_vars) {
+  ss << "[";
+  for (const auto &var : bool_vars) {
+    ss << var << ";";
+  }
+  ss << "]";
+}
+} // end anonymous namespace
+
+std::string CachedSolver::printQuery(const AutomataSystem &sys,
+                                     const std::string &target_state) {
+  std::stringstream ss;
+  ss << "E<>" << target_state << ";globals:";
+  appendClocks(ss, sys.globals.clocks);
+  appendBoolVars(ss, sys.globals.bool_vars);
+  ss << "[";
+  for (const auto &chan : sys.globals.channels) {
+    ss << chan.name << "<" << chan.type << ">;";
+  }
+  ss << "]";
+  for (const auto &inst : sys.instances) {
+    const Automaton &ta = inst.first;
+    ss << "ta:" << ta.prefix << "(" << inst.second << ")[";
+    for (const auto &s : ta.states) {
+      ss << s.id.str() << "{" << s.inv->toString() << "}" << s.urgent
+         << s.initial << ";";
+    }
+    ss << "][";
+    for (const auto &t : ta.transitions) {
+      ss << t.source_id.str() << "->" << t.dest_id.str() << "{" << t.action
+         << "|" << t.guard->toString() << "|" << t.updateToString() << "|"
+         << t.sync << t.passive << "};";
+    }
+    ss << "]";
+    appendClocks(ss, ta.clocks);
+    appendBoolVars(ss, ta.bool_vars);
+  }
+  return ss.str();
+}
+
+SolverResult CachedSolver::solve(const AutomataSystem &sys,
+                                 const std::string &target_state) {
+  std::string key = printQuery(sys, target_state);
+  {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    auto entry = cache.find(key);
+    if (entry != cache.end()) {
+      hits++;
+      recency.splice(recency.begin(), recency, entry->second.recency_pos);
+      return entry->second.result;
+    }
+    misses++;
+  }
+  // solve without holding the lock, so other queries are not blocked
+  SolverResult res = backend->solve(sys, target_state);
+  if (res.status == SolverStatus::Unknown || capacity == 0) {
+    return res;
+  }
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  auto emplaced = cache.emplace(std::move(key), cacheEntry{res, {}});
+  if (emplaced.second) {
+    recency.push_front(&emplaced.first->first);
+    emplaced.first->second.recency_pos = recency.begin();
+    if (cache.size() > capacity) {
+      cache.erase(cache.find(*recency.back()));
+      recency.pop_back();
+    }
+  }
+  return res;
+}
+
+std::string CachedSolver::getName() const {
+  return "cached " + backend->getName();
+}
+
+std::size_t CachedSolver::getHits() const {
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  return hits;
+}
+
+std::size_t CachedSolver::getMisses() const {
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  return misses;
+}
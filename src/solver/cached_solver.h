@@ -0,0 +1,68 @@
+/** \file
+ * Solver backend memorizing the results of another solver.
+ *
+ * \author (2019) Tarik Viehmann
+ */
+#pragma once
+
+#include "solver.h"
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace taptenc {
+/**
+ * Forwards queries to another solver and remembers the results.
+ *
+ * Queries are identified by a textual description of the whole automata
+ * system and the target state, so re-solving an identical system (e.g. when
+ * the same plan is transformed again) is answered without calling the
+ * backend. Results with status Unknown are not remembered, as the backend
+ * may succeed on a later attempt. At most \a capacity results are kept, the
+ * least recently used one is evicted first.
+ */
+class CachedSolver : public Solver {
+private:
+  struct cacheEntry {
+    SolverResult result;
+    /** position of the entry within \a recency */
+    ::std::list<const ::std::string *>::iterator recency_pos;
+  };
+  ::std::unique_ptr<Solver> backend;
+  ::std::size_t capacity;
+  ::std::unordered_map<::std::string, cacheEntry> cache;
+  /** keys of \a cache, most recently used first */
+  ::std::list<const ::std::string *> recency;
+  mutable ::std::mutex cache_mutex;
+  ::std::size_t hits = 0;
+  ::std::size_t misses = 0;
+
+public:
+  /**
+   * @param arg_backend solver that answers queries missing in the cache
+   * @param arg_capacity maximal number of remembered results
+   */
+  CachedSolver(::std::unique_ptr<Solver> arg_backend,
+               ::std::size_t arg_capacity = 128);
+  SolverResult solve(const AutomataSystem &sys,
+                     const ::std::string &target_state) override;
+  ::std::string getName() const override;
+
+  /**
+   * Computes the key identifying a query.
+   *
+   * @param sys automata system of the query
+   * @param target_state target state of the query
+   * @return textual description of \a sys and \a target_state, equal
+   *         descriptions denote the same query
+   */
+  static ::std::string printQuery(const AutomataSystem &sys,
+                                  const ::std::string &target_state);
+  /** Returns the number of queries answered from the cache. */
+  ::std::size_t getHits() const;
+  /** Returns the number of queries forwarded to the backend. */
+  ::std::size_t getMisses() const;
+};
+} // end namespace taptenc
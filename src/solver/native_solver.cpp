@@ -0,0 +1,43 @@
+/** \file
+ * Solver backend using the in-process zone based reachability checker.
+ *
+ * \author (2019) Tarik Viehmann
+ */
+#include "native_solver.h"
+#include "../logging.h"
+#include "../verifier/zone_reachability.h"
+#include <chrono>
+#include <string>
+
+using namespace taptenc;
+
+NativeSolver::NativeSolver(std::unique_ptr<Solver> arg_fallback)
+    : fallback(std::move(arg_fallback)) {}
+
+SolverResult NativeSolver::solve(const AutomataSystem &sys,
+                                 const std::string &target_state) {
+  SolverResult res;
+  auto t1 = std::chrono::high_resolution_clock::now();
+  ZoneReachability checker(sys);
+  if (!checker.isSupported()) {
+    if (fallback) {
+      return fallback->solve(sys, target_state);
+    }
+    TAPTENC_LOG_ERROR("NativeSolver solve: system not supported and no "
+                      "fallback solver given");
+    return res;
+  }
+  res.status = checker.findTrace(target_state, res.trace)
+                   ? SolverStatus::Reachable
+                   : SolverStatus::Unreachable;
+  auto t2 = std::chrono::high_resolution_clock::now();
+  res.timings.push_back(std::make_pair(
+      "search",
+      std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1)));
+  return res;
+}
+
+std::string NativeSolver::getName() const {
+  return fallback ? "native (fallback: " + fallback->getName() + ")"
+                  : "native";
+}
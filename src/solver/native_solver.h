@@ -0,0 +1,34 @@
+/** \file
+ * Solver backend using the in-process zone based reachability checker.
+ *
+ * \author (2019) Tarik Viehmann
+ */
+#pragma once
+
+#include "solver.h"
+#include <memory>
+#include <string>
+
+namespace taptenc {
+/**
+ * Solves queries with ZoneReachability, without any file or process
+ * overhead.
+ *
+ * Systems that are not supported by the checker are handed to an optional
+ * fallback solver.
+ */
+class NativeSolver : public Solver {
+private:
+  ::std::unique_ptr<Solver> fallback;
+
+public:
+  /**
+   * @param arg_fallback solver for systems the checker does not support,
+   *        if not given such queries fail
+   */
+  NativeSolver(::std::unique_ptr<Solver> arg_fallback = nullptr);
+  SolverResult solve(const AutomataSystem &sys,
+                     const ::std::string &target_state) override;
+  ::std::string getName() const override;
+};
+} // end namespace taptenc
@@ -0,0 +1,64 @@
+/** \file
+ * Interface to solvers for reachability queries on automata systems.
+ *
+ * \author (2019) Tarik Viehmann
+ */
+#pragma once
+
+#include "../parser/utap_trace_parser.h"
+#include "../timed-automata/timed_automata.h"
+#include "../uppaal_calls.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace taptenc {
+/**
+ * Answer to a reachability query.
+ */
+enum SolverStatus {
+  /** the target is reachable, the trace holds a witness */
+  Reachable,
+  /** the target is proven to be unreachable */
+  Unreachable,
+  /** no answer was obtained, e.g. because the backend could not be run */
+  Unknown
+};
+
+/**
+ * Outcome of a reachability query.
+ */
+struct solverResult {
+  /** answer to the query, only Reachable results carry a \a trace */
+  SolverStatus status = SolverStatus::Unknown;
+  /** symbolic trace from the initial state to the target */
+  SymbolicTrace trace;
+  /** durations of the individual solving steps, labeled by step name */
+  ::std::vector<::std::pair<::std::string, uppaalcalls::timedelta>> timings;
+};
+typedef struct solverResult SolverResult;
+
+/**
+ * Solves reachability queries of the form E<> component.target_state.
+ *
+ * Implementations have to be safe to use from multiple threads at once.
+ */
+class Solver {
+public:
+  virtual ~Solver() = default;
+  /**
+   * Searches a trace to a target state.
+   *
+   * @param sys automata system to solve the query for
+   * @param target_state id of the state that should be reached
+   * @return whether the target is reachable, together with a trace, or
+   *         status Unknown if the query could not be answered
+   */
+  virtual SolverResult solve(const AutomataSystem &sys,
+                             const ::std::string &target_state) = 0;
+  /**
+   * Returns a name identifying the backend.
+   */
+  virtual ::std::string getName() const = 0;
+};
+} // end namespace taptenc
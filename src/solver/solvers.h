@@ -0,0 +1,7 @@
+#pragma once
+
+#include "cached_solver.h"
+#include "native_solver.h"
+#include "solver.h"
+#include "stub_solver.h"
+#include "verifyta_solver.h"
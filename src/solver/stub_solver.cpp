@@ -0,0 +1,16 @@
+/** \file
+ * Solver backend that does not solve anything.
+ *
+ * \author (2019) Tarik Viehmann
+ */
+#include "stub_solver.h"
+
+using namespace taptenc;
+
+SolverResult StubSolver::solve(const AutomataSystem &,
+                               const std::string &) {
+  num_calls++;
+  return SolverResult();
+}
+
+std::string StubSolver::getName() const { return "stub"; }
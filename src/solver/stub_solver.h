@@ -0,0 +1,31 @@
+/** \file
+ * Solver backend that does not solve anything.
+ *
+ * \author (2019) Tarik Viehmann
+ */
+#pragma once
+
+#include "solver.h"
+#include <atomic>
+#include <string>
+
+namespace taptenc {
+/**
+ * Answers every query with status Unknown without looking at the system.
+ *
+ * Useful to benchmark the encoding throughput on its own.
+ */
+class StubSolver : public Solver {
+private:
+  ::std::atomic<::std::size_t> num_calls{0};
+
+public:
+  SolverResult solve(const AutomataSystem &sys,
+                     const ::std::string &target_state) override;
+  ::std::string getName() const override;
+  /**
+   * Returns the number of queries received so far.
+   */
+  ::std::size_t getNumCalls() const { return num_calls; }
+};
+} // end namespace taptenc
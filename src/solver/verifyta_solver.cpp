@@ -0,0 +1,72 @@
+/** \file
+ * Solver backend calling uppaal's verifyta and the utap tracer.
+ *
+ * \author (2019) Tarik Viehmann
+ */
+#include "verifyta_solver.h"
+#include "../logging.h"
+#include "../parser/utap_trace_parser.h"
+#include "../uppaal_calls.h"
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+using namespace taptenc;
+
+VerifytaSolver::VerifytaSolver(std::string arg_file_name,
+                               std::string arg_verifyta_dir,
+                               bool arg_keep_files)
+    : file_name(arg_file_name), verifyta_dir(arg_verifyta_dir),
+      keep_files(arg_keep_files) {}
+
+SolverResult VerifytaSolver::solve(const AutomataSystem &sys,
+                                   const std::string &target_state) {
+  SolverResult res;
+  // query the component containing the target state
+  std::string component = sys.instances.front().first.prefix;
+  for (const auto &inst : sys.instances) {
+    if (std::any_of(inst.first.states.begin(), inst.first.states.end(),
+                    [&target_state](const State &s) {
+                      return s.id == target_state;
+                    })) {
+      component = inst.first.prefix;
+      break;
+    }
+  }
+  std::string query_str = "E<> sys_" + component + "." + target_state;
+  std::unique_ptr<uppaalcalls::TempWorkspace> workspace;
+  try {
+    workspace = std::make_unique<uppaalcalls::TempWorkspace>();
+  } catch (const std::runtime_error &e) {
+    // e.g. the temporary directory is missing or full
+    TAPTENC_LOG_ERROR("VerifytaSolver solve: " << e.what());
+    res.status = SolverStatus::Unknown;
+    return res;
+  }
+  if (keep_files) {
+    workspace->keep();
+  }
+  std::string file_path = workspace->file(file_name);
+  uppaalcalls::VerificationResult verification =
+      uppaalcalls::solve(sys, file_path, query_str, verifyta_dir);
+  std::vector<std::string> step_names({"compile", "verify", "trace"});
+  for (size_t i = 0;
+       i < verification.timings.size() && i < step_names.size(); i++) {
+    res.timings.push_back(
+        std::make_pair(step_names[i], verification.timings[i]));
+  }
+  if (!verification.success) {
+    res.status = SolverStatus::Unknown;
+  } else if (!verification.satisfied) {
+    res.status = SolverStatus::Unreachable;
+  } else if (UTAPTraceParser::readTraceFile(file_path + ".trace", res.trace)) {
+    res.status = SolverStatus::Reachable;
+  } else {
+    // verifyta found a trace, but it cannot be read
+    res.status = SolverStatus::Unknown;
+  }
+  return res;
+}
+
+std::string VerifytaSolver::getName() const { return "verifyta"; }
@@ -0,0 +1,42 @@
+/** \file
+ * Solver backend calling uppaal's verifyta and the utap tracer.
+ *
+ * \author (2019) Tarik Viehmann
+ */
+#pragma once
+
+#include "../uppaal_calls.h"
+#include "solver.h"
+#include <string>
+
+namespace taptenc {
+/**
+ * Solves queries by printing the system to xml, calling verifyta and
+ * reading the resulting trace (see uppaalcalls::solve()).
+ *
+ * Each query is solved within its own uppaalcalls::TempWorkspace, so the
+ * solver can be used for several queries at once.
+ */
+class VerifytaSolver : public Solver {
+private:
+  ::std::string file_name;
+  ::std::string verifyta_dir;
+  bool keep_files;
+
+public:
+  /**
+   * @param arg_file_name name of the system file without .xml, all files
+   *        created during solving share this name
+   * @param arg_verifyta_dir directory containing verifyta, defaults to the
+   *        content of the environment variable VERIFYTA_DIR
+   * @param arg_keep_files if true, the workspaces are not deleted after
+   *        solving
+   */
+  VerifytaSolver(::std::string arg_file_name = uppaalcalls::TAPTENC_TEMP_XML,
+                 ::std::string arg_verifyta_dir = "",
+                 bool arg_keep_files = false);
+  SolverResult solve(const AutomataSystem &sys,
+                     const ::std::string &target_state) override;
+  ::std::string getName() const override;
+};
+} // end namespace taptenc
@@ -0,0 +1,41 @@
+/** \file
+ * Minimal thread pool to run independent encoding steps concurrently.
+ *
+ * \author (2019) Tarik Viehmann
+ */
+#include "thread_pool.h"
+
+using namespace taptenc;
+
+ThreadPool::ThreadPool(unsigned int num_workers) {
+  for (unsigned int i = 0; i < num_workers; i++) {
+    workers.emplace_back([this]() { work(); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    stopping = true;
+  }
+  queue_cv.notify_all();
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
+
+void ThreadPool::work() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(queue_mutex);
+      queue_cv.wait(lock, [this]() { return stopping || !tasks.empty(); });
+      if (tasks.empty()) {
+        return;
+      }
+      task = std::move(tasks.front());
+      tasks.pop();
+    }
+    task();
+  }
+}
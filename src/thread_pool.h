@@ -0,0 +1,77 @@
+/** \file
+ * Minimal thread pool to run independent encoding steps concurrently.
+ *
+ * \author (2019) Tarik Viehmann
+ */
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace taptenc {
+/**
+ * Fixed size pool of worker threads processing a FIFO task queue.
+ *
+ * A pool without workers runs each task synchronously on submission, which
+ * allows callers to use the same code path for sequential execution.
+ */
+class ThreadPool {
+private:
+  ::std::vector<::std::thread> workers;
+  ::std::queue<::std::function<void()>> tasks;
+  ::std::mutex queue_mutex;
+  ::std::condition_variable queue_cv;
+  bool stopping = false;
+  /** Worker loop, processes tasks until the pool is destroyed. */
+  void work();
+
+public:
+  /**
+   * Starts the worker threads.
+   *
+   * @param num_workers number of worker threads, 0 executes all tasks
+   *                    synchronously within submit()
+   */
+  explicit ThreadPool(unsigned int num_workers);
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+  /** Finishes all queued tasks and joins the workers. */
+  ~ThreadPool();
+
+  /**
+   * Queues a task.
+   *
+   * @param task callable without arguments
+   * @return future holding the result (or exception) of \a task
+   */
+  template <typename F>
+  ::std::future<typename ::std::result_of<F()>::type> submit(F task) {
+    typedef typename ::std::result_of<F()>::type result_t;
+    auto packaged =
+        ::std::make_shared<::std::packaged_task<result_t()>>(::std::move(task));
+    ::std::future<result_t> res = packaged->get_future();
+    if (workers.empty()) {
+      (*packaged)();
+      return res;
+    }
+    {
+      ::std::lock_guard<::std::mutex> lock(queue_mutex);
+      tasks.emplace([packaged]() { (*packaged)(); });
+    }
+    queue_cv.notify_one();
+    return res;
+  }
+
+  /**
+   * Returns the number of worker threads.
+   */
+  ::std::size_t size() const { return workers.size(); }
+};
+} // end namespace taptenc
@@ -0,0 +1,110 @@
+/** \file
+ * Interning of identifiers used within timed automata (state and clock ids).
+ *
+ * \author: (2019) Tarik Viehmann
+ */
+
+#include "symbol_table.h"
+
+#include <stdexcept>
+
+using namespace taptenc;
+
+SymbolTable::SymbolTable() : next_index(0) {
+  for (auto &chunk : chunks) {
+    chunk.store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+SymbolTable::~SymbolTable() {
+  for (auto &chunk : chunks) {
+    delete[] chunk.load(std::memory_order_relaxed);
+  }
+}
+
+SymbolTable &SymbolTable::instance() {
+  static SymbolTable table;
+  return table;
+}
+
+SymbolTable::shard &SymbolTable::shardOf(::std::size_t name_hash) {
+  return shards[name_hash % NUM_SHARDS];
+}
+
+void SymbolTable::publish(::std::size_t index, const symbol_entry_t *entry) {
+  std::atomic<slot_t *> &chunk = chunks[index >> CHUNK_BITS];
+  slot_t *slots = chunk.load(std::memory_order_acquire);
+  if (slots == nullptr) {
+    slot_t *fresh = new slot_t[CHUNK_SIZE]();
+    if (chunk.compare_exchange_strong(slots, fresh,
+                                      std::memory_order_acq_rel)) {
+      slots = fresh;
+    } else {
+      delete[] fresh;
+    }
+  }
+  slots[index & (CHUNK_SIZE - 1)].store(entry, std::memory_order_release);
+}
+
+::std::size_t SymbolTable::reserveIndex() {
+  // only claim an index if it is within the capacity, such that size() stays
+  // exact after interning fails
+  std::size_t index = next_index.load(std::memory_order_relaxed);
+  do {
+    if ((index >> CHUNK_BITS) >= MAX_CHUNKS) {
+      throw std::length_error("SymbolTable intern: too many symbols");
+    }
+  } while (!next_index.compare_exchange_weak(index, index + 1,
+                                             std::memory_order_relaxed));
+  return index;
+}
+
+const symbol_entry_t *SymbolTable::intern(const ::std::string &name) {
+  shard &sh = shardOf(std::hash<std::string>()(name));
+  std::lock_guard<std::mutex> lock(sh.shard_mutex);
+  auto search = sh.entries.find(name);
+  if (search != sh.entries.end()) {
+    return &(*search);
+  }
+  auto emplaced = sh.entries.emplace(name, reserveIndex());
+  publish(emplaced.first->second, &(*emplaced.first));
+  return &(*emplaced.first);
+}
+
+const symbol_entry_t *SymbolTable::intern(::std::string &&name) {
+  shard &sh = shardOf(std::hash<std::string>()(name));
+  std::lock_guard<std::mutex> lock(sh.shard_mutex);
+  auto search = sh.entries.find(name);
+  if (search != sh.entries.end()) {
+    return &(*search);
+  }
+  std::size_t index = reserveIndex();
+  auto emplaced = sh.entries.emplace(std::move(name), index);
+  publish(index, &(*emplaced.first));
+  return &(*emplaced.first);
+}
+
+const symbol_entry_t *SymbolTable::lookup(::std::size_t index) const {
+  const slot_t *slots =
+      chunks[index >> CHUNK_BITS].load(std::memory_order_acquire);
+  return slots[index & (CHUNK_SIZE - 1)].load(std::memory_order_acquire);
+}
+
+::std::size_t SymbolTable::size() const {
+  return next_index.load(std::memory_order_relaxed);
+}
+
+Symbol::Symbol() {
+  static const symbol_entry_t *empty_entry =
+      SymbolTable::instance().intern("");
+  entry = empty_entry;
+}
+
+Symbol::Symbol(const ::std::string &name)
+    : entry(SymbolTable::instance().intern(name)) {}
+
+Symbol::Symbol(const char *name)
+    : entry(SymbolTable::instance().intern(name)) {}
+
+Symbol::Symbol(::std::string &&name)
+    : entry(SymbolTable::instance().intern(std::move(name))) {}
@@ -0,0 +1,208 @@
+/** \file
+ * Interning of identifiers used within timed automata (state and clock ids).
+ *
+ * \author: (2019) Tarik Viehmann
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace taptenc {
+
+/**
+ * Entry of the symbol table, mapping an interned name to its dense index.
+ */
+typedef ::std::pair<const ::std::string, ::std::size_t> symbol_entry_t;
+
+/**
+ * Process wide table of interned identifiers.
+ *
+ * Each distinct name is stored exactly once and is assigned a dense integer
+ * index in order of insertion.
+ *
+ * Interning is sharded by the hash of the name, each shard is guarded by its
+ * own mutex, so threads encoding different automata rarely contend. Looking up
+ * the name or index of an already interned Symbol does not require any
+ * synchronization, the entry of an index is published through a chunked array
+ * of atomic pointers.
+ *
+ * Lifetime: entries are never removed, as Symbol handles refer to them by
+ * address. The table therefore grows monotonically with the number of
+ * distinct ids created by the process, which is bounded by the states and
+ * clocks of all automata encoded so far. Long running processes encoding
+ * many unrelated plans should monitor size(). At most
+ * MAX_CHUNKS * CHUNK_SIZE names can be interned, interning beyond that
+ * throws ::std::length_error.
+ */
+class SymbolTable {
+private:
+  static constexpr ::std::size_t NUM_SHARDS = 32;
+  static constexpr ::std::size_t CHUNK_BITS = 14;
+  static constexpr ::std::size_t CHUNK_SIZE = ::std::size_t(1) << CHUNK_BITS;
+  static constexpr ::std::size_t MAX_CHUNKS = 4096;
+
+  struct shard {
+    ::std::unordered_map<::std::string, ::std::size_t> entries;
+    ::std::mutex shard_mutex;
+  };
+  typedef ::std::atomic<const symbol_entry_t *> slot_t;
+
+  shard shards[NUM_SHARDS];
+  /** entries by index, chunks are allocated on demand and never moved */
+  ::std::atomic<slot_t *> chunks[MAX_CHUNKS];
+  ::std::atomic<::std::size_t> next_index;
+  SymbolTable();
+  ~SymbolTable();
+
+  shard &shardOf(::std::size_t name_hash);
+  ::std::size_t reserveIndex();
+  void publish(::std::size_t index, const symbol_entry_t *entry);
+
+public:
+  SymbolTable(const SymbolTable &) = delete;
+  SymbolTable &operator=(const SymbolTable &) = delete;
+
+  /**
+   * Access to the global symbol table.
+   *
+   * @return the one symbol table shared by all symbols
+   */
+  static SymbolTable &instance();
+
+  /**
+   * Interns a name.
+   *
+   * @param name name to intern
+   * @return entry of \a name within the table, which is created if not yet
+   *         present
+   */
+  const symbol_entry_t *intern(const ::std::string &name);
+
+  /**
+   * Interns a name, moving it into the table if it is not yet present.
+   *
+   * @param name name to intern
+   * @return entry of \a name within the table
+   */
+  const symbol_entry_t *intern(::std::string &&name);
+
+  /**
+   * Looks up the entry of an interned index.
+   *
+   * @param index dense index of a previously interned name
+   * @return entry having \a index
+   */
+  const symbol_entry_t *lookup(::std::size_t index) const;
+
+  /**
+   * Returns the number of interned names.
+   *
+   * @return number of entries in the table
+   */
+  ::std::size_t size() const;
+};
+
+/**
+ * Handle to an interned identifier.
+ *
+ * Copying, comparing for equality and hashing are constant time operations
+ * on the shared table entry. The string representation is only needed to
+ * derive new identifiers (e.g. by adding prefixes) and for output.
+ */
+class Symbol {
+private:
+  const symbol_entry_t *entry;
+
+public:
+  /** Constructs the symbol of the empty name. */
+  Symbol();
+  Symbol(const ::std::string &name);
+  Symbol(::std::string &&name);
+  Symbol(const char *name);
+
+  /**
+   * Returns the interned name.
+   *
+   * @return name of the symbol
+   */
+  const ::std::string &str() const { return entry->first; }
+  operator const ::std::string &() const { return entry->first; }
+
+  /**
+   * Returns the dense index of the symbol within the SymbolTable.
+   *
+   * @return index of the symbol, unique among all interned names
+   */
+  ::std::size_t index() const { return entry->second; }
+
+  bool empty() const { return entry->first.empty(); }
+
+  bool operator==(const Symbol &r) const { return entry == r.entry; }
+  bool operator!=(const Symbol &r) const { return entry != r.entry; }
+  /** Lexicographic ordering of the names, keeps ordered output stable. */
+  bool operator<(const Symbol &r) const {
+    return entry != r.entry && entry->first < r.entry->first;
+  }
+};
+
+/**
+ * @name Mixed operations on symbols and strings
+ * Comparing a symbol with a string compares the interned name, concatenation
+ * yields a plain string.
+ */
+///@{
+inline bool operator==(const Symbol &l, const ::std::string &r) {
+  return l.str() == r;
+}
+inline bool operator==(const ::std::string &l, const Symbol &r) {
+  return l == r.str();
+}
+inline bool operator==(const Symbol &l, const char *r) { return l.str() == r; }
+inline bool operator==(const char *l, const Symbol &r) { return l == r.str(); }
+inline bool operator!=(const Symbol &l, const ::std::string &r) {
+  return !(l == r);
+}
+inline bool operator!=(const ::std::string &l, const Symbol &r) {
+  return !(l == r);
+}
+inline bool operator!=(const Symbol &l, const char *r) { return !(l == r); }
+inline bool operator!=(const char *l, const Symbol &r) { return !(l == r); }
+
+inline ::std::string operator+(const Symbol &l, const Symbol &r) {
+  return l.str() + r.str();
+}
+inline ::std::string operator+(const Symbol &l, const ::std::string &r) {
+  return l.str() + r;
+}
+inline ::std::string operator+(const ::std::string &l, const Symbol &r) {
+  return l + r.str();
+}
+inline ::std::string operator+(const Symbol &l, const char *r) {
+  return l.str() + r;
+}
+inline ::std::string operator+(const char *l, const Symbol &r) {
+  return l + r.str();
+}
+inline ::std::string operator+(const Symbol &l, char r) { return l.str() + r; }
+inline ::std::string operator+(char l, const Symbol &r) { return l + r.str(); }
+
+inline ::std::ostream &operator<<(::std::ostream &os, const Symbol &sym) {
+  return os << sym.str();
+}
+///@}
+} // end namespace taptenc
+
+namespace std {
+template <> struct hash<::taptenc::Symbol> {
+  size_t operator()(const ::taptenc::Symbol &sym) const { return sym.index(); }
+};
+} // end namespace std
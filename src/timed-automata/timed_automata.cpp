@@ -15,113 +15,33 @@
 
 using namespace taptenc;
 
-/**
- * Helpers to help implementing move constructors.
- */
-namespace moveutils {
-/**
- * Swaps the members of two states using std::swap().
- *
- * @param first first state participating in the swap
- * @param second second state participating in the swap
- */
-void swap(state &first, state &second) {
-  std::swap(first.id, second.id);
-  std::swap(first.inv, second.inv);
-  std::swap(first.urgent, second.urgent);
-  std::swap(first.initial, second.initial);
-}
-
-/**
- * Swaps the members of two transitions using std::swap().
- *
- * @param first first transition participating in the swap
- * @param second second transition participating in the swap
- */
-void swap(transition &first, transition &second) {
-  std::swap(first.source_id, second.source_id);
-  std::swap(first.dest_id, second.dest_id);
-  std::swap(first.action, second.action);
-  std::swap(first.guard, second.guard);
-  std::swap(first.update, second.update);
-  std::swap(first.sync, second.sync);
-  std::swap(first.passive, second.passive);
-}
-} // end namespace moveutils
-
-using namespace moveutils;
-
-state::state(::std::string arg_id, const ClockConstraint &arg_inv,
-             bool arg_urgent, bool arg_initial)
-    : id(arg_id), urgent(arg_urgent), initial(arg_initial) {
-  inv = arg_inv.createCopy();
-}
+state::state(Symbol arg_id, const ClockConstraint &arg_inv, bool arg_urgent,
+             bool arg_initial)
+    : id(arg_id), inv(ConstraintTable::instance().intern(arg_inv)),
+      urgent(arg_urgent), initial(arg_initial) {}
 
-state::state(const state &other) {
-  id = other.id;
-  inv = other.inv->createCopy();
-  urgent = other.urgent;
-  initial = other.initial;
-}
-state::state(state &&other) noexcept {
-  id = std::move(other.id);
-  inv = std::move(other.inv->createCopy());
-  urgent = std::move(other.urgent);
-  initial = std::move(other.initial);
-}
-
-state &state::operator=(const state &other) {
-  *this = state(other);
-  return *this;
-}
-
-state &state::operator=(state &&other) noexcept {
-  swap(*this, other);
-  return *this;
-}
-
-transition::transition(const transition &other) {
-  source_id = other.source_id;
-  dest_id = other.dest_id;
-  action = other.action;
-  guard = other.guard->createCopy();
-  update = other.update;
-  sync = other.sync;
-  passive = other.passive;
-}
-
-transition::transition(transition &&other) noexcept {
-  source_id = std::move(other.source_id);
-  dest_id = std::move(other.dest_id);
-  action = std::move(other.action);
-  guard = std::move(other.guard);
-  update = std::move(other.update);
-  sync = std::move(other.sync);
-  passive = std::move(other.passive);
-}
-
-transition &transition::operator=(const transition &other) {
-  *this = transition(other);
-  return *this;
+bool state::operator<(const state &r) const {
+  if (id != r.id) {
+    return id < r.id;
+  }
+  return inv != r.inv && inv->compare(*r.inv) < 0;
 }
 
-transition &transition::operator=(transition &&other) noexcept {
-  swap(*this, other);
-  return *this;
+bool state::operator==(const state &r) const {
+  return id == r.id && (inv == r.inv || inv->compare(*r.inv) == 0);
 }
 
-bool state::operator<(const state &r) const {
-  return id + inv->toString() < r.id + r.inv->toString();
+::std::size_t state::hash() const {
+  return computils::hashCombine(std::hash<Symbol>()(id), inv->hash());
 }
 
-transition::transition(::std::string arg_source_id, ::std::string arg_dest_id,
+transition::transition(Symbol arg_source_id, Symbol arg_dest_id,
                        std::string arg_action, const ClockConstraint &arg_guard,
                        const update_t &arg_update, ::std::string arg_sync,
                        bool arg_passive)
     : source_id(arg_source_id), dest_id(arg_dest_id), action(arg_action),
-      update(arg_update), sync(arg_sync), passive(arg_passive) {
-  guard = arg_guard.createCopy();
-}
+      guard(ConstraintTable::instance().intern(arg_guard)), update(arg_update),
+      sync(arg_sync), passive(arg_passive) {}
 
 ::std::string transition::updateToString() const {
   std::string res;
@@ -161,16 +81,63 @@ update_t transition::updateFromString(const ::std::string &update,
   return res;
 }
 
+int transition::compare(const transition &r) const {
+  if (source_id != r.source_id) {
+    return source_id < r.source_id ? -1 : 1;
+  }
+  if (dest_id != r.dest_id) {
+    return dest_id < r.dest_id ? -1 : 1;
+  }
+  int res = guard == r.guard ? 0 : guard->compare(*r.guard);
+  if (res != 0) {
+    return res;
+  }
+  if (update.size() != r.update.size()) {
+    return update.size() < r.update.size() ? -1 : 1;
+  }
+  if (update != r.update) {
+    // update sets are ordered by pointers, compare the sorted clock ids
+    std::vector<Symbol> update_ids, r_update_ids;
+    for (const auto &cl : update) {
+      update_ids.push_back(cl->id);
+    }
+    for (const auto &cl : r.update) {
+      r_update_ids.push_back(cl->id);
+    }
+    std::sort(update_ids.begin(), update_ids.end());
+    std::sort(r_update_ids.begin(), r_update_ids.end());
+    if (update_ids != r_update_ids) {
+      return update_ids < r_update_ids ? -1 : 1;
+    }
+  }
+  return sync.compare(r.sync);
+}
+
 bool transition::operator<(const transition &r) const {
-  return source_id + dest_id + guard->toString() + updateToString() + sync <
-         r.source_id + r.dest_id + r.guard->toString() + r.updateToString() +
-             r.sync;
+  return compare(r) < 0;
+}
+
+bool transition::operator==(const transition &r) const {
+  return compare(r) == 0;
+}
+
+::std::size_t transition::hash() const {
+  std::size_t res = std::hash<Symbol>()(source_id);
+  res = computils::hashCombine(res, std::hash<Symbol>()(dest_id));
+  res = computils::hashCombine(res, guard->hash());
+  // order independent, as update sets are ordered by pointers
+  std::size_t update_hash = 0;
+  for (const auto &cl : update) {
+    update_hash += std::hash<Symbol>()(cl->id);
+  }
+  res = computils::hashCombine(res, update_hash);
+  return computils::hashCombine(res, std::hash<std::string>()(sync));
 }
 
 automaton::automaton(::std::vector<State> arg_states,
                      ::std::vector<Transition> arg_transitions,
                      ::std::string arg_prefix, bool setTrap) {
-  states = arg_states;
+  states = std::move(arg_states);
   if (setTrap == true && states.end() == find_if(states.begin(), states.end(),
                                                  [](const State &s) -> bool {
                                                    return s.id == "trap";
@@ -178,9 +145,134 @@ automaton::automaton(::std::vector<State> arg_states,
     TrueCC true_cc = TrueCC();
     states.push_back(State("trap", true_cc));
   }
-  transitions = arg_transitions;
+  transitions = std::move(arg_transitions);
   prefix = arg_prefix;
 }
 
-tlEntry::tlEntry(Automaton &arg_ta, ::std::vector<Transition> arg_trans_out)
-    : ta(arg_ta), trans_out(arg_trans_out) {}
+automaton::automaton(const automaton &other)
+    : states(other.states), transitions(other.transitions),
+      clocks(other.clocks), bool_vars(other.bool_vars), prefix(other.prefix) {}
+
+automaton::automaton(automaton &&other) noexcept
+    : states(std::move(other.states)),
+      transitions(std::move(other.transitions)),
+      clocks(std::move(other.clocks)), bool_vars(std::move(other.bool_vars)),
+      prefix(std::move(other.prefix)),
+      transition_index(std::atomic_load(&other.transition_index)) {
+  other.invalidateTransitionIndex();
+}
+
+automaton &automaton::operator=(const automaton &other) {
+  if (this != &other) {
+    states = other.states;
+    transitions = other.transitions;
+    clocks = other.clocks;
+    bool_vars = other.bool_vars;
+    prefix = other.prefix;
+    // the vectors may keep their storage and size, hence the old index would
+    // still pass TransitionIndex::isValidFor()
+    invalidateTransitionIndex();
+  }
+  return *this;
+}
+
+automaton &automaton::operator=(automaton &&other) noexcept {
+  if (this != &other) {
+    states = std::move(other.states);
+    transitions = std::move(other.transitions);
+    clocks = std::move(other.clocks);
+    bool_vars = std::move(other.bool_vars);
+    prefix = std::move(other.prefix);
+    std::atomic_store(&transition_index,
+                      std::atomic_load(&other.transition_index));
+    other.invalidateTransitionIndex();
+  }
+  return *this;
+}
+
+::std::shared_ptr<const TransitionIndex>
+automaton::getTransitionIndex() const {
+  std::shared_ptr<const TransitionIndex> res =
+      std::atomic_load(&transition_index);
+  if (!res || !res->isValidFor(*this)) {
+    res = std::make_shared<const TransitionIndex>(*this);
+    std::atomic_store(&transition_index, res);
+  }
+  return res;
+}
+
+void automaton::updateTransitionIndex() {
+  if (std::atomic_load(&transition_index)) {
+    std::atomic_store(&transition_index,
+                      std::make_shared<const TransitionIndex>(*this));
+  }
+}
+
+void automaton::invalidateTransitionIndex() {
+  std::atomic_store(&transition_index,
+                    std::shared_ptr<const TransitionIndex>());
+}
+
+TransitionIndex::TransitionIndex(const Automaton &ta)
+    : indexed_states(ta.states.data()),
+      indexed_transitions(ta.transitions.data()),
+      num_states(ta.states.size()), num_transitions(ta.transitions.size()) {
+  for (const auto &s : ta.states) {
+    state_indices.emplace(s.id, state_indices.size());
+  }
+  for (const auto &t : ta.transitions) {
+    state_indices.emplace(t.source_id, state_indices.size());
+    state_indices.emplace(t.dest_id, state_indices.size());
+  }
+  // count the degrees, then distribute the positions (counting sort)
+  out_offsets.assign(state_indices.size() + 1, 0);
+  in_offsets.assign(state_indices.size() + 1, 0);
+  for (const auto &t : ta.transitions) {
+    out_offsets[state_indices[t.source_id] + 1]++;
+    in_offsets[state_indices[t.dest_id] + 1]++;
+  }
+  for (std::size_t i = 1; i < out_offsets.size(); i++) {
+    out_offsets[i] += out_offsets[i - 1];
+    in_offsets[i] += in_offsets[i - 1];
+  }
+  out_positions.resize(ta.transitions.size());
+  in_positions.resize(ta.transitions.size());
+  std::vector<std::size_t> out_fill(out_offsets.begin(), out_offsets.end() - 1);
+  std::vector<std::size_t> in_fill(in_offsets.begin(), in_offsets.end() - 1);
+  for (std::size_t pos = 0; pos < ta.transitions.size(); pos++) {
+    const Transition &t = ta.transitions[pos];
+    out_positions[out_fill[state_indices[t.source_id]]++] = pos;
+    in_positions[in_fill[state_indices[t.dest_id]]++] = pos;
+  }
+}
+
+bool TransitionIndex::isValidFor(const Automaton &ta) const {
+  return ta.states.data() == indexed_states &&
+         ta.transitions.data() == indexed_transitions &&
+         ta.states.size() == num_states &&
+         ta.transitions.size() == num_transitions;
+}
+
+TransitionIndex::Range
+TransitionIndex::getRange(const ::std::vector<::std::size_t> &offsets,
+                          const ::std::vector<::std::size_t> &positions,
+                          const Symbol &id) const {
+  auto search = state_indices.find(id);
+  if (search == state_indices.end()) {
+    return Range{positions.data(), positions.data()};
+  }
+  return Range{positions.data() + offsets[search->second],
+               positions.data() + offsets[search->second + 1]};
+}
+
+TransitionIndex::Range TransitionIndex::outgoing(const Symbol &id) const {
+  return getRange(out_offsets, out_positions, id);
+}
+
+TransitionIndex::Range TransitionIndex::incoming(const Symbol &id) const {
+  return getRange(in_offsets, in_positions, id);
+}
+
+tlEntry::tlEntry(const Automaton &arg_ta,
+                 ::std::vector<Transition> arg_trans_out)
+    : ta(arg_ta), trans_out(std::move(arg_trans_out)) {}
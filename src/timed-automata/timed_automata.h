@@ -8,6 +8,8 @@
 #pragma once
 
 #include "../constraints/constraints.h"
+#include "symbol_table.h"
+#include <memory>
 #include <set>
 #include <string>
 #include <unordered_map>
@@ -22,49 +24,37 @@ namespace taptenc {
  */
 ///@{
 struct state {
-  ::std::string id;
-  ::std::unique_ptr<ClockConstraint> inv;
+  Symbol id;
+  /** Interned invariant, shared with all copies of the state. */
+  constraint_ptr_t inv;
   bool urgent;
   bool initial;
-  state(::std::string arg_id, const ClockConstraint &inv,
+  state(Symbol arg_id, const ClockConstraint &inv,
         bool arg_urgent = false, bool arg_initial = false);
-  ~state() = default;
-  /** Copy constructor that clones the uniquely managed resources. */
-  state(const state &other);
-  /** Move constructor that steals the uniquely managed resources. */
-  state(state &&other) noexcept;
-  /** Copy assignment using the copy constructor. */
-  state &operator=(const state &other);
-  /** Move assignment swapping all member contents. */
-  state &operator=(state &&other) noexcept;
-  /** Ordering operator determined by comparing string representations. */
+  /** Structural ordering by id and invariant. */
   bool operator<(const state &r) const;
+  /** Structural equality of id and invariant, consistent with operator<. */
+  bool operator==(const state &r) const;
+  /** Structural hash over id and invariant, consistent with operator==. */
+  ::std::size_t hash() const;
 };
 typedef struct state State;
 
 typedef ::std::set<::std::shared_ptr<Clock>> update_t;
 
 struct transition {
-  ::std::string source_id;
-  ::std::string dest_id;
+  Symbol source_id;
+  Symbol dest_id;
   ::std::string action;
-  ::std::unique_ptr<ClockConstraint> guard;
+  /** Interned guard, shared with all copies of the transition. */
+  constraint_ptr_t guard;
   update_t update;
   ::std::string sync;
   bool passive; // true: receiver of sync (?), false: emmitter of sync (!)
-  transition(::std::string arg_source_id, ::std::string arg_dest_id,
-             std::string arg_action, const ClockConstraint &guard,
+  transition(Symbol arg_source_id, Symbol arg_dest_id,
+             ::std::string arg_action, const ClockConstraint &guard,
              const update_t &arg_update, ::std::string arg_sync,
              bool arg_passive = false);
-  ~transition() = default;
-  /** Copy constructor that clones the uniquely managed resources. */
-  transition(const transition &other);
-  /** Move constructor that steals the uniquely managed resources. */
-  transition(transition &&other) noexcept;
-  /** Copy assignment using the copy constructor. */
-  transition &operator=(const transition &other);
-  /** Move assignment swapping all member contents. */
-  transition &operator=(transition &&other) noexcept;
   /** Composes a string containing all clock updates. */
   ::std::string updateToString() const;
   /**
@@ -77,21 +67,137 @@ struct transition {
    */
   static update_t updateFromString(const ::std::string &update,
                                    const update_t &clocks);
-  /** Ordering operator determined by comparing string representations. */
+  /** Structural ordering by source, destination, guard, update and sync. */
   bool operator<(const transition &r) const;
+  /** Structural equality, consistent with operator<. */
+  bool operator==(const transition &r) const;
+  /** Structural hash, consistent with operator==. */
+  ::std::size_t hash() const;
+  /**
+   * Three-way structural comparison of source, destination, guard, update and
+   * sync.
+   *
+   * @param r transition to compare against
+   * @return negative, zero or positive value if this is ordered before, equal
+   *         to or after \a r
+   */
+  int compare(const transition &r) const;
 };
 typedef struct transition Transition;
 
+struct automaton;
+
+/**
+ * Compressed sparse row (CSR) index over the transitions of an automaton.
+ *
+ * States (and transition endpoints that are no states) are numbered densely,
+ * the outgoing and incoming transitions of each state are stored as
+ * contiguous ranges of positions within Automaton::transitions, preserving
+ * the order of the transitions. Hence, looking up the transitions of a state
+ * takes O(degree) instead of scanning all transitions.
+ */
+class TransitionIndex {
+public:
+  /** Positions of the transitions adjacent to a state. */
+  struct Range {
+    const ::std::size_t *first;
+    const ::std::size_t *last;
+    const ::std::size_t *begin() const { return first; }
+    const ::std::size_t *end() const { return last; }
+    ::std::size_t size() const { return last - first; }
+    bool empty() const { return first == last; }
+  };
+
+private:
+  ::std::unordered_map<Symbol, ::std::size_t> state_indices;
+  ::std::vector<::std::size_t> out_offsets;
+  ::std::vector<::std::size_t> out_positions;
+  ::std::vector<::std::size_t> in_offsets;
+  ::std::vector<::std::size_t> in_positions;
+  /** Data and sizes of the indexed vectors, to detect modifications. */
+  const State *indexed_states;
+  const Transition *indexed_transitions;
+  ::std::size_t num_states;
+  ::std::size_t num_transitions;
+
+  Range getRange(const ::std::vector<::std::size_t> &offsets,
+                 const ::std::vector<::std::size_t> &positions,
+                 const Symbol &id) const;
+
+public:
+  /**
+   * Builds the index in O(|states| + |transitions|).
+   *
+   * @param ta automaton to index
+   */
+  TransitionIndex(const struct automaton &ta);
+
+  /**
+   * Checks whether the index still matches an automaton.
+   *
+   * Only detects modifications that reallocate or resize the state or
+   * transition vector (e.g. adding transitions), other modifications have to
+   * invalidate the index explicitly (see
+   * automaton::invalidateTransitionIndex()).
+   *
+   * @param ta automaton to check
+   * @return true iff \a ta is the indexed automaton and was not resized since
+   */
+  bool isValidFor(const struct automaton &ta) const;
+
+  /** Returns the positions of transitions with source \a id. */
+  Range outgoing(const Symbol &id) const;
+  /** Returns the positions of transitions with destination \a id. */
+  Range incoming(const Symbol &id) const;
+};
+
 struct automaton {
   ::std::vector<State> states;
   ::std::vector<Transition> transitions;
   ::std::set<::std::shared_ptr<Clock>> clocks;
   ::std::vector<::std::string> bool_vars;
   ::std::string prefix;
+  /**
+   * Transition index, built on demand by getTransitionIndex().
+   * Accessed atomically, as automata are shared between encoding threads.
+   */
+  mutable ::std::shared_ptr<const TransitionIndex> transition_index;
 
   automaton(::std::vector<State> arg_states,
             ::std::vector<Transition> arg_transitions, ::std::string arg_prefix,
             bool setTrap = true);
+  /**
+   * Copies an automaton, the copy builds its own transition index on demand
+   * as the index refers to the vectors of the indexed automaton.
+   */
+  automaton(const automaton &other);
+  /** Moves an automaton together with its transition index. */
+  automaton(automaton &&other) noexcept;
+  automaton &operator=(const automaton &other);
+  automaton &operator=(automaton &&other) noexcept;
+
+  /**
+   * Returns the transition index of the automaton, (re-)building it if there
+   * is none yet or if the automaton was resized since.
+   *
+   * The returned index is only meaningful until the automaton is modified.
+   * Modifications that change the ids or the order of states or transitions
+   * without resizing the vectors have to call invalidateTransitionIndex() or
+   * updateTransitionIndex() afterwards.
+   *
+   * @return index of the transitions of this automaton
+   */
+  ::std::shared_ptr<const TransitionIndex> getTransitionIndex() const;
+  /**
+   * Rebuilds the transition index if it was requested before, such that
+   * in-place modifications keep it available.
+   */
+  void updateTransitionIndex();
+  /**
+   * Drops the transition index, it is rebuilt by the next call to
+   * getTransitionIndex().
+   */
+  void invalidateTransitionIndex();
 };
 typedef struct automaton Automaton;
 ///@}
@@ -128,6 +234,44 @@ struct automataSystem {
 typedef struct automataSystem AutomataSystem;
 ///@}
 
+/**
+ * Value with copy-on-write semantics.
+ *
+ * Copies share the underlying value until one of them is modified via
+ * write(), which detaches the modified copy first. Hence, copying is cheap
+ * and copies never observe modifications of each other.
+ *
+ * References returned by write() are only valid until the value is copied
+ * again, afterwards write() has to be called again before modifying it.
+ *
+ * @tparam T copyable type of the stored value
+ */
+template <typename T> class CopyOnWrite {
+private:
+  ::std::shared_ptr<T> value;
+
+public:
+  CopyOnWrite(T arg_value)
+      : value(::std::make_shared<T>(::std::move(arg_value))) {}
+  /** Read access to the (possibly shared) value. */
+  const T &operator*() const { return *value; }
+  /** Read access to the members of the (possibly shared) value. */
+  const T *operator->() const { return value.get(); }
+  /** Read access to the (possibly shared) value. */
+  operator const T &() const { return *value; }
+  /**
+   * Write access to the value, that is copied first if it is shared.
+   *
+   * @return value that is exclusively owned by this instance
+   */
+  T &write() {
+    if (value.use_count() > 1) {
+      value = ::std::make_shared<T>(*value);
+    }
+    return *value;
+  }
+};
+
 /**
  * @name Encoding related declarations to store automata copies
  *  - TlEntry (a TA copy together with outgoing transitions)
@@ -135,13 +279,28 @@ typedef struct automataSystem AutomataSystem;
  *  - TimeLines (a set with TimeLine elements)
  */
 ///@{
+/**
+ * Automata copy together with its outgoing transitions.
+ *
+ * Both parts are copy-on-write, such that copies of timelines (e.g. windows
+ * or snapshots of an encoding) share all entries that are not modified.
+ */
 struct tlEntry {
-  Automaton ta;
-  ::std::vector<Transition> trans_out;
-  tlEntry(Automaton &arg_ta, ::std::vector<Transition> arg_trans_out);
+  CopyOnWrite<Automaton> ta;
+  CopyOnWrite<::std::vector<Transition>> trans_out;
+  tlEntry(const Automaton &arg_ta, ::std::vector<Transition> arg_trans_out);
 };
 typedef struct tlEntry TlEntry;
 typedef ::std::unordered_map<::std::string, TlEntry> TimeLine;
 typedef ::std::unordered_map<::std::string, TimeLine> TimeLines;
 ///@}
 } // end namespace taptenc
+
+namespace std {
+template <> struct hash<::taptenc::State> {
+  size_t operator()(const ::taptenc::State &s) const { return s.hash(); }
+};
+template <> struct hash<::taptenc::Transition> {
+  size_t operator()(const ::taptenc::Transition &t) const { return t.hash(); }
+};
+} // end namespace std
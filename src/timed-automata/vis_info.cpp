@@ -82,13 +82,13 @@ systemVisInfo::systemVisInfo(const TimeLines &direct_encoding,
       int max_x_offset = 0;
       for (const auto &entity : search->second) {
         int min_x_offset = x_offset;
-        auto si = this->generateStateInfo(entity.second.ta.states, x_offset,
+        auto si = this->generateStateInfo(entity.second.ta->states, x_offset,
                                           y_offset);
         max_x_offset = std::max(x_offset, max_x_offset);
         x_offset = min_x_offset;
         m_state_info[0].insert(si.begin(), si.end());
         y_offset += COMPONENT_Y_SHIFT;
-        auto ti = this->generateTransitionInfo(entity.second.ta.transitions,
+        auto ti = this->generateTransitionInfo(entity.second.ta->transitions,
                                                m_state_info.back());
         m_transition_info[0].insert(ti.begin(), ti.end());
       }
@@ -101,9 +101,9 @@ systemVisInfo::systemVisInfo(const TimeLines &direct_encoding,
   if (search != direct_encoding.end()) {
     for (const auto &entity : search->second) {
       auto si =
-          this->generateStateInfo(entity.second.ta.states, x_offset, y_offset);
+          this->generateStateInfo(entity.second.ta->states, x_offset, y_offset);
       m_state_info[0].insert(si.begin(), si.end());
-      auto ti = this->generateTransitionInfo(entity.second.ta.transitions,
+      auto ti = this->generateTransitionInfo(entity.second.ta->transitions,
                                              m_state_info.back());
       m_transition_info[0].insert(ti.begin(), ti.end());
     }
@@ -1,26 +1,31 @@
 #include "transformation.h"
-#include "vis_info.h"
+#include "constants.h"
 #include "encoders.h"
+#include "encoding_cache.h"
+#include "merge_planner.h"
 #include "plan_ordered_tls.h"
-#include "uppaal_calls.h"
 #include "utap_trace_parser.h"
 #include "utap_xml_parser.h"
-#include "printer.h"
+#include "thread_pool.h"
+#include "report.h"
+#include "logging.h"
+#include <chrono>
 #include <algorithm>
 #include <iostream>
 #include <cassert>
+#include <future>
+#include <memory>
 #include <stdexcept>
 
 using namespace taptenc;
 
 
-DirectEncoder transformation::createDirectEncoding(
-    AutomataSystem &direct_system, const std::vector<PlanAction> &plan,
-    const std::vector<std::unique_ptr<EncICInfo>> &constraints, int plan_index) {
-  DirectEncoder enc(direct_system, plan);
+std::vector<transformation::EncodingStep> transformation::collectEncodingSteps(
+    const Automaton &plan_ta, const std::vector<PlanAction> &plan,
+    const std::vector<std::unique_ptr<EncICInfo>> &constraints) {
+  std::vector<EncodingStep> steps;
   for (const auto &gamma : constraints) {
-    for (auto pa = direct_system.instances[plan_index].first.states.begin();
-         pa != direct_system.instances[plan_index].first.states.end(); ++pa) {
+    for (auto pa = plan_ta.states.begin(); pa != plan_ta.states.end(); ++pa) {
 			std::string pa_op = pa->id;
       if (pa->id != constants::START_PA && pa->id != constants::END_PA) {
         pa_op = Filter::getPrefix(pa->id, constants::PA_SEP);
@@ -38,166 +43,469 @@ DirectEncoder transformation::createDirectEncoding(
                    plan_action_it->name.toString();
           });
       auto is_active = gamma->activations.end() != pa_trigger;
-      if (is_active) {
-        switch (gamma->type) {
-        case ICType::Future: {
-          UnaryInfo *info = dynamic_cast<UnaryInfo *>(gamma.get());
-          enc.encodeFuture(direct_system, pa->id, *info);
-        } break;
-        case ICType::Until: {
-          BinaryInfo *info = dynamic_cast<BinaryInfo *>(gamma.get());
-          enc.encodeUntil(direct_system, pa->id, *info);
-        } break;
-        case ICType::Since: {
-          BinaryInfo *info = dynamic_cast<BinaryInfo *>(gamma.get());
-          enc.encodeSince(direct_system, pa->id, *info);
-        } break;
-        case ICType::Past: {
-          UnaryInfo *info = dynamic_cast<UnaryInfo *>(gamma.get());
-          enc.encodePast(direct_system, pa->id, *info);
-        } break;
-        case ICType::NoOp: {
-          UnaryInfo *info = dynamic_cast<UnaryInfo *>(gamma.get());
-          enc.encodeNoOp(direct_system, info->specs.targets, pa->id);
-        } break;
-        case ICType::Invariant: {
-          UnaryInfo *info = dynamic_cast<UnaryInfo *>(gamma.get());
-          enc.encodeInvariant(direct_system, info->specs.targets, pa->id);
-        } break;
-        case ICType::UntilChain: {
-          ChainInfo *info = dynamic_cast<ChainInfo *>(gamma.get());
-          for (auto epa = pa + 1;
-               epa != direct_system.instances[plan_index].first.states.end();
-               ++epa) {
-						std::string epa_op = Filter::getPrefix(epa->id, constants::PA_SEP);
-            auto eplan_action_it = std::find_if(
-                plan.begin(), plan.end(), [epa_op](const auto &act) {
-                  return act.name.toString() == epa_op;
-                });
-            if (eplan_action_it == plan.end()) {
-              break;
-            }
+      if (!is_active) {
+        continue;
+      }
+      if (gamma->type != ICType::UntilChain) {
+        steps.push_back(EncodingStep{gamma.get(), pa->id, ""});
+        continue;
+      }
+      // until chains additionally need the plan action ending them
+      ChainInfo *info = dynamic_cast<ChainInfo *>(gamma.get());
+      for (auto epa = pa + 1; epa != plan_ta.states.end(); ++epa) {
+				std::string epa_op = Filter::getPrefix(epa->id, constants::PA_SEP);
+        auto eplan_action_it = std::find_if(
+            plan.begin(), plan.end(), [epa_op](const auto &act) {
+              return act.name.toString() == epa_op;
+            });
+        if (eplan_action_it == plan.end()) {
+          break;
+        }
 
-            auto epa_trigger = std::find_if(
-                info->activations_end.begin(), info->activations_end.end(),
-                [epa_op, eplan_action_it](const auto &act) {
-                  return act.ground(eplan_action_it->name.args).toString() ==
-                         eplan_action_it->name.toString();
-                });
-            bool match_found = info->activations_end.end() != epa_trigger;
-            if (match_found) {
-              if (epa_trigger->args.size() != pa_trigger->args.size()) {
-                // std::cout << "wrong argument length" << std::endl;
-                // they only really match if they have the same number of args
-                // this is not true in the general case, but for benchmarks
-                // it is sufficient
-                break;
-              }
-              bool missmatch = false;
-              for (unsigned long i = 0; i < epa_trigger->args.size(); i++) {
-                if (epa_trigger->args[i][0] == constants::VAR_PREFIX) {
-                  for (unsigned long j = 0; j < pa_trigger->args.size(); j++) {
-                    if (pa_trigger->args[j] == epa_trigger->args[i] &&
-                        eplan_action_it->name.args[i] !=
-                            plan_action_it->name.args[j]) {
-                      // std::cout << "missmatch found: " << pa_trigger->args[j] << "
-                      // "
-                      //           << epa_trigger->args[i] << std::endl;
-                      // std::cout << eplan_action_it->name.args[i] << " vs "
-                      //           << plan_action_it->name.args[j] << std::endl;
-                      // std::cout << pa_trigger->toString() << " vs "
-                      //           << epa_trigger->toString() << std::endl;
-                      missmatch = true;
-                      break;
-                    }
-                  }
+        auto epa_trigger = std::find_if(
+            info->activations_end.begin(), info->activations_end.end(),
+            [epa_op, eplan_action_it](const auto &act) {
+              return act.ground(eplan_action_it->name.args).toString() ==
+                     eplan_action_it->name.toString();
+            });
+        bool match_found = info->activations_end.end() != epa_trigger;
+        if (match_found) {
+          if (epa_trigger->args.size() != pa_trigger->args.size()) {
+            // std::cout << "wrong argument length" << std::endl;
+            // they only really match if they have the same number of args
+            // this is not true in the general case, but for benchmarks
+            // it is sufficient
+            break;
+          }
+          bool missmatch = false;
+          for (unsigned long i = 0; i < epa_trigger->args.size(); i++) {
+            if (epa_trigger->args[i][0] == constants::VAR_PREFIX) {
+              for (unsigned long j = 0; j < pa_trigger->args.size(); j++) {
+                if (pa_trigger->args[j] == epa_trigger->args[i] &&
+                    eplan_action_it->name.args[i] !=
+                        plan_action_it->name.args[j]) {
+                  // std::cout << "missmatch found: " << pa_trigger->args[j] << "
+                  // "
+                  //           << epa_trigger->args[i] << std::endl;
+                  // std::cout << eplan_action_it->name.args[i] << " vs "
+                  //           << plan_action_it->name.args[j] << std::endl;
+                  // std::cout << pa_trigger->toString() << " vs "
+                  //           << epa_trigger->toString() << std::endl;
+                  missmatch = true;
+                  break;
                 }
               }
-              if (!missmatch) {
-                enc.encodeUntilChain(direct_system, *info, pa->id, epa->id);
-                break;
-              } else {
-              }
-            }
-            bool is_tightest =
-                gamma->activations.end() ==
-                std::find_if(
-                    gamma->activations.begin(), gamma->activations.end(),
-                    [eplan_action_it](const ActionName &s) {
-                      return s.ground(eplan_action_it->name.args).toString() ==
-                             eplan_action_it->name.toString();
-                    });
-            if (!is_tightest) {
-              break;
             }
           }
-        } break;
-        default:
-          throw std::runtime_error("error: no support yet for type ");
+          if (!missmatch) {
+            steps.push_back(EncodingStep{gamma.get(), pa->id, epa->id});
+            break;
+          } else {
+          }
+        }
+        bool is_tightest =
+            gamma->activations.end() ==
+            std::find_if(
+                gamma->activations.begin(), gamma->activations.end(),
+                [eplan_action_it](const ActionName &s) {
+                  return s.ground(eplan_action_it->name.args).toString() ==
+                         eplan_action_it->name.toString();
+                });
+        if (!is_tightest) {
+          break;
         }
       }
     }
   }
-  return enc;
+  return steps;
+}
+
+void transformation::applyEncodingStep(DirectEncoder &enc,
+                                       AutomataSystem &direct_system,
+                                       const EncodingStep &step,
+                                       Report *report) {
+  const EncICInfo *gamma = step.info;
+  EncodingSize size_before;
+  size_t clocks_before = direct_system.globals.clocks.size();
+  if (report != nullptr) {
+    size_before = PlanOrderedTLs::totalSize(enc.getTlSizes());
+  }
+  ScopedTimer timer(report, "encoding/" + toString(gamma->type));
+  switch (gamma->type) {
+  case ICType::Future: {
+    const UnaryInfo *info = dynamic_cast<const UnaryInfo *>(gamma);
+    enc.encodeFuture(direct_system, step.pa, *info);
+  } break;
+  case ICType::Until: {
+    const BinaryInfo *info = dynamic_cast<const BinaryInfo *>(gamma);
+    enc.encodeUntil(direct_system, step.pa, *info);
+  } break;
+  case ICType::Since: {
+    const BinaryInfo *info = dynamic_cast<const BinaryInfo *>(gamma);
+    enc.encodeSince(direct_system, step.pa, *info);
+  } break;
+  case ICType::Past: {
+    const UnaryInfo *info = dynamic_cast<const UnaryInfo *>(gamma);
+    enc.encodePast(direct_system, step.pa, *info);
+  } break;
+  case ICType::NoOp: {
+    const UnaryInfo *info = dynamic_cast<const UnaryInfo *>(gamma);
+    enc.encodeNoOp(direct_system, info->specs.targets, step.pa);
+  } break;
+  case ICType::Invariant: {
+    const UnaryInfo *info = dynamic_cast<const UnaryInfo *>(gamma);
+    enc.encodeInvariant(direct_system, info->specs.targets, step.pa);
+  } break;
+  case ICType::UntilChain: {
+    const ChainInfo *info = dynamic_cast<const ChainInfo *>(gamma);
+    enc.encodeUntilChain(direct_system, *info, step.pa, step.end_pa);
+  } break;
+  default:
+    throw std::runtime_error("error: no support yet for type ");
+  }
+  timer.stop();
+  if (report != nullptr) {
+    std::string counter = "encoding/" + toString(gamma->type);
+    EncodingSize size_after = PlanOrderedTLs::totalSize(enc.getTlSizes());
+    // encodings may also shrink (e.g. by filtering), hence signed
+    auto delta = [](size_t after, size_t before) {
+      return static_cast<long>(after) - static_cast<long>(before);
+    };
+    report->addCount(counter + "/calls");
+    report->addCount(counter + "/states",
+                     delta(size_after.states, size_before.states));
+    report->addCount(counter + "/transitions",
+                     delta(size_after.transitions, size_before.transitions));
+    report->addCount(counter + "/copies",
+                     delta(size_after.copies, size_before.copies));
+    report->addCount(counter + "/clocks",
+                     delta(direct_system.globals.clocks.size(), clocks_before));
+  }
 }
 
+DirectEncoder transformation::createDirectEncoding(
+    AutomataSystem &direct_system, const std::vector<PlanAction> &plan,
+    const std::vector<std::unique_ptr<EncICInfo>> &constraints, int plan_index,
+    Report *report) {
+  DirectEncoder enc(direct_system, plan);
+  for (const auto &step : collectEncodingSteps(
+           direct_system.instances[plan_index].first, plan, constraints)) {
+    applyEncodingStep(enc, direct_system, step, report);
+  }
+  return enc;
+}
 
-timed_trace_t transformation::transform_plan(const std::vector<PlanAction> &plan, const std::vector<Automaton> &platform_models, const Constraints &platform_constraints) {
-	assert(platform_models.size() == platform_constraints.size());
-	XMLPrinter printer;
-    DirectEncoder merge_enc;
-	  AutomataSystem merged_system;
-    Automaton product_ta = platform_models[0];
-    AutomataSystem base_system;
-		Automaton plan_ta = platform_models[0];
-		std::cout << platform_models.size() << std::endl;
+timed_trace_t
+transformation::transform_plan(const std::vector<PlanAction> &plan,
+                               const std::vector<Automaton> &platform_models,
+                               const Constraints &platform_constraints,
+                               Solver &solver, unsigned int num_workers,
+                               MergeStrategy strategy, Report *report,
+                               EncodingCache *cache) {
+  assert(platform_models.size() == platform_constraints.size());
+  assert(platform_models.size() > 0);
+  ScopedTimer total_timer(report, "total");
+  // fingerprints identifying the sub-problems of each platform and the
+  // whole transformation
+  std::vector<std::string> encoding_fingerprints;
+  std::string problem_fingerprint;
+  if (cache != nullptr) {
+    std::string plan_fingerprint = EncodingCache::fingerprint(plan);
+    problem_fingerprint = plan_fingerprint;
     for (long unsigned int j = 0; j < platform_models.size(); j++) {
+      std::string platform_fingerprint =
+          EncodingCache::fingerprint(platform_models[j]) +
+          EncodingCache::fingerprint(platform_constraints[j]);
+      encoding_fingerprints.push_back(plan_fingerprint + platform_fingerprint);
+      problem_fingerprint += platform_fingerprint;
+    }
+    timed_trace_t cached_solution;
+    if (cache->findSolution(problem_fingerprint, cached_solution)) {
+      TAPTENC_LOG_INFO("transform_plan: reusing cached solution");
+      if (report != nullptr) {
+        report->addCount("cache/solution_hits");
+      }
+      return cached_solution;
+    }
+  }
+  ScopedTimer encoding_timer(report, "encoding");
+  // with a single worker everything runs sequentially on the calling thread
+  ThreadPool pool(num_workers > 1 ? num_workers : 0);
+  // encode each platform ta independently
+  std::vector<std::future<std::pair<DirectEncoder, AutomataSystem>>>
+      encodings;
+  for (long unsigned int j = 0; j < platform_models.size(); j++) {
+    encodings.push_back(pool.submit([&plan, &platform_models,
+                                     &platform_constraints,
+                                     &encoding_fingerprints, j, report,
+                                     cache]() {
+      if (cache != nullptr) {
+        auto cached = cache->findEncoding(encoding_fingerprints[j]);
+        if (cached != nullptr) {
+          if (report != nullptr) {
+            report->addCount("cache/encoding_hits");
+          }
+          return std::make_pair(cached->first.copy(), cached->second);
+        }
+      }
       AutomataSystem base_system;
       base_system.instances.push_back(std::make_pair(platform_models[j], ""));
-			// encode the j-th platform ta
-      DirectEncoder curr_encoder =
-          transformation::createDirectEncoding(base_system, plan, platform_constraints[j]);
-        if (j > 0) {
-          product_ta = PlanOrderedTLs::productTA(product_ta, platform_models[j],
-                                                 "product", true);
-			// merge the encoding of the j-th platform ta into the full encoding
-			std::cout << "start merging of the " << j << "-th encoding" << std::endl;
-        merge_enc = merge_enc.mergeEncodings(curr_encoder);
-			std::cout << "done" << std::endl;
-        } else {
-				// init the full encoding with the instances of the first encoding
-        merged_system.instances = base_system.instances;
-				merge_enc = curr_encoder.copy();
-				plan_ta = base_system.instances[curr_encoder.getPlanTAIndex()].first;
+      DirectEncoder curr_encoder = transformation::createDirectEncoding(
+          base_system, plan, platform_constraints[j], 1, report);
+      auto res =
+          std::make_pair(std::move(curr_encoder), std::move(base_system));
+      if (cache != nullptr) {
+        cache->storeEncoding(encoding_fingerprints[j], res);
       }
-			// extract all clocks from the transformed system
-      SystemVisInfo tmp_vis_info;
-      AutomataSystem direct_system =
-          curr_encoder.createFinalSystem(base_system, tmp_vis_info);
-				std::cout << "curr " << j << " num states:"
-             << direct_system.instances[0].first.states.size()
-             << std::endl;
-      merged_system.globals.clocks.insert(direct_system.globals.clocks.begin(),
-                                          direct_system.globals.clocks.end());
+      return res;
+    }));
+  }
+  AutomataSystem merged_system;
+  Automaton plan_ta = platform_models[0];
+  // nodes of the merge plan: pairs of encoding and the product of the
+  // platform tas it covers, released as soon as they are merged further
+  std::vector<std::unique_ptr<std::pair<DirectEncoder, Automaton>>> nodes;
+  std::vector<TlSizes> enc_sizes;
+  for (long unsigned int j = 0; j < encodings.size(); j++) {
+    auto encoding = encodings[j].get();
+    if (j == 0) {
+      // init the full encoding with the instances of the first encoding
+      merged_system.instances = encoding.second.instances;
+      plan_ta =
+          encoding.second.instances[encoding.first.getPlanTAIndex()].first;
     }
-			std::cout << "finished loop" << std::endl;
-      SystemVisInfo merged_system_vis_info;
-			// finalize the encoding and obtain the visual information for printing
-        AutomataSystem final_merged_system =
-            merge_enc.createFinalSystem(merged_system, merged_system_vis_info);
-			  std::cout << "start printing" << std::endl;
-				std::cout << "merged num states:"
-             << final_merged_system.instances[0].first.states.size()
-             << std::endl;
-				// print encoded ta to xml
-        printer.print(final_merged_system, merged_system_vis_info,
-                      "merged.xml");
-				// solve the encoded reachability problem
-        auto uppaal_time = uppaalcalls::solve("merged");
-        UTAPTraceParser trace_parser = UTAPTraceParser(final_merged_system);
-        // retrieve the solution trace
-        trace_parser.parseTraceInfo("merged.trace");
-        return trace_parser.getTimedTrace(
-            product_ta,
-            plan_ta);
+    // extract all clocks from the transformed system
+    merged_system.globals.clocks.insert(
+        encoding.second.globals.clocks.begin(),
+        encoding.second.globals.clocks.end());
+    enc_sizes.push_back(encoding.first.getTlSizes());
+    nodes.push_back(std::make_unique<std::pair<DirectEncoder, Automaton>>(
+        std::move(encoding.first), platform_models[j]));
+  }
+  encoding_timer.stop();
+  ScopedTimer merging_timer(report, "merging");
+  std::vector<MergeStep> merge_plan =
+      mergeplanner::planMerges(enc_sizes, strategy);
+  EncodingSize predicted_peak = mergeplanner::predictPeakSize(merge_plan);
+  TAPTENC_LOG_INFO("merge plan (" << mergeplanner::toString(strategy) << "): "
+                   << merge_plan.size() << " steps, predicted peak states: "
+                   << predicted_peak.states << " transitions: "
+                   << predicted_peak.transitions);
+  // execute all independent merges of the same depth concurrently
+  size_t num_inputs = nodes.size();
+  nodes.resize(num_inputs + merge_plan.size());
+  size_t max_depth = 0;
+  for (const auto &step : merge_plan) {
+    max_depth = std::max(max_depth, step.depth);
+  }
+  for (size_t depth = 1; depth <= max_depth; depth++) {
+    std::vector<size_t> level;
+    std::vector<std::future<std::pair<DirectEncoder, Automaton>>> merged;
+    for (size_t i = 0; i < merge_plan.size(); i++) {
+      if (merge_plan[i].depth != depth) {
+        continue;
+      }
+      const auto &left = *nodes[merge_plan[i].left];
+      const auto &right = *nodes[merge_plan[i].right];
+      level.push_back(i);
+      merged.push_back(pool.submit([&left, &right]() {
+        return std::make_pair(
+            left.first.mergeEncodings(right.first),
+            PlanOrderedTLs::productTA(left.second, right.second, "product",
+                                      true));
+      }));
+    }
+    for (size_t k = 0; k < level.size(); k++) {
+      const MergeStep &step = merge_plan[level[k]];
+      auto &res = nodes[num_inputs + level[k]];
+      res = std::make_unique<std::pair<DirectEncoder, Automaton>>(
+          merged[k].get());
+      EncodingSize predicted = PlanOrderedTLs::totalSize(step.predicted);
+      EncodingSize actual = PlanOrderedTLs::totalSize(res->first.getTlSizes());
+      TAPTENC_LOG_INFO("merge " << step.left << " + " << step.right << " -> "
+                       << num_inputs + level[k] << ": predicted states: "
+                       << predicted.states << " transitions: "
+                       << predicted.transitions << ", actual states: "
+                       << actual.states << " transitions: "
+                       << actual.transitions);
+    }
+    for (size_t i : level) {
+      nodes[merge_plan[i].left].reset();
+      nodes[merge_plan[i].right].reset();
+    }
+  }
+  DirectEncoder &merge_enc = nodes.back()->first;
+  const Automaton &product_ta = nodes.back()->second;
+  merging_timer.stop();
+  if (report != nullptr) {
+    TlSizes merged_sizes = merge_enc.getTlSizes();
+    EncodingSize merged_size = PlanOrderedTLs::totalSize(merged_sizes);
+    report->addCount("platforms", num_inputs);
+    report->addCount("merging/steps", merge_plan.size());
+    report->addCount("merging/predicted_peak_states", predicted_peak.states);
+    report->addCount("merging/states", merged_size.states);
+    report->addCount("merging/transitions", merged_size.transitions);
+    report->addCount("merging/copies", merged_size.copies);
+    report->addCount("merging/timelines", merged_sizes.size());
+  }
+  // finalize the encoding, the result is only passed to the solver, hence
+  // no visual information is needed
+  ScopedTimer final_timer(report, "createFinalSystem");
+  AutomataSystem final_merged_system =
+      merge_enc.createFinalSystem(merged_system);
+  final_timer.stop();
+  const Automaton &final_ta = final_merged_system.instances[0].first;
+  TAPTENC_LOG_INFO("merged num states:" << final_ta.states.size());
+  if (report != nullptr) {
+    report->addCount("createFinalSystem/states", final_ta.states.size());
+    report->addCount("createFinalSystem/transitions",
+                     final_ta.transitions.size());
+    report->addCount("createFinalSystem/clocks",
+                     final_merged_system.globals.clocks.size() +
+                         final_ta.clocks.size());
+  }
+  // solve the encoded reachability problem
+  ScopedTimer solving_timer(report, "solving");
+  SolverResult solution = solver.solve(final_merged_system, constants::QUERY);
+  solving_timer.stop();
+  for (const auto &timing : solution.timings) {
+    TAPTENC_LOG_INFO(solver.getName() << " " << timing.first << ": "
+                     << timing.second.count() << " ms");
+    if (report != nullptr) {
+      report->addTime("solving/" + timing.first,
+                      std::chrono::duration_cast<Report::duration>(
+                          timing.second));
+    }
+  }
+  if (report != nullptr) {
+    report->addCount("solving/reachable",
+                     solution.status == SolverStatus::Reachable);
+    report->addCount("solving/trace_length", solution.trace.transitions.size());
+  }
+  if (solution.status == SolverStatus::Unknown) {
+    TAPTENC_LOG_ERROR("transform_plan: " << solver.getName()
+                      << " could not solve the query");
+    return timed_trace_t();
+  }
+  if (solution.status == SolverStatus::Unreachable) {
+    TAPTENC_LOG_WARN("transform_plan: query not reachable, no valid "
+                     "transformation found");
+    // only proven infeasibility is remembered, failures may be transient
+    if (cache != nullptr) {
+      cache->storeSolution(problem_fingerprint, timed_trace_t());
+    }
+    return timed_trace_t();
+  }
+  ScopedTimer parsing_timer(report, "trace parsing");
+  UTAPTraceParser trace_parser = UTAPTraceParser(final_merged_system);
+  // retrieve the solution trace
+  trace_parser.loadTrace(solution.trace);
+  timed_trace_t res = trace_parser.getTimedTrace(product_ta, plan_ta);
+  if (cache != nullptr) {
+    cache->storeSolution(problem_fingerprint, res);
+  }
+  return res;
+}
+
+namespace {
+/** Checks whether two plan actions result in the same timelines. */
+bool samePlanAction(const PlanAction &a, const PlanAction &b) {
+  return a.name.toString() == b.name.toString() &&
+         a.absolute_time == b.absolute_time && a.duration == b.duration &&
+         a.delay_tolerance == b.delay_tolerance;
+}
+} // end anonymous namespace
+
+transformation::IncrementalEncoder::IncrementalEncoder(
+    const Automaton &arg_platform_model,
+    const std::vector<std::unique_ptr<EncICInfo>> &arg_constraints,
+    size_t arg_checkpoint_interval)
+    : platform_model(arg_platform_model), constraints(arg_constraints),
+      checkpoint_interval(std::max<size_t>(arg_checkpoint_interval, 1)) {}
+
+void transformation::IncrementalEncoder::encode(
+    const std::vector<PlanAction> &new_plan, Report *report) {
+  assert(new_plan.size() > 0);
+  size_t common = 0;
+  while (common < plan.size() && common < new_plan.size() &&
+         samePlanAction(plan[common], new_plan[common])) {
+    common++;
+  }
+  if (common == plan.size() && common == new_plan.size()) {
+    reused_steps += encoded_steps;
+    encoded_steps = 0;
+    return;
+  }
+  // timeline i belongs to plan action i - 1 (timeline 0 to the start), its
+  // invariant depends on the successor, hence at most the timelines before
+  // the first changed plan action can be kept
+  while (!checkpoints.empty() && checkpoints.back().boundary > common) {
+    checkpoints.pop_back();
+  }
+  size_t boundary = 0;
+  if (!checkpoints.empty()) {
+    const Checkpoint &restore = checkpoints.back();
+    boundary = restore.boundary;
+    system = restore.system;
+    encoder = restore.encoder.copy();
+    encoder.replacePlanSuffix(system, new_plan, boundary);
+  } else {
+    system = AutomataSystem();
+    system.instances.push_back(std::make_pair(platform_model, ""));
+    encoder = DirectEncoder(system, new_plan);
+  }
+  plan = new_plan;
+  std::vector<EncodingStep> steps = collectEncodingSteps(
+      system.instances[encoder.getPlanTAIndex()].first, plan, constraints);
+  // apply the steps in the order of the last timeline they affect, such that
+  // the encoding at a boundary only depends on the plan prefix before it
+  std::vector<std::pair<size_t, const EncodingStep *>> ordered;
+  for (const auto &step : steps) {
+    ordered.push_back(std::make_pair(
+        encoder.lastAffectedTimeLine(*step.info, step.pa, step.end_pa),
+        &step));
+  }
+  std::stable_sort(ordered.begin(), ordered.end(),
+                   [](const auto &a, const auto &b) {
+                     return a.first < b.first;
+                   });
+  reused_steps = 0;
+  encoded_steps = 0;
+  size_t next_boundary =
+      (boundary / checkpoint_interval + 1) * checkpoint_interval;
+  for (const auto &entry : ordered) {
+    if (entry.first < boundary) {
+      // already contained in the restored checkpoint
+      reused_steps++;
+      continue;
+    }
+    for (; next_boundary <= entry.first && next_boundary <= plan.size();
+         next_boundary += checkpoint_interval) {
+      checkpoints.push_back(Checkpoint{next_boundary, encoder.copy(), system});
+    }
+    applyEncodingStep(encoder, system, *entry.second, report);
+    encoded_steps++;
+  }
+  for (; next_boundary <= plan.size(); next_boundary += checkpoint_interval) {
+    checkpoints.push_back(Checkpoint{next_boundary, encoder.copy(), system});
+  }
+  TAPTENC_LOG_DEBUG("IncrementalEncoder: restored checkpoint "
+                    << boundary << ", reused " << reused_steps
+                    << " and encoded " << encoded_steps << " steps");
+}
+
+const DirectEncoder &transformation::IncrementalEncoder::getEncoder() const {
+  return encoder;
+}
+
+const AutomataSystem &transformation::IncrementalEncoder::getSystem() const {
+  return system;
+}
+
+size_t transformation::IncrementalEncoder::getReusedSteps() const {
+  return reused_steps;
+}
+
+size_t transformation::IncrementalEncoder::getEncodedSteps() const {
+  return encoded_steps;
 }
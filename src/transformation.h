@@ -10,14 +10,55 @@
 #include <vector>
 #include <memory>
 #include "encoders.h"
+#include "encoding_cache.h"
+#include "merge_planner.h"
 #include "timed_automata.h"
 #include "enc_interconnection_info.h"
 #include "constraints.h"
 #include "utap_trace_parser.h"
+#include "solver.h"
+#include "report.h"
 
 namespace taptenc {
 namespace transformation {
 typedef std::vector<std::vector<std::unique_ptr<EncICInfo>>> Constraints;
+/**
+ * Activation of a constraint upon a plan action, encoded by one call to the
+ * DirectEncoder.
+ */
+struct encodingStep {
+  /** constraint to encode */
+  const EncICInfo *info;
+  /** plan action (state of the plan TA) activating the constraint */
+  std::string pa;
+  /** plan action ending an until chain, empty for other constraint types */
+  std::string end_pa;
+};
+typedef struct encodingStep EncodingStep;
+/**
+ * Determines all constraint activations of a plan.
+ *
+ * @param plan_ta plan TA, as created by the DirectEncoder for \a plan
+ * @param plan plan to encode
+ * @param constraints Constraints connecting a platform model with plan
+ *        actions
+ * @return encoding steps ordered by constraint and then by plan action
+ */
+std::vector<EncodingStep>
+collectEncodingSteps(const Automaton &plan_ta,
+                     const std::vector<PlanAction> &plan,
+                     const std::vector<std::unique_ptr<EncICInfo>> &constraints);
+/**
+ * Encodes a single constraint activation.
+ *
+ * @param enc encoder to extend
+ * @param direct_system the system \a enc was created from
+ * @param step constraint activation to encode
+ * @param report if given, the time and the size increase of the encoding are
+ *        recorded for the constraint type
+ */
+void applyEncodingStep(DirectEncoder &enc, AutomataSystem &direct_system,
+                       const EncodingStep &step, Report *report = nullptr);
 /**
  * Apply the direct encoding to a given automata system consisting of all platform TAs and the plan TA.
  *
@@ -25,20 +66,111 @@ typedef std::vector<std::vector<std::unique_ptr<EncICInfo>>> Constraints;
  * @param plan the plan used to create the plan TA from the \a direct_system
  * @param constraints Constraints connecting platform models with plan actions
  * @param plan_index index of the plan TA inside \a direct_system
+ * @param report if given, the time and the size increase of the encoding
+ *        (states, transitions, automata copies, clocks) are recorded per
+ *        constraint type
  * @return Encoder holding the direct encoding construction
  */
 DirectEncoder createDirectEncoding(
     AutomataSystem &direct_system, const std::vector<PlanAction> &plan,
-    const std::vector<std::unique_ptr<EncICInfo>> &constraints, int plan_index = 1);
+    const std::vector<std::unique_ptr<EncICInfo>> &constraints, int plan_index = 1,
+    Report *report = nullptr);
 /**
  * Transform a plan according to a platform models and constraints
  *
  * @param plan Plan to transform
  * @param platform_models platform models realizing platform specific behavior
  * @param platform_constraints Constraints connecting platform models with plan actions
+ * @param solver solver used to find a trace in the encoding
+ * @param num_workers number of threads used to encode the platform models and
+ *        to merge the resulting encodings, 1 runs everything sequentially
+ * @param strategy determines the order in which the encodings of the
+ *        platform models are merged
+ * @param report if given, timings and counters of all phases of the
+ *        transformation are added to it
+ * @param cache if given, encodings of platform models and the resulting
+ *        timed trace are looked up in and added to it (an empty trace only
+ *        if the solver proved the plan infeasible, not if it failed)
  * @return timed trace reflecting the resulting temporal plan
  */
-timed_trace_t transform_plan(const std::vector<PlanAction> &plan, const std::vector<Automaton> &platform_models, const Constraints &platform_constraints);
+timed_trace_t transform_plan(const std::vector<PlanAction> &plan,
+                             const std::vector<Automaton> &platform_models,
+                             const Constraints &platform_constraints,
+                             Solver &solver, unsigned int num_workers = 1,
+                             MergeStrategy strategy = SmallestFirst,
+                             Report *report = nullptr,
+                             EncodingCache *cache = nullptr);
+
+/**
+ * Direct encoding of a platform model that is kept up to date with a
+ * changing plan.
+ *
+ * When only a suffix of the plan changes (e.g. actions are appended or the
+ * tail is repaired), the timelines of the unchanged prefix are reused and
+ * only the constraint activations whose context windows reach into the
+ * changed suffix are encoded again.
+ *
+ * To that end, encoding steps are applied in the order of the last timeline
+ * they affect (see DirectEncoder::lastAffectedTimeLine()) and a checkpoint
+ * of the encoder is kept every \a checkpoint_interval plan actions. As
+ * encoding steps are applied in a different order than by
+ * createDirectEncoding(), the resulting encoding is equivalent but not
+ * necessarily identical to the one created from scratch.
+ */
+class IncrementalEncoder {
+private:
+  /**
+   * Encoding after all steps that only affect timelines before \a boundary.
+   */
+  struct checkpoint {
+    size_t boundary;
+    DirectEncoder encoder;
+    AutomataSystem system;
+  };
+  typedef struct checkpoint Checkpoint;
+  Automaton platform_model;
+  const std::vector<std::unique_ptr<EncICInfo>> &constraints;
+  size_t checkpoint_interval;
+  std::vector<PlanAction> plan;
+  /** checkpoints of the current encoding, ordered by their boundary */
+  std::vector<Checkpoint> checkpoints;
+  DirectEncoder encoder;
+  AutomataSystem system;
+  size_t reused_steps = 0;
+  size_t encoded_steps = 0;
+
+public:
+  /**
+   * @param arg_platform_model platform model to encode
+   * @param arg_constraints Constraints connecting the platform model with
+   *        plan actions, have to outlive the encoder
+   * @param arg_checkpoint_interval number of plan actions between two
+   *        checkpoints, smaller values save more work when re-encoding at
+   *        the cost of memory
+   */
+  IncrementalEncoder(
+      const Automaton &arg_platform_model,
+      const std::vector<std::unique_ptr<EncICInfo>> &arg_constraints,
+      size_t arg_checkpoint_interval = 4);
+  /**
+   * Encodes a plan, reusing the encoding of the longest common prefix with
+   * the previously encoded plan.
+   *
+   * @param new_plan plan to encode
+   * @param report if given, the time and the size increase of the encoding
+   *        steps are recorded per constraint type
+   */
+  void encode(const std::vector<PlanAction> &new_plan,
+              Report *report = nullptr);
+  /** Returns the encoding of the last encoded plan. */
+  const DirectEncoder &getEncoder() const;
+  /** Returns the automata system the current encoding was created from. */
+  const AutomataSystem &getSystem() const;
+  /** Returns the number of encoding steps reused by the last encode(). */
+  size_t getReusedSteps() const;
+  /** Returns the number of encoding steps applied by the last encode(). */
+  size_t getEncodedSteps() const;
+};
 
 } // end namespace transformation
 } // end namespace taptenc
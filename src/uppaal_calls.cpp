@@ -1,23 +1,160 @@
 /** \file
  * Interface to call uppaal tools.
  *
- * Since there is no powerful C++ API the tools have to be invoked via system
- * calls.
+ * Since there is no powerful C++ API the tools have to be invoked as external
+ * processes.
  *
  * @author (2019) Tarik Viehmann
  */
 #include "uppaal_calls.h"
+#include "logging.h"
 #include "printer/printer.h"
 #include "timed-automata/timed_automata.h"
 #include "utils.h"
+#include <cerrno>
 #include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <spawn.h>
+#include <stdexcept>
 #include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+extern char **environ;
+
+namespace {
+/**
+ * Runs an external tool without involving a shell.
+ *
+ * @param args program (looked up in PATH if it contains no slash), followed
+ *        by its arguments
+ * @param out_file file the standard output of the tool is written to
+ * @param extra_env additional environment entries of the form KEY=VALUE
+ * @return true iff the tool was started and exited with status 0
+ */
+bool runTool(const std::vector<std::string> &args, const std::string &out_file,
+             const std::vector<std::string> &extra_env = {}) {
+  std::vector<char *> argv;
+  for (const auto &arg : args) {
+    argv.push_back(const_cast<char *>(arg.c_str()));
+  }
+  argv.push_back(nullptr);
+  std::vector<char *> envp;
+  for (const auto &env : extra_env) {
+    envp.push_back(const_cast<char *>(env.c_str()));
+  }
+  for (char **env = environ; *env != nullptr; env++) {
+    envp.push_back(*env);
+  }
+  envp.push_back(nullptr);
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, out_file.c_str(),
+                                   O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  pid_t pid;
+  int err = posix_spawnp(&pid, argv[0], &actions, nullptr, argv.data(),
+                         envp.data());
+  posix_spawn_file_actions_destroy(&actions);
+  if (err != 0) {
+    TAPTENC_LOG_ERROR("uppaalcalls: cannot start " << args[0] << ": "
+                                                   << std::strerror(err));
+    return false;
+  }
+  int status = 0;
+  while (waitpid(pid, &status, 0) == -1) {
+    if (errno != EINTR) {
+      TAPTENC_LOG_ERROR("uppaalcalls: cannot wait for " << args[0] << ": "
+                                                        << std::strerror(errno));
+      return false;
+    }
+  }
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    TAPTENC_LOG_ERROR("uppaalcalls: " << args[0] << " failed (status "
+                                      << status << ")");
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Reads the verdict of verifyta on a single query from its output.
+ *
+ * @param out_file file holding the standard output of verifyta
+ * @param satisfied set to true iff the query is satisfied
+ * @return true iff the output contains a verdict
+ */
+bool readVerdict(const std::string &out_file, bool &satisfied) {
+  std::ifstream out(out_file);
+  std::string line;
+  while (std::getline(out, line)) {
+    if (line.find("Formula is NOT satisfied") != std::string::npos) {
+      satisfied = false;
+      return true;
+    }
+    if (line.find("Formula is satisfied") != std::string::npos) {
+      satisfied = true;
+      return true;
+    }
+  }
+  TAPTENC_LOG_ERROR("uppaalcalls: no verdict of verifyta in " << out_file);
+  return false;
+}
+} // end anonymous namespace
 
 namespace taptenc {
 namespace uppaalcalls {
+TempWorkspace::TempWorkspace(const std::string &prefix) {
+  const char *tmp_dir = std::getenv("TMPDIR");
+  std::string dir_template = std::string(tmp_dir != NULL ? tmp_dir : "/tmp") +
+                             "/" + prefix + "_XXXXXX";
+  std::vector<char> buffer(dir_template.begin(), dir_template.end());
+  buffer.push_back('\0');
+  if (mkdtemp(buffer.data()) == NULL) {
+    throw std::runtime_error("TempWorkspace: cannot create directory " +
+                             dir_template + ": " + std::strerror(errno));
+  }
+  path = buffer.data();
+}
+
+TempWorkspace::TempWorkspace(TempWorkspace &&other) noexcept
+    : path(std::move(other.path)), keep_files(other.keep_files) {
+  other.path.clear();
+}
+
+TempWorkspace::~TempWorkspace() {
+  if (path == "") {
+    return;
+  }
+  if (keep_files) {
+    TAPTENC_LOG_INFO("TempWorkspace: keeping " << path);
+    return;
+  }
+  // the solver tools only create plain files within the directory
+  DIR *dir = opendir(path.c_str());
+  if (dir != NULL) {
+    for (struct dirent *entry = readdir(dir); entry != NULL;
+         entry = readdir(dir)) {
+      std::string name = entry->d_name;
+      if (name != "." && name != "..") {
+        unlink(file(name).c_str());
+      }
+    }
+    closedir(dir);
+  }
+  rmdir(path.c_str());
+}
+
+std::string TempWorkspace::file(const std::string &name) const {
+  return path + "/" + name;
+}
+
 void deleteEmptyLines(const std::string &file_name) {
   std::string bufferString = "";
 
@@ -46,49 +183,63 @@ void deleteEmptyLines(const std::string &file_name) {
 std::string getEnvVar(std::string const &key) {
   char *val = std::getenv(key.c_str());
   if (val == NULL) {
-    std::cout << "Environment Variable " << key << " not set!" << std::endl;
+    TAPTENC_LOG_WARN("Environment Variable " << key << " not set!");
     return "";
   }
   return std::string(val);
 }
 
-::std::vector<timedelta> solve(const AutomataSystem &sys, std::string file_name,
-                               std::string query_str) {
+VerificationResult solve(const AutomataSystem &sys, std::string file_name,
+                         std::string query_str, std::string verifyta_dir) {
   XMLPrinter printer;
-  SystemVisInfo sys_vis_info(sys);
-  printer.print(sys, sys_vis_info, file_name + ".xml");
-  return solve(file_name, query_str);
+  // verifyta does not need layout information
+  printer.print(sys, file_name + ".xml");
+  return solve(file_name, query_str, verifyta_dir);
 }
-::std::vector<timedelta> solve(std::string file_name, std::string query_str) {
-  std::vector<timedelta> res;
+
+VerificationResult solve(std::string file_name, std::string query_str,
+                         std::string verifyta_dir) {
+  VerificationResult res;
+  if (verifyta_dir == "") {
+    verifyta_dir = getEnvVar("VERIFYTA_DIR");
+  }
+  std::string verifyta = verifyta_dir + "/verifyta";
   std::ofstream myfile;
   myfile.open(file_name + ".q", std::ios_base::trunc);
   myfile << query_str;
   myfile.close();
-  std::string call_get_if = "UPPAAL_COMPILE_ONLY=1 " +
-                            getEnvVar("VERIFYTA_DIR") + "/verifyta " +
-                            file_name + ".xml - > " + file_name + ".if";
 
   auto t1 = std::chrono::high_resolution_clock::now();
-  std::system(call_get_if.c_str());
+  bool ok = runTool({verifyta, file_name + ".xml", "-"}, file_name + ".if",
+                    {"UPPAAL_COMPILE_ONLY=1"});
   auto t2 = std::chrono::high_resolution_clock::now();
-  res.push_back(std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1));
-  std::string call_get_trace = getEnvVar("VERIFYTA_DIR") +
-                               "/verifyta -t 2  -f " + file_name + " -Y " +
-                               file_name + ".xml " + file_name + ".q";
+  res.timings.push_back(
+      std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1));
+  if (!ok) {
+    return res;
+  }
   t1 = std::chrono::high_resolution_clock::now();
-  std::system(call_get_trace.c_str());
+  ok = runTool({verifyta, "-t", "2", "-f", file_name, "-Y", file_name + ".xml",
+                file_name + ".q"},
+               file_name + ".out");
   t2 = std::chrono::high_resolution_clock::now();
-  res.push_back(std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1));
+  res.timings.push_back(
+      std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1));
+  if (!ok || !readVerdict(file_name + ".out", res.satisfied)) {
+    return res;
+  }
+  if (!res.satisfied) {
+    res.success = true;
+    return res;
+  }
 
   t1 = std::chrono::high_resolution_clock::now();
   deleteEmptyLines(file_name + "-1.xtr");
-  std::string call_make_trace_readable = "tracer " + file_name + ".if " +
-                                         file_name + "-1.xtr > " + file_name +
-                                         ".trace";
-  std::system(call_make_trace_readable.c_str());
+  res.success = runTool({"tracer", file_name + ".if", file_name + "-1.xtr"},
+                        file_name + ".trace");
   t2 = std::chrono::high_resolution_clock::now();
-  res.push_back(std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1));
+  res.timings.push_back(
+      std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1));
   return res;
 }
 } // end namespace uppaalcalls
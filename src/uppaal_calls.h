@@ -1,8 +1,9 @@
 /** \file
  * Interface to call uppaal tools.
  *
- * Since there is no powerful C++ API the tools have to be invoked via system
- * calls.
+ * Since there is no powerful C++ API the tools have to be invoked as external
+ * processes. They are started directly (without a shell), hence file names
+ * and directories need no quoting.
  *
  * @author (2019) Tarik Viehmann
  */
@@ -21,6 +22,64 @@ typedef ::std::chrono::duration<long, std::milli> timedelta;
 /** Default query string. */
 constexpr char QUERY_STR[]{"E<> sys_direct.AqueryA"};
 constexpr char TAPTENC_TEMP_XML[]{"taptenc_temp"};
+
+/**
+ * Outcome of calling the uppaal tools on a query.
+ */
+struct verificationResult {
+  /** true iff all tools ran and verifyta gave a definite answer */
+  bool success = false;
+  /** true iff verifyta reported the query as satisfied */
+  bool satisfied = false;
+  /** durations of the calls to verifyta (compile, verify) and tracer */
+  ::std::vector<timedelta> timings;
+};
+typedef struct verificationResult VerificationResult;
+
+/**
+ * Scratch directory for the files of one solver invocation.
+ *
+ * The directory is created with a unique name (see mkdtemp) within $TMPDIR
+ * (or /tmp) and is removed together with its content on destruction, hence
+ * concurrent invocations do not interfere.
+ */
+class TempWorkspace {
+private:
+  ::std::string path;
+  bool keep_files = false;
+
+public:
+  /**
+   * Creates a fresh directory.
+   *
+   * @param prefix prefix of the directory name
+   * @throws std::runtime_error if the directory cannot be created
+   */
+  explicit TempWorkspace(const ::std::string &prefix = "taptenc");
+  TempWorkspace(const TempWorkspace &) = delete;
+  TempWorkspace &operator=(const TempWorkspace &) = delete;
+  TempWorkspace(TempWorkspace &&other) noexcept;
+  /** Removes the directory unless keep() was called. */
+  ~TempWorkspace();
+
+  /**
+   * Returns the path of the directory.
+   */
+  const ::std::string &getPath() const { return path; }
+  /**
+   * Returns the path of a file within the directory.
+   *
+   * @param name file name
+   * @return path to \a name inside the workspace
+   */
+  ::std::string file(const ::std::string &name) const;
+  /**
+   * Keeps the directory and its content after destruction, e.g. to inspect
+   * the solver in- and output.
+   */
+  void keep() { keep_files = true; }
+};
+
 /**
  * Deletes empty lines from a file.
  *
@@ -42,14 +101,22 @@ std::string getEnvVar(std::string const &key);
  * Call the verifyta solver and the tracer from the utap lib to solve a query
  * for a given xml system.
  *
+ * The output of verifyta is written to \a file_name.out, the readable trace
+ * (if the query is satisfied) to \a file_name.trace. Failing tools are
+ * reported via the log.
+ *
  * @param file_name name of xml system file without .xml
  * @param query_str query string suitable for uppaal
+ * @param verifyta_dir directory containing verifyta, if empty the content of
+ *        the environment variable VERIFYTA_DIR is used
  *
- * @return time measures fo the two calls to verifyta and the one call to
- *         tracer
+ * @return answer of verifyta together with the time measures of the two
+ *         calls to verifyta and the one call to tracer (which is skipped if
+ *         the query is not satisfied)
  */
-::std::vector<timedelta> solve(::std::string file_name = TAPTENC_TEMP_XML,
-                               ::std::string query_str = QUERY_STR);
+VerificationResult solve(::std::string file_name = TAPTENC_TEMP_XML,
+                         ::std::string query_str = QUERY_STR,
+                         ::std::string verifyta_dir = "");
 
 /**
  * Call the verifyta solver and the tracer from the utap lib to solve a query
@@ -58,12 +125,15 @@ std::string getEnvVar(std::string const &key);
  * @param sys automata system to solve the query for
  * @param file_name name of xml system file without .xml
  * @param query_str query string sutiable for uppaal
+ * @param verifyta_dir directory containing verifyta, if empty the content of
+ *        the environment variable VERIFYTA_DIR is used
  *
- * @return time measures fo the two calls to verifyta and the one call to
- *         tracer
+ * @return answer of verifyta together with the time measures of the tool
+ *         calls (see solve(::std::string, ::std::string, ::std::string))
  */
-::std::vector<timedelta> solve(const AutomataSystem &sys,
-                               ::std::string file_name = TAPTENC_TEMP_XML,
-                               ::std::string query_str = QUERY_STR);
+VerificationResult solve(const AutomataSystem &sys,
+                         ::std::string file_name = TAPTENC_TEMP_XML,
+                         ::std::string query_str = QUERY_STR,
+                         ::std::string verifyta_dir = "");
 } // end namespace uppaalcalls
 } // end namespace taptenc
@@ -40,16 +40,15 @@ taptenc::iUnitNormalFromPoints(const ::std::pair<int, int> &a,
   return normal;
 }
 
-::std::unique_ptr<ClockConstraint>
-taptenc::addConstraint(const ClockConstraint &old_con,
-                       const ClockConstraint &to_add) {
+constraint_ptr_t taptenc::addConstraint(const ClockConstraint &old_con,
+                                        const ClockConstraint &to_add) {
   if (old_con.type == CCType::TRUE) {
-    return to_add.createCopy();
+    return ConstraintTable::instance().intern(to_add);
   }
   if (to_add.type == CCType::TRUE) {
-    return old_con.createCopy();
+    return ConstraintTable::instance().intern(old_con);
   }
-  return ConjunctionCC(old_con, to_add).createCopy();
+  return ConstraintTable::instance().intern(ConjunctionCC(old_con, to_add));
 }
 update_t taptenc::addUpdate(const update_t &old_con, const update_t &to_add) {
   update_t res(old_con);
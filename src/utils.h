@@ -113,10 +113,10 @@ float fDotProduct(const ::std::pair<float, float> &a,
  *
  * @param old_con constraint1
  * @param to_add constraint2
- * @return conjunction of constraint1 and constraint2
+ * @return interned conjunction of constraint1 and constraint2
  */
-::std::unique_ptr<ClockConstraint> addConstraint(const ClockConstraint &old_con,
-                                                 const ClockConstraint &to_add);
+constraint_ptr_t addConstraint(const ClockConstraint &old_con,
+                               const ClockConstraint &to_add);
 
 /**
  * Concatenates two clock updates.
@@ -187,6 +187,23 @@ void replaceStringInPlace(::std::string &subject, const ::std::string &search,
  */
 ::std::vector<::std::string> splitBySep(::std::string s, char sep);
 
+/**
+ * Hash functor for pointers that hashes the pointed-to object via std::hash.
+ *
+ * Allows hash-based containers over pointers into existing containers, e.g. to
+ * deduplicate elements without copying them.
+ */
+template <typename T> struct PointeeHash {
+  ::std::size_t operator()(const T *ptr) const { return ::std::hash<T>()(*ptr); }
+};
+
+/**
+ * Equality functor for pointers that compares the pointed-to objects.
+ */
+template <typename T> struct PointeeEqual {
+  bool operator()(const T *l, const T *r) const { return *l == *r; }
+};
+
 } // end namespace taptenc
 
 namespace std {
@@ -0,0 +1,218 @@
+/** \file
+ * Difference bound matrices to represent clock zones.
+ *
+ * \author (2019) Tarik Viehmann
+ */
+#include "dbm.h"
+#include <algorithm>
+#include <cstdint>
+
+using namespace taptenc;
+using namespace dbmutils;
+
+namespace {
+/**
+ * Relaxes a row via an intermediate clock:
+ * row[j] = min(row[j], via_bound + via_row[j]).
+ *
+ * Branch-free variant of dbmutils::add() that the compiler can vectorize.
+ * The sum is computed on unsigned values, overflows caused by INF entries
+ * of \a via_row are masked out afterwards.
+ *
+ * @param row row to tighten, must not overlap with \a via_row
+ * @param via_row row of the intermediate clock
+ * @param via_bound bound from the clock of \a row to the intermediate clock,
+ *                  must not be INF
+ * @param dim number of entries to relax
+ */
+inline void relaxRow(raw_t *__restrict row, const raw_t *__restrict via_row,
+                     raw_t via_bound, size_t dim) {
+  const std::uint32_t lhs = static_cast<std::uint32_t>(via_bound);
+  for (size_t j = 0; j < dim; j++) {
+    const raw_t rhs = via_row[j];
+    const std::uint32_t sum = lhs + static_cast<std::uint32_t>(rhs) -
+                              static_cast<std::uint32_t>((via_bound | rhs) & 1);
+    const raw_t path = rhs == INF ? INF : static_cast<raw_t>(sum);
+    row[j] = path < row[j] ? path : row[j];
+  }
+}
+} // end anonymous namespace
+
+DBM::DBM(size_t num_clocks)
+    : dim(num_clocks + 1),
+      stride((dim + ROW_ALIGNMENT - 1) / ROW_ALIGNMENT * ROW_ALIGNMENT),
+      entries(dim * stride, LE_ZERO) {}
+
+DBM DBM::unconstrained(size_t num_clocks) {
+  DBM res(num_clocks);
+  for (size_t i = 0; i < res.dim; i++) {
+    for (size_t j = 0; j < res.dim; j++) {
+      res.setEntry(i, j, i == j ? LE_ZERO : INF);
+    }
+  }
+  return res;
+}
+
+bool DBM::close() {
+  for (size_t k = 0; k < dim; k++) {
+    const raw_t *row_k = &entries[k * stride];
+    for (size_t i = 0; i < dim; i++) {
+      raw_t ik = get(i, k);
+      if (i == k || ik == INF) {
+        continue;
+      }
+      relaxRow(&entries[i * stride], row_k, ik, dim);
+    }
+    if (get(k, k) < LE_ZERO) {
+      return false;
+    }
+  }
+  return !isEmpty();
+}
+
+bool DBM::isEmpty() const {
+  for (size_t i = 0; i < dim; i++) {
+    if (get(i, i) < LE_ZERO) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool DBM::constrain(size_t i, size_t j, raw_t bound) {
+  if (bound >= get(i, j)) {
+    return true;
+  }
+  if (add(get(j, i), bound) < LE_ZERO) {
+    setEntry(0, 0, LT_ZERO);
+    return false;
+  }
+  setEntry(i, j, bound);
+  // every shortest path that can be improved passes the new edge i -> j,
+  // row j itself can not be improved as the cycle j -> i -> j is
+  // non-negative
+  const raw_t *row_j = &entries[j * stride];
+  for (size_t k = 0; k < dim; k++) {
+    raw_t ki = get(k, i);
+    if (k == j || ki == INF) {
+      continue;
+    }
+    relaxRow(&entries[k * stride], row_j, add(ki, bound), dim);
+  }
+  return true;
+}
+
+bool DBM::constrainRow(size_t i, const std::vector<raw_t> &bounds) {
+  raw_t *row_i = &entries[i * stride];
+  bool changed = false;
+  for (size_t j = 0; j < dim; j++) {
+    if (bounds[j] < row_i[j]) {
+      row_i[j] = bounds[j];
+      changed = true;
+    }
+  }
+  if (!changed) {
+    return true;
+  }
+  // improved paths from i start with a tightened edge i -> k followed by a
+  // shortest path from k, which is unchanged
+  for (size_t k = 0; k < dim; k++) {
+    raw_t ik = row_i[k];
+    if (k == i || ik == INF) {
+      continue;
+    }
+    relaxRow(row_i, &entries[k * stride], ik, dim);
+  }
+  if (row_i[i] < LE_ZERO) {
+    setEntry(0, 0, LT_ZERO);
+    return false;
+  }
+  // all other improved paths reach i via an unchanged shortest path
+  for (size_t m = 0; m < dim; m++) {
+    raw_t mi = get(m, i);
+    if (m == i || mi == INF) {
+      continue;
+    }
+    relaxRow(&entries[m * stride], row_i, mi, dim);
+  }
+  return true;
+}
+
+bool DBM::intersect(const DBM &other) {
+  bool changed = false;
+  for (size_t i = 0; i < entries.size(); i++) {
+    if (other.entries[i] < entries[i]) {
+      entries[i] = other.entries[i];
+      changed = true;
+    }
+  }
+  return !changed || close();
+}
+
+void DBM::up() {
+  for (size_t i = 1; i < dim; i++) {
+    setEntry(i, 0, INF);
+  }
+}
+
+void DBM::down() {
+  for (size_t j = 1; j < dim; j++) {
+    raw_t lower = LE_ZERO;
+    for (size_t i = 1; i < dim; i++) {
+      lower = std::min(lower, get(i, j));
+    }
+    setEntry(0, j, lower);
+  }
+}
+
+void DBM::reset(size_t i) {
+  for (size_t j = 0; j < dim; j++) {
+    setEntry(i, j, get(0, j));
+    setEntry(j, i, get(j, 0));
+  }
+  setEntry(i, i, LE_ZERO);
+}
+
+void DBM::free(size_t i) {
+  for (size_t j = 0; j < dim; j++) {
+    if (j != i) {
+      setEntry(i, j, INF);
+      setEntry(j, i, get(j, 0));
+    }
+  }
+}
+
+void DBM::extrapolateMaxBounds(const std::vector<timepoint> &max_bounds) {
+  bool changed = false;
+  for (size_t i = 0; i < dim; i++) {
+    for (size_t j = 0; j < dim; j++) {
+      raw_t curr = get(i, j);
+      if (i == j || curr == INF) {
+        continue;
+      }
+      if (i != 0 && curr > encode(max_bounds[i], false)) {
+        setEntry(i, j, INF);
+        changed = true;
+      } else if (j != 0 && curr < encode(-max_bounds[j], true)) {
+        setEntry(i, j, encode(-max_bounds[j], true));
+        changed = true;
+      }
+    }
+  }
+  if (changed) {
+    close();
+  }
+}
+
+bool DBM::isSubsetEq(const DBM &other) const {
+  for (size_t i = 0; i < entries.size(); i++) {
+    if (entries[i] > other.entries[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool DBM::operator==(const DBM &other) const {
+  return entries == other.entries;
+}
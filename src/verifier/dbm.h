@@ -0,0 +1,154 @@
+/** \file
+ * Difference bound matrices to represent clock zones.
+ *
+ * \author (2019) Tarik Viehmann
+ */
+#pragma once
+
+#include "../constraints/constraints.h"
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace taptenc {
+/**
+ * Encoded bound of a DBM entry.
+ *
+ * A constraint x_i - x_j < c (resp. <= c) is stored as (c << 1) (resp.
+ * (c << 1) | 1), hence comparing two encoded bounds yields the order of the
+ * constraints they represent.
+ */
+typedef ::std::int32_t raw_t;
+
+namespace dbmutils {
+/** Encoded bound representing no constraint. */
+constexpr raw_t INF = ::std::numeric_limits<raw_t>::max();
+/** Encoded bound x_i - x_j <= 0. */
+constexpr raw_t LE_ZERO = 1;
+/** Encoded bound x_i - x_j < 0. */
+constexpr raw_t LT_ZERO = 0;
+
+inline raw_t encode(timepoint bound, bool strict) {
+  return (bound * 2) | (strict ? 0 : 1);
+}
+inline timepoint boundOf(raw_t raw) { return raw >> 1; }
+inline bool isStrict(raw_t raw) { return (raw & 1) == 0; }
+
+/**
+ * Adds two encoded bounds, the sum is strict if one of the summands is.
+ */
+inline raw_t add(raw_t l, raw_t r) {
+  if (l == INF || r == INF) {
+    return INF;
+  }
+  return (l + r) - ((l | r) & 1);
+}
+} // end namespace dbmutils
+
+/**
+ * Zone over clocks x_1, ... x_n stored as difference bound matrix.
+ *
+ * Index 0 denotes the reference clock that is constantly 0. Entry (i, j)
+ * bounds x_i - x_j. All operations except for setEntry() expect and
+ * preserve canonical form (all bounds are tight), which is established by
+ * close().
+ *
+ * Entries are stored row-major in one contiguous block. Rows are padded to a
+ * multiple of #ROW_ALIGNMENT entries, so they start at vector register
+ * boundaries relative to each other and the row relaxations of close() and
+ * constrain() are vectorized by the compiler.
+ */
+class DBM {
+private:
+  /** Row length is rounded up to a multiple of this number of entries. */
+  static constexpr ::std::size_t ROW_ALIGNMENT = 8;
+  ::std::size_t dim;
+  ::std::size_t stride;
+  ::std::vector<raw_t> entries;
+
+public:
+  /**
+   * Creates the zone where all clocks are 0.
+   *
+   * @param num_clocks number of clocks (excluding the reference clock)
+   */
+  explicit DBM(::std::size_t num_clocks);
+
+  /**
+   * Creates a matrix without any constraints (not even x_i >= 0), which is
+   * not canonical. It is meant to be filled via setEntry() and close().
+   *
+   * @param num_clocks number of clocks (excluding the reference clock)
+   */
+  static DBM unconstrained(::std::size_t num_clocks);
+
+  ::std::size_t getDimension() const { return dim; }
+  raw_t get(::std::size_t i, ::std::size_t j) const {
+    return entries[i * stride + j];
+  }
+  /**
+   * Overwrites an entry without restoring canonical form.
+   */
+  void setEntry(::std::size_t i, ::std::size_t j, raw_t bound) {
+    entries[i * stride + j] = bound;
+  }
+
+  /**
+   * Restores canonical form (Floyd-Warshall) in O(n^3).
+   *
+   * @return false iff the zone is empty
+   */
+  bool close();
+  /**
+   * Checks whether the zone contains no valuation.
+   */
+  bool isEmpty() const;
+  /**
+   * Intersects the zone with the constraint x_i - x_j (bound) and restores
+   * canonical form in O(n^2).
+   *
+   * @return false iff the resulting zone is empty
+   */
+  bool constrain(::std::size_t i, ::std::size_t j, raw_t bound);
+  /**
+   * Intersects the zone with the constraints x_i - x_j (bounds[j]) for all j
+   * and restores canonical form in O(n^2), independent of the number of
+   * tightened entries.
+   *
+   * @param i row to tighten
+   * @param bounds new bounds of row \a i, indexed by clock (INF for no
+   *               constraint)
+   * @return false iff the resulting zone is empty
+   */
+  bool constrainRow(::std::size_t i, const ::std::vector<raw_t> &bounds);
+  /**
+   * Intersects with another zone of the same dimension.
+   *
+   * @return false iff the resulting zone is empty
+   */
+  bool intersect(const DBM &other);
+  /** Lets time elapse (removes all upper bounds). */
+  void up();
+  /** Contains all valuations from which the zone is reachable by delays. */
+  void down();
+  /** Resets clock x_i to 0. */
+  void reset(::std::size_t i);
+  /** Removes all constraints on clock x_i. */
+  void free(::std::size_t i);
+  /**
+   * Classic maximal bounds extrapolation, required for termination.
+   *
+   * @param max_bounds maximal constant each clock is compared to, indexed by
+   *                   clock (entry 0 is ignored)
+   */
+  void extrapolateMaxBounds(const ::std::vector<timepoint> &max_bounds);
+  /**
+   * Checks zone inclusion.
+   *
+   * @return true iff this zone is contained in \a other
+   */
+  bool isSubsetEq(const DBM &other) const;
+
+  bool operator==(const DBM &other) const;
+};
+} // end namespace taptenc
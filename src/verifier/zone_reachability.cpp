@@ -0,0 +1,299 @@
+/** \file
+ * In-process reachability checker for timed automata based on clock zones.
+ *
+ * \author (2019) Tarik Viehmann
+ */
+#include "zone_reachability.h"
+#include "../constants.h"
+#include "../constraints/constraints.h"
+#include "../timed-automata/timed_automata.h"
+#include "../logging.h"
+#include "dbm.h"
+#include <algorithm>
+#include <cstdlib>
+#include <queue>
+#include <string>
+#include <vector>
+
+using namespace taptenc;
+using namespace dbmutils;
+
+std::size_t ZoneReachability::clockIndex(const std::shared_ptr<Clock> &cl) {
+  auto ins = clock_indices.insert(std::make_pair(cl->id, clock_names.size()));
+  if (ins.second) {
+    clock_names.push_back(cl->id);
+    max_bounds.push_back(0);
+  }
+  return ins.first->second;
+}
+
+bool ZoneReachability::toAtomicConstraints(
+    const ClockConstraint &cc, std::vector<atomicConstraint> &res) {
+  std::size_t minuend = 0;
+  std::size_t subtrahend = 0;
+  ComparisonOp op = LTE;
+  timepoint constant = 0;
+  switch (cc.type) {
+  case CCType::TRUE:
+    return true;
+  case CCType::UNPARSED:
+    return cc.toString().find_first_not_of(" \t") == std::string::npos;
+  case CCType::CONJUNCTION: {
+    const ConjunctionCC &conj = static_cast<const ConjunctionCC &>(cc);
+    for (const auto &cc_conjunct : conj.content) {
+      if (!toAtomicConstraints(*cc_conjunct, res)) {
+        return false;
+      }
+    }
+    return true;
+  }
+  case CCType::SIMPLE_BOUND: {
+    const ComparisonCC &comp = static_cast<const ComparisonCC &>(cc);
+    minuend = clockIndex(comp.clock);
+    op = comp.comp;
+    constant = comp.constant;
+    break;
+  }
+  case CCType::DIFFERENCE:
+    // max bounds extrapolation is unsound in the presence of diagonal
+    // constraints, such systems are left to the fallback solver
+    return false;
+  default:
+    return false;
+  }
+  max_bounds[minuend] = std::max(max_bounds[minuend], std::abs(constant));
+  switch (op) {
+  case LT:
+  case LTE:
+    res.push_back(
+        atomicConstraint{minuend, subtrahend, encode(constant, op == LT)});
+    return true;
+  case GT:
+  case GTE:
+    res.push_back(
+        atomicConstraint{subtrahend, minuend, encode(-constant, op == GT)});
+    return true;
+  case EQ:
+    res.push_back(
+        atomicConstraint{minuend, subtrahend, encode(constant, false)});
+    res.push_back(
+        atomicConstraint{subtrahend, minuend, encode(-constant, false)});
+    return true;
+  default:
+    // != is not convex
+    return false;
+  }
+}
+
+ZoneReachability::ZoneReachability(const AutomataSystem &arg_sys)
+    : sys(arg_sys) {
+  clock_names.push_back(constants::ZERO_CLOCK);
+  max_bounds.push_back(0);
+  if (sys.instances.size() != 1 ||
+      sys.instances[0].first.bool_vars.size() > 0 ||
+      sys.globals.bool_vars.size() > 0) {
+    supported = false;
+    return;
+  }
+  const Automaton &ta = sys.instances[0].first;
+  for (const auto &cl : sys.globals.clocks) {
+    clockIndex(cl);
+  }
+  for (const auto &cl : ta.clocks) {
+    clockIndex(cl);
+  }
+  auto global_clock_it = clock_indices.find(constants::GLOBAL_CLOCK);
+  if (global_clock_it != clock_indices.end()) {
+    global_clock = global_clock_it->second;
+  }
+  for (const auto &s : ta.states) {
+    if (loc_indices.insert(std::make_pair(s.id, invariants.size())).second) {
+      locations.push_back(&s);
+      invariants.emplace_back();
+      outgoing.emplace_back();
+      supported &= toAtomicConstraints(*s.inv, invariants.back());
+    }
+  }
+  for (const auto &t : ta.transitions) {
+    auto source = loc_indices.find(t.source_id);
+    if (source == loc_indices.end() ||
+        loc_indices.find(t.dest_id) == loc_indices.end()) {
+      continue;
+    }
+    if (t.sync != "") {
+      // only broadcast emitters can fire without a synchronization partner
+      auto chan = std::find_if(
+          sys.globals.channels.begin(), sys.globals.channels.end(),
+          [&t](const Channel &c) { return c.name == t.sync; });
+      if (t.passive || chan == sys.globals.channels.end() ||
+          chan->type != ChanType::Broadcast) {
+        continue;
+      }
+    }
+    for (const auto &cl : t.update) {
+      clockIndex(cl);
+    }
+    supported &= toAtomicConstraints(*t.guard, guards[&t]);
+    outgoing[source->second].push_back(&t);
+  }
+}
+
+bool ZoneReachability::isSupported() const { return supported; }
+
+bool ZoneReachability::applyConstraints(
+    DBM &zone, const std::vector<atomicConstraint> &ccs) const {
+  for (const auto &cc : ccs) {
+    if (!zone.constrain(cc.i, cc.j, cc.bound)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool ZoneReachability::successor(DBM &zone, const Transition *trans,
+                                 std::size_t loc, bool extrapolate) const {
+  if (trans != nullptr) {
+    if (!applyConstraints(zone, guards.at(trans))) {
+      return false;
+    }
+    for (const auto &cl : trans->update) {
+      zone.reset(clock_indices.at(cl->id));
+    }
+  }
+  if (!applyConstraints(zone, invariants[loc])) {
+    return false;
+  }
+  if (!locations[loc]->urgent) {
+    zone.up();
+    applyConstraints(zone, invariants[loc]);
+  }
+  if (extrapolate) {
+    zone.extrapolateMaxBounds(max_bounds);
+  }
+  return true;
+}
+
+std::vector<ZoneBound> ZoneReachability::toZoneBounds(const DBM &zone) const {
+  std::vector<ZoneBound> res;
+  for (std::size_t i = 0; i < zone.getDimension(); i++) {
+    for (std::size_t j = 0; j < zone.getDimension(); j++) {
+      raw_t entry = zone.get(i, j);
+      if (i != j && entry != INF) {
+        res.push_back(ZoneBound{i, j, entry});
+      }
+    }
+  }
+  return res;
+}
+
+SymbolicTrace ZoneReachability::createTrace(
+    std::size_t init_loc, const std::vector<const Transition *> &path) const {
+  std::vector<std::size_t> locs{init_loc};
+  std::vector<DBM> zones{DBM(clock_names.size() - 1)};
+  successor(zones.back(), nullptr, init_loc, false);
+  for (const auto trans : path) {
+    locs.push_back(loc_indices.at(trans->dest_id));
+    zones.push_back(zones.back());
+    successor(zones.back(), trans, locs.back(), false);
+  }
+  // keep only valuations from which the remaining path can be taken
+  for (std::size_t k = path.size(); k > 0; k--) {
+    const Transition *trans = path[k - 1];
+    DBM pre = zones[k];
+    for (const auto &cl : trans->update) {
+      std::size_t cl_index = clock_indices.at(cl->id);
+      pre.constrain(cl_index, 0, LE_ZERO);
+      pre.constrain(0, cl_index, LE_ZERO);
+      pre.free(cl_index);
+    }
+    applyConstraints(pre, guards.at(trans));
+    pre.intersect(zones[k - 1]);
+    if (!locations[locs[k - 1]]->urgent) {
+      pre.down();
+      pre.intersect(zones[k - 1]);
+    }
+    zones[k - 1] = pre;
+  }
+  SymbolicTrace res;
+  res.clocks = clock_names;
+  for (std::size_t k = 0; k < zones.size(); k++) {
+    res.states.push_back(
+        SymbolicTraceState{locations[locs[k]]->id, toZoneBounds(zones[k])});
+  }
+  for (const auto trans : path) {
+    res.transitions.push_back(SymbolicTraceTransition{
+        trans->source_id, trans->dest_id, trans->guard->toString(),
+        trans->sync == "" ? "" : trans->sync + "!", trans->updateToString()});
+  }
+  return res;
+}
+
+bool ZoneReachability::findTrace(const std::string &target_id,
+                                 SymbolicTrace &trace) {
+  num_explored = 0;
+  if (!supported) {
+    TAPTENC_LOG_WARN("ZoneReachability findTrace: system not supported");
+    return false;
+  }
+  const Automaton &ta = sys.instances[0].first;
+  auto init_it = std::find_if(ta.states.begin(), ta.states.end(),
+                              [](const State &s) { return s.initial; });
+  auto target = loc_indices.find(target_id);
+  if (init_it == ta.states.end() || target == loc_indices.end()) {
+    TAPTENC_LOG_ERROR("ZoneReachability findTrace: initial or target state "
+                      "not found (target: "
+                      << target_id << ")");
+    return false;
+  }
+  std::size_t init_loc = loc_indices.at(init_it->id);
+  std::vector<searchNode> nodes;
+  std::vector<std::vector<std::size_t>> passed(invariants.size());
+  // explore states with the smallest lower bound on the global clock first,
+  // (entry (0, glob) holds the negated lower bound), ties are broken FIFO
+  auto cmp = [&nodes, this](std::size_t l, std::size_t r) {
+    raw_t l_lb = nodes[l].zone.get(0, global_clock);
+    raw_t r_lb = nodes[r].zone.get(0, global_clock);
+    return l_lb != r_lb ? l_lb < r_lb : l > r;
+  };
+  std::priority_queue<std::size_t, std::vector<std::size_t>, decltype(cmp)>
+      waiting(cmp);
+  DBM init_zone(clock_names.size() - 1);
+  if (!successor(init_zone, nullptr, init_loc, true)) {
+    return false;
+  }
+  nodes.push_back(searchNode{init_loc, init_zone, 0, nullptr});
+  passed[init_loc].push_back(0);
+  waiting.push(0);
+  while (!waiting.empty()) {
+    std::size_t curr = waiting.top();
+    waiting.pop();
+    num_explored++;
+    if (nodes[curr].loc == target->second) {
+      std::vector<const Transition *> path;
+      for (std::size_t n = curr; n != 0; n = nodes[n].parent) {
+        path.push_back(nodes[n].via);
+      }
+      std::reverse(path.begin(), path.end());
+      trace = createTrace(init_loc, path);
+      return true;
+    }
+    for (const auto trans : outgoing[nodes[curr].loc]) {
+      std::size_t dest = loc_indices.at(trans->dest_id);
+      DBM succ_zone = nodes[curr].zone;
+      if (!successor(succ_zone, trans, dest, true)) {
+        continue;
+      }
+      bool covered = std::any_of(
+          passed[dest].begin(), passed[dest].end(), [&](std::size_t n) {
+            return succ_zone.isSubsetEq(nodes[n].zone);
+          });
+      if (covered) {
+        continue;
+      }
+      nodes.push_back(searchNode{dest, succ_zone, curr, trans});
+      passed[dest].push_back(nodes.size() - 1);
+      waiting.push(nodes.size() - 1);
+    }
+  }
+  return false;
+}
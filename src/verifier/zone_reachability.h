@@ -0,0 +1,133 @@
+/** \file
+ * In-process reachability checker for timed automata based on clock zones.
+ *
+ * \author (2019) Tarik Viehmann
+ */
+#pragma once
+
+#include "../parser/utap_trace_parser.h"
+#include "../timed-automata/timed_automata.h"
+#include "dbm.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace taptenc {
+/**
+ * Checks reachability of a location in an automata system consisting of a
+ * single automaton, such as the ones produced by
+ * DirectEncoder::createFinalSystem().
+ *
+ * This replaces the calls to verifyta and tracer for queries of the form
+ * E<> sys_direct.AqueryA and directly yields a symbolic trace that can be
+ * loaded by UTAPTraceParser::loadTrace().
+ *
+ * The symbolic state space is explored best-first, ordered by the lower bound
+ * of the global clock (if present), hence the first trace found is the
+ * fastest one (as long as the global time stays below the maximal constant
+ * it is compared to). The zones of the resulting trace are computed without
+ * extrapolation and are stabilized backwards, i.e. they only contain
+ * valuations from which the remaining trace can still be taken.
+ * Termination relies on max bounds extrapolation, which is only sound for
+ * systems without clock difference constraints (as created by the encoders),
+ * hence systems using them are not supported.
+ */
+class ZoneReachability {
+private:
+  /** Single constraint x_i - x_j (bound) on clock indices. */
+  struct atomicConstraint {
+    ::std::size_t i;
+    ::std::size_t j;
+    raw_t bound;
+  };
+  /** Node of the explored symbolic state space. */
+  struct searchNode {
+    ::std::size_t loc;
+    DBM zone;
+    ::std::size_t parent;
+    const Transition *via;
+  };
+  const AutomataSystem &sys;
+  bool supported = true;
+  ::std::unordered_map<Symbol, ::std::size_t> clock_indices;
+  ::std::vector<::std::string> clock_names;
+  /** Maximal constant each clock is compared to. */
+  ::std::vector<timepoint> max_bounds;
+  /** Index of the global clock, 0 if the system does not have one. */
+  ::std::size_t global_clock = 0;
+  ::std::unordered_map<Symbol, ::std::size_t> loc_indices;
+  ::std::vector<const State *> locations;
+  ::std::vector<::std::vector<atomicConstraint>> invariants;
+  ::std::vector<::std::vector<const Transition *>> outgoing;
+  ::std::unordered_map<const Transition *, ::std::vector<atomicConstraint>>
+      guards;
+  ::std::size_t num_explored = 0;
+
+  /**
+   * Translates a clock constraint to atomic DBM constraints.
+   *
+   * @param cc constraint to translate
+   * @param res vector to append the atomic constraints to
+   * @return false iff \a cc is not expressible as a conjunction of simple
+   *         clock bounds (e.g. it contains !=, clock differences or unparsed
+   *         parts)
+   */
+  bool toAtomicConstraints(const ClockConstraint &cc,
+                           ::std::vector<atomicConstraint> &res);
+  ::std::size_t clockIndex(const ::std::shared_ptr<Clock> &cl);
+  bool applyConstraints(DBM &zone,
+                        const ::std::vector<atomicConstraint> &ccs) const;
+  /**
+   * Computes the initial zone or the successor zone along a transition.
+   *
+   * @param zone zone to compute the successor of, is overwritten by the
+   *             result
+   * @param trans transition to take, nullptr to compute the initial zone
+   *              of location \a loc
+   * @param loc location reached by the transition
+   * @param extrapolate if true, applies the max bounds extrapolation
+   * @return false iff the successor zone is empty
+   */
+  bool successor(DBM &zone, const Transition *trans, ::std::size_t loc,
+                 bool extrapolate) const;
+  /**
+   * Computes the zones along a sequence of transitions and stabilizes them
+   * backwards.
+   */
+  SymbolicTrace
+  createTrace(::std::size_t init_loc,
+              const ::std::vector<const Transition *> &path) const;
+  ::std::vector<ZoneBound> toZoneBounds(const DBM &zone) const;
+
+public:
+  /**
+   * Prepares the system for reachability checks.
+   *
+   * @param sys automata system, has to outlive this object
+   */
+  ZoneReachability(const AutomataSystem &sys);
+
+  /**
+   * Checks whether the system only uses features supported by the checker
+   * (one automaton, conjunctions of simple clock bounds, broadcast sync
+   * emitters).
+   *
+   * @return true iff findTrace() can be applied to the system
+   */
+  bool isSupported() const;
+
+  /**
+   * Searches a trace from the initial state to a target location.
+   *
+   * @param target_id id of the location to reach
+   * @param trace symbolic trace to the target, only modified on success
+   * @return true iff the target location is reachable
+   */
+  bool findTrace(const ::std::string &target_id, SymbolicTrace &trace);
+
+  /**
+   * Returns the number of symbolic states explored by the last search.
+   */
+  ::std::size_t getNumExplored() const { return num_explored; }
+};
+} // end namespace taptenc